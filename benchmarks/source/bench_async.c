@@ -0,0 +1,137 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include "bench_utils.h"
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_async.h>
+#include <enx/log/sinks/enxlog_sink_file.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+static struct enxlog_sink_file_context sink_file_context;
+static pthread_mutex_t sink_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(sink_list)
+    enxlog_batch_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        enxlog_sink_file_log_entry_write,
+        enxlog_sink_file_log_entry_close,
+        enxlog_sink_file_log_batch
+    )
+enxlog_end_sink_list()
+
+
+static void lock_mutex(void *context)
+{
+    pthread_mutex_lock((pthread_mutex_t *)context);
+}
+
+static void unlock_mutex(void *context)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)context);
+}
+
+enxlog_lock(sink_lock, &sink_mutex, lock_mutex, unlock_mutex);
+
+
+LOGGER(logger, "bench", "async");
+
+
+static void *producer(void *arg)
+{
+    size_t records = *(const size_t *)arg;
+
+    for (size_t i = 0; i < records; ++i) {
+        LOG_INFO(logger, "Record {} of a benchmark run, value={}", f_uint(i), f_int(-42));
+    }
+
+    return NULL;
+}
+
+static void run(const char *mode, bool async, const char *path, size_t thread_count, size_t records)
+{
+    pthread_t threads[64];
+    size_t per_thread = records / thread_count;
+    char name[32];
+
+    snprintf(name, sizeof(name), "%s, %zu threads", mode, thread_count);
+    unlink(path);
+
+    if (!enxlog_init(LOGLEVEL_INFO, sink_list, sink_lock, filter_tree) ||
+        (async && !enxlog_async_start(0))) {
+        printf("%-24s could not initialize\n", name);
+        return;
+    }
+
+    // Includes writing out whatever is still queued
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        pthread_create(&threads[i], NULL, producer, &per_thread);
+    }
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (async) {
+        enxlog_async_flush();
+    }
+
+    uint64_t elapsed = bench_now() - start;
+
+    enxlog_shutdown();
+
+    bench_report(name, per_thread * thread_count, bench_file_size(path), elapsed);
+    unlink(path);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char *directory = (argc > 1) ? argv[1] : "/tmp";
+    size_t records = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000000;
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/bench_async.log", directory);
+    sink_file_context.path = path;
+
+    for (size_t thread_count = 1; thread_count <= 64; thread_count *= 2) {
+        run("sync", false, path, thread_count, records);
+        run("async", true, path, thread_count, records);
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include "bench_utils.h"
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_tail_buffer.h>
+#include <enx/log/sinks/enxlog_sink_file.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+static struct enxlog_sink_file_context sink_file_context;
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(record_sink_list)
+    enxlog_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        enxlog_sink_file_log_entry_write,
+        enxlog_sink_file_log_entry_close
+    )
+enxlog_end_sink_list()
+
+enxlog_sink_list(batch_sink_list)
+    enxlog_batch_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        enxlog_sink_file_log_entry_write,
+        enxlog_sink_file_log_entry_close,
+        enxlog_sink_file_log_batch
+    )
+enxlog_end_sink_list()
+
+
+LOGGER(logger, "bench", "batch");
+
+
+static void report(const char *name, size_t records, uint64_t elapsed, uint64_t syscalls)
+{
+    bench_report(name, records, 0, elapsed);
+    printf("%-24s %10.1f write syscalls per 1k records\n", "", syscalls * 1000.0 / records);
+}
+
+static void run_direct(const char *path, size_t records)
+{
+    unlink(path);
+
+    if (!enxlog_init(LOGLEVEL_INFO, record_sink_list, NULL, filter_tree)) {
+        printf("%-24s could not initialize\n", "direct");
+        return;
+    }
+
+    uint64_t syscalls = bench_write_syscalls();
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < records; ++i) {
+        LOG_INFO(logger, "Record {} of a benchmark run, value={}", f_uint(i), f_int(-42));
+    }
+
+    uint64_t elapsed = bench_now() - start;
+    syscalls = bench_write_syscalls() - syscalls;
+
+    enxlog_shutdown();
+
+    report("direct", records, elapsed, syscalls);
+    unlink(path);
+}
+
+static void run_replay(
+    const char *name,
+    const struct enxlog_sink *sink_list,
+    const char *path,
+    size_t records)
+{
+    unlink(path);
+
+    // Entries below the default loglevel are captured by the tail buffer
+    // and written when it is flushed
+    if (!enxlog_init(LOGLEVEL_ERROR, sink_list, NULL, filter_tree) ||
+        !enxlog_tail_buffer_enable(LOGLEVEL_INFO, LOGLEVEL_ERROR, records * 128)) {
+        printf("%-24s could not initialize\n", name);
+        return;
+    }
+
+    for (size_t i = 0; i < records; ++i) {
+        LOG_INFO(logger, "Record {} of a benchmark run, value={}", f_uint(i), f_int(-42));
+    }
+
+    uint64_t syscalls = bench_write_syscalls();
+    uint64_t start = bench_now();
+
+    enxlog_tail_buffer_flush();
+
+    uint64_t elapsed = bench_now() - start;
+    syscalls = bench_write_syscalls() - syscalls;
+
+    enxlog_tail_buffer_disable();
+    enxlog_shutdown();
+
+    report(name, records, elapsed, syscalls);
+    unlink(path);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char *directory = (argc > 1) ? argv[1] : "/tmp";
+    size_t records = (argc > 2) ? strtoul(argv[2], NULL, 10) : 100000;
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/bench_batch.log", directory);
+    sink_file_context.path = path;
+
+    run_direct(path, records);
+    run_replay("replay (per record)", record_sink_list, path, records);
+    run_replay("replay (batch)", batch_sink_list, path, records);
+
+    return 0;
+}
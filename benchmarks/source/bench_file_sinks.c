@@ -0,0 +1,149 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include "bench_utils.h"
+
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_file.h>
+#ifdef ENXLOG_MMAP_RING
+#include <enx/log/sinks/enxlog_sink_mmap_ring.h>
+#endif
+#ifdef ENXLOG_URING_FILE
+#include <enx/log/sinks/enxlog_sink_uring_file.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+static struct enxlog_sink_file_context sink_file_context;
+#ifdef ENXLOG_MMAP_RING
+static struct enxlog_sink_mmap_ring_context sink_mmap_ring_context;
+#endif
+#ifdef ENXLOG_URING_FILE
+static struct enxlog_sink_uring_file_context sink_uring_file_context;
+#endif
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(file_sink_list)
+    enxlog_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        enxlog_sink_file_log_entry_write,
+        enxlog_sink_file_log_entry_close
+    )
+enxlog_end_sink_list()
+
+#ifdef ENXLOG_MMAP_RING
+enxlog_sink_list(mmap_ring_sink_list)
+    enxlog_sink(
+        &sink_mmap_ring_context,
+        enxlog_sink_mmap_ring_init,
+        enxlog_sink_mmap_ring_shutdown,
+        enxlog_sink_mmap_ring_log_entry_open,
+        enxlog_sink_mmap_ring_log_entry_write,
+        enxlog_sink_mmap_ring_log_entry_close
+    )
+enxlog_end_sink_list()
+#endif
+
+#ifdef ENXLOG_URING_FILE
+enxlog_sink_list(uring_file_sink_list)
+    enxlog_sink(
+        &sink_uring_file_context,
+        enxlog_sink_uring_file_init,
+        enxlog_sink_uring_file_shutdown,
+        enxlog_sink_uring_file_log_entry_open,
+        enxlog_sink_uring_file_log_entry_write,
+        enxlog_sink_uring_file_log_entry_close
+    )
+enxlog_end_sink_list()
+#endif
+
+
+LOGGER(logger, "bench", "sinks");
+
+
+static void run(
+    const char *name,
+    const struct enxlog_sink *sink_list,
+    const char *path,
+    bool fixed_size,
+    size_t records)
+{
+    unlink(path);
+
+    if (!enxlog_init(LOGLEVEL_INFO, sink_list, NULL, filter_tree)) {
+        printf("%-24s could not initialize\n", name);
+        return;
+    }
+
+    // Shutdown is included, as buffered sinks only finish writing there
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < records; ++i) {
+        LOG_INFO(logger, "Record {} of a benchmark run, value={}", f_uint(i), f_int(-42));
+    }
+
+    enxlog_shutdown();
+
+    uint64_t elapsed = bench_now() - start;
+
+    // A fixed size file says nothing about how much was written
+    bench_report(name, records, fixed_size ? 0 : bench_file_size(path), elapsed);
+    unlink(path);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char *directory = (argc > 1) ? argv[1] : "/tmp";
+    size_t records = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000000;
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/bench_file_sink.log", directory);
+    sink_file_context.path = path;
+    run("file (stdio)", file_sink_list, path, false, records);
+
+#ifdef ENXLOG_MMAP_RING
+    snprintf(path, sizeof(path), "%s/bench_mmap_ring_sink.ring", directory);
+    sink_mmap_ring_context.path = path;
+    sink_mmap_ring_context.size = 64 * 1024 * 1024;
+    sink_mmap_ring_context.fd = -1;
+    run("mmap_ring", mmap_ring_sink_list, path, true, records);
+#endif
+
+#ifdef ENXLOG_URING_FILE
+    snprintf(path, sizeof(path), "%s/bench_uring_file_sink.log", directory);
+    sink_uring_file_context.path = path;
+    run("uring_file", uring_file_sink_list, path, false, records);
+#endif
+
+    return 0;
+}
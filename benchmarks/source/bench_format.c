@@ -0,0 +1,130 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include "bench_utils.h"
+
+#include <enx/log/enxlog.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/**
+ * Counts the bytes written, so that only formatting is measured
+ */
+static size_t bench_null_bytes = 0;
+
+static void bench_null_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+}
+
+static void bench_null_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    bench_null_bytes += length;
+}
+
+static void bench_null_log_entry_close(void *context)
+{
+}
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(null_sink_list)
+    enxlog_sink(
+        NULL,
+        NULL,
+        NULL,
+        bench_null_log_entry_open,
+        bench_null_log_entry_write,
+        bench_null_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+LOGGER(logger, "bench", "format");
+
+
+#define BENCH_SHORT_FORMAT "Record {} value={}"
+
+#define BENCH_LONG_FORMAT                                                                   \
+    "Connection {} from {} closed after {} requests: the peer sent an unexpected frame "    \
+    "while the session was in the draining state, so the server discarded {} bytes of "    \
+    "pending output, released {} buffers back to the pool and scheduled a reconnect "       \
+    "attempt in {} milliseconds with backoff level {} (total reconnects so far: {})"
+
+static void run(
+    const char *name,
+    const char *format,
+    size_t arg_count,
+    bool presplit,
+    size_t records)
+{
+    static struct enxlog_format caches[2];
+    struct enxlog_format *cache = &caches[arg_count > 2];
+
+    bench_null_bytes = 0;
+    enxlog_init(LOGLEVEL_INFO, null_sink_list, NULL, filter_tree);
+
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < records; ++i) {
+        const struct enxtxt_fstr_arg args[] = {
+            f_uint(i), f_str("10.0.0.1"), f_uint(42), f_uint(4096), f_uint(3), f_uint(250), f_uint(2), f_uint(i)
+        };
+
+        if (presplit) {
+            enxlog_log_format(logger, LOGLEVEL_INFO, __func__, __LINE__, cache, format, args, arg_count);
+        } else {
+            enxlog_log(logger, LOGLEVEL_INFO, __func__, __LINE__, format, args, arg_count);
+        }
+    }
+
+    uint64_t elapsed = bench_now() - start;
+
+    enxlog_shutdown();
+
+    bench_report(name, records, bench_null_bytes, elapsed);
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t records = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    run("short, parsed", BENCH_SHORT_FORMAT, 2, false, records);
+    run("short, pre-split", BENCH_SHORT_FORMAT, 2, true, records);
+    run("long, parsed", BENCH_LONG_FORMAT, 8, false, records);
+    run("long, pre-split", BENCH_LONG_FORMAT, 8, true, records);
+
+    return 0;
+}
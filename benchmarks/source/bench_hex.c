@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include "bench_utils.h"
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_hex.h>
+#include <enx/log/sinks/enxlog_sink_file.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+static struct enxlog_sink_file_context sink_file_context;
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(file_sink_list)
+    enxlog_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        enxlog_sink_file_log_entry_write,
+        enxlog_sink_file_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+LOGGER(logger, "bench", "hex");
+
+
+enum bench_hex_format
+{
+    BENCH_HEX_H8_ARRAY,
+    BENCH_HEX_PLAIN,
+    BENCH_HEX_DUMP
+};
+
+static void run(
+    const char *name,
+    enum bench_hex_format format,
+    const char *path,
+    const unsigned char *frame,
+    size_t frame_length,
+    size_t records)
+{
+    unlink(path);
+
+    if (!enxlog_init(LOGLEVEL_INFO, file_sink_list, NULL, filter_tree)) {
+        printf("%-24s could not initialize\n", name);
+        return;
+    }
+
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < records; ++i) {
+        switch (format) {
+            case BENCH_HEX_H8_ARRAY: LOG_INFO(logger, "Frame {}", f_h8_array(frame, frame_length)); break;
+            case BENCH_HEX_PLAIN: LOG_INFO(logger, "Frame {}", f_hex(frame, frame_length)); break;
+            case BENCH_HEX_DUMP: LOG_INFO(logger, "Frame:\n{}", f_hexdump(frame, frame_length)); break;
+        }
+    }
+
+    enxlog_shutdown();
+
+    uint64_t elapsed = bench_now() - start;
+
+    bench_report(name, records, bench_file_size(path), elapsed);
+    unlink(path);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char *directory = (argc > 1) ? argv[1] : "/tmp";
+    size_t records = (argc > 2) ? strtoul(argv[2], NULL, 10) : 100000;
+    size_t frame_length = (argc > 3) ? strtoul(argv[3], NULL, 10) : 1024;
+    char path[256];
+
+    unsigned char *frame = malloc(frame_length);
+    for (size_t i = 0; i < frame_length; ++i) {
+        frame[i] = rand();
+    }
+
+    snprintf(path, sizeof(path), "%s/bench_hex.log", directory);
+    sink_file_context.path = path;
+
+    run("f_h8_array", BENCH_HEX_H8_ARRAY, path, frame, frame_length, records);
+    run("f_hex", BENCH_HEX_PLAIN, path, frame, frame_length, records);
+    run("f_hexdump", BENCH_HEX_DUMP, path, frame, frame_length, records);
+
+    free(frame);
+
+    return 0;
+}
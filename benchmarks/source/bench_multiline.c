@@ -0,0 +1,188 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include "bench_utils.h"
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+#include <enx/log/sinks/enxlog_sink_file.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static struct enxlog_sink_file_context sink_file_context;
+
+
+/**
+ * Writes continuation lines one byte at a time, as the sinks did before
+ * messages were scanned with memchr()
+ */
+static void bench_bytewise_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_file_context *ctx = (struct enxlog_sink_file_context *)context;
+
+    for (size_t i = 0; i < length; ++i) {
+        putc(ptr[i], ctx->file);
+        if (ptr[i] == '\n') {
+            for (size_t j = 0; j < ctx->tag_length; ++j) {
+                putc(' ', ctx->file);
+            }
+        }
+    }
+}
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(file_sink_list)
+    enxlog_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        enxlog_sink_file_log_entry_write,
+        enxlog_sink_file_log_entry_close
+    )
+enxlog_end_sink_list()
+
+enxlog_sink_list(bytewise_sink_list)
+    enxlog_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        bench_bytewise_log_entry_write,
+        enxlog_sink_file_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+LOGGER(logger, "bench", "multiline");
+
+
+static void run(
+    const char *name,
+    const struct enxlog_sink *sink_list,
+    const char *path,
+    const char *payload,
+    size_t records)
+{
+    unlink(path);
+
+    if (!enxlog_init(LOGLEVEL_INFO, sink_list, NULL, filter_tree)) {
+        printf("%-24s could not initialize\n", name);
+        return;
+    }
+
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < records; ++i) {
+        LOG_ERROR(logger, "Record {}:\n{}", f_uint(i), f_str(payload));
+    }
+
+    enxlog_shutdown();
+
+    uint64_t elapsed = bench_now() - start;
+
+    bench_report(name, records, bench_file_size(path), elapsed);
+    unlink(path);
+}
+
+static void run_modes(
+    const char *payload_name,
+    const char *path,
+    const char *payload,
+    size_t records)
+{
+    static const struct {
+        const char *name;
+        enum enxlog_pattern_newline newline;
+    } modes[] = {
+        { "indent", ENXLOG_PATTERN_NEWLINE_INDENT },
+        { "escape", ENXLOG_PATTERN_NEWLINE_ESCAPE },
+        { "raw", ENXLOG_PATTERN_NEWLINE_RAW }
+    };
+
+    struct enxlog_pattern pattern = enxlog_pattern_default;
+    char name[64];
+
+    sink_file_context.pattern = NULL;
+    snprintf(name, sizeof(name), "%s bytewise", payload_name);
+    run(name, bytewise_sink_list, path, payload, records);
+
+    sink_file_context.pattern = &pattern;
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i) {
+        pattern.newline = modes[i].newline;
+        snprintf(name, sizeof(name), "%s %s", payload_name, modes[i].name);
+        run(name, file_sink_list, path, payload, records);
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char *directory = (argc > 1) ? argv[1] : "/tmp";
+    size_t records = (argc > 2) ? strtoul(argv[2], NULL, 10) : 100000;
+    char path[256];
+    char *payload;
+    size_t length;
+
+    snprintf(path, sizeof(path), "%s/bench_multiline.log", directory);
+    sink_file_context.path = path;
+
+    // A 32 frame stack trace
+    payload = malloc(32 * 96);
+    length = 0;
+    for (int i = 0; i < 32; ++i) {
+        length += sprintf(&payload[length], "#%-2d 0x%016lx in handler_%d (ctx=0x%08x) at src/handler_%d.c:%d\n",
+            i, 0x7f0000400000ul + i * 0x1340ul, i, i * 0x100, i, 100 + i);
+    }
+    payload[length - 1] = 0;
+
+    run_modes("stack trace", path, payload, records);
+    free(payload);
+
+    // A 1 KiB hexdump, 16 bytes per line
+    payload = malloc(64 * 80);
+    length = 0;
+    for (int i = 0; i < 64; ++i) {
+        length += sprintf(&payload[length], "%08x ", i * 16);
+        for (int j = 0; j < 16; ++j) {
+            length += sprintf(&payload[length], " %02x", (i * 16 + j) & 0xff);
+        }
+        payload[length++] = '\n';
+    }
+    payload[length - 1] = 0;
+
+    run_modes("hexdump", path, payload, records);
+    free(payload);
+
+    return 0;
+}
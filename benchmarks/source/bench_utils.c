@@ -0,0 +1,86 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#include "bench_utils.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/stat.h>
+
+
+uint64_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+size_t bench_file_size(const char *path)
+{
+    struct stat st;
+
+    if (stat(path, &st) < 0) {
+        return 0;
+    }
+
+    return st.st_size;
+}
+
+uint64_t bench_write_syscalls(void)
+{
+    unsigned long long count = 0;
+    char line[128];
+
+    FILE *file = fopen("/proc/self/io", "r");
+    if (file == NULL) {
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "syscw: %llu", &count) == 1) {
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return count;
+}
+
+void bench_report(const char *name, size_t records, size_t bytes, uint64_t elapsed_ns)
+{
+    double seconds = elapsed_ns / 1e9;
+
+    printf("%-24s %10zu records %10.1f ns/record %12.0f records/s",
+        name,
+        records,
+        (double)elapsed_ns / records,
+        records / seconds);
+
+    if (bytes) {
+        printf(" %8.1f MiB/s", bytes / seconds / (1024.0 * 1024.0));
+    }
+
+    printf("\n");
+}
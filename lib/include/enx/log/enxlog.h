@@ -45,33 +45,109 @@ enum enxlog_loglevel
     LOGLEVEL_TRACE
 };
 
+struct enxlog_instance;
+
 /** \defgroup logger_functions Logger Functions
  * @{
  */
 
 /**
  * Logger
+ *
+ * The path holds the name parts joined as "a::b::c::", so that sinks can
+ * write it with a single copy. Loggers that are not defined with LOGGER()
+ * may leave the path NULL, in which case the name parts are used. Loggers
+ * with a NULL instance write to the default instance.
  */
 struct enxlog_logger
 {
     const char **name;
+    const char *path;
+    size_t path_length;
+    struct enxlog_instance *instance;
 };
 
+/**
+ * Joins up to 16 string literals into a logger path
+ * @private
+ */
+#define ENXLOG_PATH(...) ENXLOG_PATH_CONCAT(ENXLOG_PATH_, ENXLOG_PATH_COUNT(__VA_ARGS__))(__VA_ARGS__)
+#define ENXLOG_PATH_CONCAT(_a, _b) ENXLOG_PATH_CONCAT_(_a, _b)
+#define ENXLOG_PATH_CONCAT_(_a, _b) _a##_b
+#define ENXLOG_PATH_COUNT(...) ENXLOG_PATH_COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define ENXLOG_PATH_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _n, ...) _n
+#define ENXLOG_PATH_1(_p) _p "::"
+#define ENXLOG_PATH_2(_p, ...) _p "::" ENXLOG_PATH_1(__VA_ARGS__)
+#define ENXLOG_PATH_3(_p, ...) _p "::" ENXLOG_PATH_2(__VA_ARGS__)
+#define ENXLOG_PATH_4(_p, ...) _p "::" ENXLOG_PATH_3(__VA_ARGS__)
+#define ENXLOG_PATH_5(_p, ...) _p "::" ENXLOG_PATH_4(__VA_ARGS__)
+#define ENXLOG_PATH_6(_p, ...) _p "::" ENXLOG_PATH_5(__VA_ARGS__)
+#define ENXLOG_PATH_7(_p, ...) _p "::" ENXLOG_PATH_6(__VA_ARGS__)
+#define ENXLOG_PATH_8(_p, ...) _p "::" ENXLOG_PATH_7(__VA_ARGS__)
+#define ENXLOG_PATH_9(_p, ...) _p "::" ENXLOG_PATH_8(__VA_ARGS__)
+#define ENXLOG_PATH_10(_p, ...) _p "::" ENXLOG_PATH_9(__VA_ARGS__)
+#define ENXLOG_PATH_11(_p, ...) _p "::" ENXLOG_PATH_10(__VA_ARGS__)
+#define ENXLOG_PATH_12(_p, ...) _p "::" ENXLOG_PATH_11(__VA_ARGS__)
+#define ENXLOG_PATH_13(_p, ...) _p "::" ENXLOG_PATH_12(__VA_ARGS__)
+#define ENXLOG_PATH_14(_p, ...) _p "::" ENXLOG_PATH_13(__VA_ARGS__)
+#define ENXLOG_PATH_15(_p, ...) _p "::" ENXLOG_PATH_14(__VA_ARGS__)
+#define ENXLOG_PATH_16(_p, ...) _p "::" ENXLOG_PATH_15(__VA_ARGS__)
+
 /**
  * Define a logger
  * @param _var_name The variable name of the logger
- * @param ... The name of the logger, specified as a list of comma separated parts
+ * @param ... The name of the logger, specified as a list of up to 16 comma separated string literals
  */
 #define LOGGER(_var_name, ...)                              \
+    ENXLOG_LOGGER_DEFINE(_var_name, 0, __VA_ARGS__)
+
+/**
+ * Define a logger that writes to a specific instance
+ * @param _var_name The variable name of the logger
+ * @param _instance A pointer to the instance, e.g. &audit_instance
+ * @param ... The name of the logger, specified as a list of up to 16 comma separated string literals
+ */
+#define LOGGER_INSTANCE(_var_name, _instance, ...)          \
+    ENXLOG_LOGGER_DEFINE(_var_name, _instance, __VA_ARGS__)
+
+/** @private */
+#ifndef __cplusplus
+#define ENXLOG_LOGGER_DEFINE(_var_name, _instance, ...)     \
 static const struct enxlog_logger *_var_name =              \
-    (const struct enxlog_logger []) {                       \
+    (struct enxlog_logger []) {                             \
     {                                                       \
         .name = (const char* []) {                          \
         __VA_ARGS__                                         \
         ,0                                                  \
-        }                                                   \
+        },                                                  \
+        .path = ENXLOG_PATH(__VA_ARGS__),                   \
+        .path_length = sizeof(ENXLOG_PATH(__VA_ARGS__)) - 1,\
+        .instance = _instance                               \
     }                                                       \
 }
+#else
+// C++ has no compound literals, so the parts are named static objects
+#define ENXLOG_LOGGER_DEFINE(_var_name, _instance, ...)     \
+static const char *_var_name##_name[] = {                   \
+    __VA_ARGS__                                             \
+    ,0                                                      \
+};                                                          \
+static struct enxlog_logger _var_name##_logger = {          \
+    _var_name##_name,                                       \
+    ENXLOG_PATH(__VA_ARGS__),                               \
+    sizeof(ENXLOG_PATH(__VA_ARGS__)) - 1,                   \
+    _instance                                               \
+};                                                          \
+static const struct enxlog_logger *_var_name = &_var_name##_logger
+#endif
+
+/**
+ * Returns a stable id for a logger, derived from its path
+ *
+ * The id is a hash of the path, computed on each call, so that loggers in
+ * read only memory can be passed. It is never 0.
+ */
+uint32_t enxlog_logger_id(const struct enxlog_logger *logger);
 
 /** @} */
 
@@ -156,6 +232,16 @@ typedef bool (*enxlog_sink_init_fn_t)(void *context);
  */
 typedef void (*enxlog_sink_shutdown_fn_t)(void *context);
 
+/**
+ * @brief Sink destroy callback function
+ *
+ * Shuts the sink down and frees the context. Set by the sink factory, so
+ * that enxlog_config_destroy() frees the sinks it created.
+ *
+ * @param context The user supplied context
+ */
+typedef void (*enxlog_sink_destroy_fn_t)(void *context);
+
 /**
  * @brief Sink log entry open callback function
  * @param context The user supplied context
@@ -188,12 +274,65 @@ typedef void (*enxlog_sink_log_entry_write_fn_t)(
  */
 typedef void (*enxlog_sink_log_entry_newline_fn_t)(void* context);
 
+/**
+ * @brief Sink log entry field callback function
+ *
+ * Called once for each structured field, after the message has been
+ * written. Sinks without this callback receive the fields as " key=value"
+ * text through the write callback.
+ *
+ * @param context The user supplied context
+ * @param key The field key
+ * @param value The field value. Format it by calling value->fn_fmt.
+ */
+typedef void (*enxlog_sink_log_entry_field_fn_t)(
+    void *context,
+    const char *key,
+    const struct enxtxt_fstr_arg *value);
+
 /**
  * @brief Sink log entry close callback function
  * @param context The user supplied context
  */
 typedef void (*enxlog_sink_log_entry_close_fn_t)(void *context);
 
+struct timeval;
+
+/**
+ * A formatted record, as delivered to the batch callback
+ *
+ * The message holds the whole formatted entry, including embedded newlines
+ * and any structured fields as " key=value" text.
+ */
+struct enxlog_record
+{
+    const struct enxlog_logger *logger;
+    enum enxlog_loglevel loglevel;
+    const char *func;
+    unsigned int line;
+    const struct timeval *time;
+    const char *message;
+    size_t length;
+};
+
+/**
+ * @brief Sink log batch callback function
+ *
+ * Called with records that were buffered before being written, e.g. when
+ * the tail buffer or the early buffer is replayed, so that the sink can
+ * write them with as few system calls as possible. Call
+ * enxlog_record_select() before formatting each record. Sinks without this
+ * callback receive the records one by one through the entry callbacks.
+ *
+ * @param context The user supplied context
+ * @param records The records, oldest first
+ * @param count The number of records
+ */
+typedef void (*enxlog_sink_log_batch_fn_t)(
+    void *context,
+    const struct enxlog_record *records,
+    size_t count);
+
 /**
  * Sink
  */
@@ -206,8 +345,28 @@ struct enxlog_sink
     enxlog_sink_log_entry_open_fn_t fn_log_entry_open;
     enxlog_sink_log_entry_write_fn_t fn_log_entry_write;
     enxlog_sink_log_entry_close_fn_t fn_log_entry_close;
+    enxlog_sink_log_entry_field_fn_t fn_log_entry_field;
+    enxlog_sink_log_batch_fn_t fn_log_batch;
+    enxlog_sink_destroy_fn_t fn_destroy;
 };
 
+/**
+ * Returns the wall clock time of the log entry being written
+ *
+ * Sinks that write a timestamp should call this from their open callback
+ * rather than reading the clock, so that entries buffered before
+ * enxlog_init() keep the time at which they were logged.
+ */
+void enxlog_entry_time(struct timeval *time);
+
+/**
+ * Makes enxlog_entry_time() return the time of a batched record
+ *
+ * Batch callbacks call this before formatting each record. The previous
+ * time is restored when the callback returns.
+ */
+void enxlog_record_select(const struct enxlog_record *record);
+
 /**
  * Starts a sink list
  * @param _var_name The variable name of the sink list
@@ -245,6 +404,93 @@ static const struct enxlog_sink *_var_name =                \
         .fn_log_entry_close = _fn_log_entry_close           \
     },
 
+/**
+ * Declares a sink that receives structured fields
+ * @param _context The user supplied context
+ * @param _fn_init The sink initialization function. See #enxlog_sink_init_fn_t
+ * @param _fn_shutdown The sink shutdown function. See #enxlog_sink_shutdown_fn_t
+ * @param _fn_log_entry_open The log entry open function. See #enxlog_sink_log_entry_open_fn_t
+ * @param _fn_log_entry_write The log entry write function. See #enxlog_sink_log_entry_write_fn_t
+ * @param _fn_log_entry_field The log entry field function. See #enxlog_sink_log_entry_field_fn_t
+ * @param _fn_log_entry_close The log entry close function. See #enxlog_sink_log_entry_close_fn_t
+ */
+#define enxlog_structured_sink(_context, _fn_init, _fn_shutdown, _fn_log_entry_open, _fn_log_entry_write, _fn_log_entry_field, _fn_log_entry_close) \
+    {                                                       \
+        .valid = true,                                      \
+        .context = _context,                                \
+        .fn_init = _fn_init,                                \
+        .fn_shutdown = _fn_shutdown,                        \
+        .fn_log_entry_open = _fn_log_entry_open,            \
+        .fn_log_entry_write = _fn_log_entry_write,          \
+        .fn_log_entry_close = _fn_log_entry_close,          \
+        .fn_log_entry_field = _fn_log_entry_field           \
+    },
+
+/**
+ * Declares a sink that can write a batch of buffered records at once
+ * @param _context The user supplied context
+ * @param _fn_init The sink initialization function. See #enxlog_sink_init_fn_t
+ * @param _fn_shutdown The sink shutdown function. See #enxlog_sink_shutdown_fn_t
+ * @param _fn_log_entry_open The log entry open function. See #enxlog_sink_log_entry_open_fn_t
+ * @param _fn_log_entry_write The log entry write function. See #enxlog_sink_log_entry_write_fn_t
+ * @param _fn_log_entry_close The log entry close function. See #enxlog_sink_log_entry_close_fn_t
+ * @param _fn_log_batch The log batch function. See #enxlog_sink_log_batch_fn_t
+ */
+#define enxlog_batch_sink(_context, _fn_init, _fn_shutdown, _fn_log_entry_open, _fn_log_entry_write, _fn_log_entry_close, _fn_log_batch) \
+    {                                                       \
+        .valid = true,                                      \
+        .context = _context,                                \
+        .fn_init = _fn_init,                                \
+        .fn_shutdown = _fn_shutdown,                        \
+        .fn_log_entry_open = _fn_log_entry_open,            \
+        .fn_log_entry_write = _fn_log_entry_write,          \
+        .fn_log_entry_close = _fn_log_entry_close,          \
+        .fn_log_batch = _fn_log_batch                       \
+    },
+
+/** @} */
+
+/** \defgroup field_functions Structured Field Functions
+ * @{
+ */
+
+/**
+ * Structured field
+ */
+struct enxlog_field
+{
+    const char *key;
+    struct enxtxt_fstr_arg value;
+};
+
+/**
+ * Formats a structured field as key=value
+ * @private
+ */
+void enxlog_field_fmt(
+    const struct enxtxt_fstr_arg *arg,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context);
+
+/**
+ * Attaches a structured field to a log entry
+ *
+ * Fields are passed after the arguments used by the format string. Sinks
+ * declared with #enxlog_structured_sink receive them separately, other sinks
+ * see them appended to the message as " key=value".
+ *
+ * @param _key The field key
+ * @param _value The field value, for example f_uint(id)
+ */
+#define f_kv(_key, _value)                                  \
+    {                                                       \
+        .fn_fmt = enxlog_field_fmt,                         \
+        ._user = &(const struct enxlog_field) {             \
+            .key = (_key),                                  \
+            .value = _value                                 \
+        }                                                   \
+    }
+
 /** @} */
 
 /** \defgroup lock_functions Lock Functions
@@ -299,6 +545,33 @@ static const struct enxlog_lock *_var_name =                \
  */
 
 
+/**
+ * Logging instance
+ *
+ * An instance holds a logging configuration: a filter, a list of sinks and
+ * a lock. Loggers defined with LOGGER() write to the default instance, which
+ * is configured by enxlog_init(). Loggers defined with LOGGER_INSTANCE()
+ * write to the given instance, so that e.g. an audit log can have its own
+ * sinks and lock and does not contend with the application log.
+ *
+ * Define instances as zero initialized objects with static storage, and
+ * configure them with enxlog_instance_init(). The members are private.
+ */
+struct enxlog_instance
+{
+    enum enxlog_loglevel default_loglevel;
+    enum enxlog_loglevel filter_loglevel;
+    const struct enxlog_sink *sinks;
+    const struct enxlog_lock *lock;
+    const struct enxlog_filter *filter;
+    struct enxlog_instance *next;
+};
+
+/**
+ * The default instance
+ */
+extern struct enxlog_instance enxlog_default_instance;
+
 /**
  * Initialize the logging library
  *
@@ -318,6 +591,72 @@ bool enxlog_init(
  */
 void enxlog_shutdown(void);
 
+/**
+ * Initializes an instance
+ *
+ * Entries made through the loggers of the instance are dropped until it has
+ * been initialized.
+ *
+ * @param instance The instance
+ * @param default_loglevel The default loglevel
+ * @param sinks A list of sinks
+ * @param lock The lock to use, or NULL if locking is not required
+ * @param filter The filter, or NULL to drop all entries
+ */
+bool enxlog_instance_init(
+    struct enxlog_instance *instance,
+    enum enxlog_loglevel default_loglevel,
+    const struct enxlog_sink *sinks,
+    const struct enxlog_lock *lock,
+    const struct enxlog_filter *filter);
+
+/**
+ * Shuts down the sinks of an instance
+ *
+ * Entries made through the loggers of the instance are dropped afterwards,
+ * and the instance may be freed.
+ */
+void enxlog_instance_shutdown(struct enxlog_instance *instance);
+
+/**
+ * The most verbose loglevel that any logger of any instance can currently
+ * emit or capture.
+ * The C++ front end compares against it to skip disabled statements.
+ * @private
+ */
+extern enum enxlog_loglevel enxlog_enabled_loglevel;
+
+/**
+ * The maximum number of placeholders in a pre-split format. Formats with
+ * more placeholders are parsed on every call.
+ */
+#ifndef ENXLOG_FORMAT_MAX_ARGS
+#define ENXLOG_FORMAT_MAX_ARGS 16
+#endif
+
+/**
+ * A literal span of a pre-split format
+ * @private
+ */
+struct enxlog_format_span
+{
+    uint16_t offset;
+    uint16_t length;
+};
+
+/**
+ * A format string split into the literal spans around its placeholders.
+ * Each call site keeps one in static storage, filled in on first use.
+ * @private
+ */
+struct enxlog_format
+{
+    const char *text;
+    int state;
+    uint8_t count;
+    struct enxlog_format_span spans[ENXLOG_FORMAT_MAX_ARGS + 1];
+};
+
 /**
  * Called by the logging macros
  * @private
@@ -328,7 +667,22 @@ void enxlog_log(
     const char *func,
     unsigned int line,
     const char *format,
-    const struct enxtxt_fstr_arg *args);
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count);
+
+/**
+ * Called by the logging macros when formats are pre-split
+ * @private
+ */
+void enxlog_log_format(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count);
 
 /** @} */
 
@@ -339,18 +693,38 @@ void enxlog_log(
 
 /* Log macros */
 
+/**
+ * Number of elements in an argument array
+ * @private
+ */
+#define ENXLOG_ARG_COUNT(_args) (sizeof(_args) / sizeof((_args)[0]))
+
+/**
+ * Passes a log entry to the library. With ENXLOG_PRESPLIT_FORMAT, each call
+ * site splits its format once and keeps the result in static storage.
+ * @private
+ */
+#ifdef ENXLOG_PRESPLIT_FORMAT
+#define ENXLOG_LOG_ENTRY(_logger, _loglevel, _format, _args)                                                 \
+    static struct enxlog_format __format;                                                                   \
+    enxlog_log_format(_logger, _loglevel, __FUNCTION__, __LINE__, &__format, _format, _args, ENXLOG_ARG_COUNT(_args))
+#else
+#define ENXLOG_LOG_ENTRY(_logger, _loglevel, _format, _args)                                                 \
+    enxlog_log(_logger, _loglevel, __FUNCTION__, __LINE__, _format, _args, ENXLOG_ARG_COUNT(_args))
+#endif
+
 /**
  * Logs an error
  * @param logger The logger
  * @param format A format string
  * @param ... A variable list of arguments
  */
-#define LOG_ERROR(logger, format, ...)                                                  \
-do {                                                                                    \
-    const struct enxtxt_fstr_arg __args[] = {                                           \
-    __VA_ARGS__                                                                         \
-    };                                                                                  \
-    enxlog_log(logger, LOGLEVEL_ERROR, __FUNCTION__, __LINE__, format, __args);         \
+#define LOG_ERROR(logger, format, ...)                                                                     \
+do {                                                                                                       \
+    const struct enxtxt_fstr_arg __args[] = {                                                              \
+    __VA_ARGS__                                                                                            \
+    };                                                                                                     \
+    ENXLOG_LOG_ENTRY(logger, LOGLEVEL_ERROR, format, __args);                                              \
 } while (0)
 
 /**
@@ -359,12 +733,12 @@ do {
  * @param format A format string
  * @param ... A variable list of arguments
  */
-#define LOG_WARN(logger, format, ...)                                                   \
-do {                                                                                    \
-    const struct enxtxt_fstr_arg __args[] = {                                           \
-    __VA_ARGS__                                                                         \
-    };                                                                                  \
-    enxlog_log(logger, LOGLEVEL_WARN, __FUNCTION__, __LINE__, format, __args);          \
+#define LOG_WARN(logger, format, ...)                                                                      \
+do {                                                                                                       \
+    const struct enxtxt_fstr_arg __args[] = {                                                              \
+    __VA_ARGS__                                                                                            \
+    };                                                                                                     \
+    ENXLOG_LOG_ENTRY(logger, LOGLEVEL_WARN, format, __args);                                               \
 } while (0)
 
 /**
@@ -373,12 +747,12 @@ do {
  * @param format A format string
  * @param ... A variable list of arguments
  */
-#define LOG_INFO(logger, format, ...)                                                   \
-do {                                                                                    \
-    const struct enxtxt_fstr_arg __args[] = {                                           \
-    __VA_ARGS__                                                                         \
-    };                                                                                  \
-    enxlog_log(logger, LOGLEVEL_INFO, __FUNCTION__, __LINE__, format, __args);          \
+#define LOG_INFO(logger, format, ...)                                                                      \
+do {                                                                                                       \
+    const struct enxtxt_fstr_arg __args[] = {                                                              \
+    __VA_ARGS__                                                                                            \
+    };                                                                                                     \
+    ENXLOG_LOG_ENTRY(logger, LOGLEVEL_INFO, format, __args);                                               \
 } while (0)
 
 /**
@@ -387,12 +761,12 @@ do {
  * @param format A format string
  * @param ... A variable list of arguments
  */
-#define LOG_DEBUG(logger, format, ...)                                                  \
-do {                                                                                    \
-    const struct enxtxt_fstr_arg __args[] = {                                           \
-    __VA_ARGS__                                                                         \
-    };                                                                                  \
-    enxlog_log(logger, LOGLEVEL_DEBUG, __FUNCTION__, __LINE__, format, __args);         \
+#define LOG_DEBUG(logger, format, ...)                                                                     \
+do {                                                                                                       \
+    const struct enxtxt_fstr_arg __args[] = {                                                              \
+    __VA_ARGS__                                                                                            \
+    };                                                                                                     \
+    ENXLOG_LOG_ENTRY(logger, LOGLEVEL_DEBUG, format, __args);                                              \
 } while (0)
 
 /**
@@ -401,12 +775,12 @@ do {
  * @param format A format string
  * @param ... A variable list of arguments
  */
-#define LOG_TRACE(logger, format, ...)                                                  \
-do {                                                                                    \
-    const struct enxtxt_fstr_arg __args[] = {                                           \
-    __VA_ARGS__                                                                         \
-    };                                                                                  \
-    enxlog_log(logger, LOGLEVEL_TRACE, __FUNCTION__, __LINE__, format, __args);         \
+#define LOG_TRACE(logger, format, ...)                                                                     \
+do {                                                                                                       \
+    const struct enxtxt_fstr_arg __args[] = {                                                              \
+    __VA_ARGS__                                                                                            \
+    };                                                                                                     \
+    ENXLOG_LOG_ENTRY(logger, LOGLEVEL_TRACE, format, __args);                                              \
 } while (0)
 
 /** @} */
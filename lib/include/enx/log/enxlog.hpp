@@ -0,0 +1,482 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_HPP
+#define ENXLOG_HPP
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_hex.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+
+/** \defgroup cxx_functions C++ Front End
+ *
+ * Logging macros for C++ that deduce the argument types, so that no f_*
+ * wrappers are needed:
+ *
+ * \code
+ * LOGGER(logger, "sys", "drivers", "uart");
+ *
+ * ENXLOG_INFO(logger, "Sent {} bytes to {}", count, name);
+ * ENXLOG_DEBUG(logger, "Frame {}", enxlog::hex(frame, length), enxlog::kv("port", port));
+ * \endcode
+ *
+ * The format must be a string literal. The number of {} placeholders is
+ * checked against the number of arguments at compile time; fields created
+ * with enxlog::kv() are not counted.
+ *
+ * Arguments are referenced in place by an array of enxtxt_fstr_arg on the
+ * stack, nothing is allocated. They are only evaluated when the loglevel
+ * is enabled, which costs a single comparison.
+ *
+ * Supported arguments are integers, enums, bool, char, floating point
+ * numbers, C strings, std::string, pointers, enxlog::hex(),
+ * enxlog::hexdump(), enxlog::kv() and prepared enxtxt_fstr_arg values.
+ * @{
+ */
+
+namespace enxlog {
+
+/**
+ * A structured field, created by enxlog::kv()
+ */
+template <typename T>
+struct field
+{
+    const char *key;
+    const T &value;
+};
+
+/**
+ * Attaches a structured field to a log entry
+ */
+template <typename T>
+inline field<T> kv(const char *key, const T &value)
+{
+    return field<T>{ key, value };
+}
+
+/**
+ * Byte buffer argument, written as contiguous hex
+ */
+inline enxlog_hex hex(const void *ptr, std::size_t length, std::size_t limit = ENXLOG_HEX_LIMIT)
+{
+    return enxlog_hex{ ptr, length, limit, 0 };
+}
+
+/**
+ * Byte buffer argument, written as a hexdump with offset and ASCII columns
+ */
+inline enxlog_hex hexdump(const void *ptr, std::size_t length, std::size_t limit = ENXLOG_HEX_LIMIT)
+{
+    return enxlog_hex{ ptr, length, limit, ENXLOG_HEX_DUMP | ENXLOG_HEX_OFFSET | ENXLOG_HEX_ASCII };
+}
+
+/** @cond PRIVATE */
+namespace detail {
+
+// Placeholders are counted by splitting the range in halves, which keeps
+// the constexpr recursion depth logarithmic in the length of the format
+constexpr std::size_t count_placeholders(const char *format, std::size_t begin, std::size_t end)
+{
+    return (end - begin < 2) ? 0 :
+        count_placeholders(format, begin, (begin + end) / 2) +
+        count_placeholders(format, (begin + end) / 2, end) +
+        (((format[(begin + end) / 2 - 1] == '{') && (format[(begin + end) / 2] == '}')) ? 1 : 0);
+}
+
+template <std::size_t N>
+constexpr std::size_t count_placeholders(const char (&format)[N])
+{
+    return count_placeholders(format, 0, N - 1);
+}
+
+template <typename T>
+struct is_field : std::false_type {};
+
+template <typename T>
+struct is_field<field<T>> : std::true_type {};
+
+template <typename... Args>
+struct positional_count;
+
+template <>
+struct positional_count<>
+{
+    static constexpr std::size_t value = 0;
+};
+
+template <typename T, typename... Args>
+struct positional_count<T, Args...>
+{
+    static constexpr std::size_t value = (is_field<T>::value ? 0 : 1) + positional_count<Args...>::value;
+};
+
+// Only used in unevaluated context, to count the arguments without
+// evaluating them
+template <typename Format, typename... Args>
+positional_count<Args...> count_arguments(const Format &, const Args &...);
+
+inline bool write(enxtxt_fstr_output_function_t output_fn, void *output_fn_context, const char *ptr, std::size_t length)
+{
+    return output_fn(output_fn_context, ptr, length);
+}
+
+template <typename T>
+inline void fmt_signed(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    long long value = static_cast<long long>(*static_cast<const T *>(arg->_user));
+    unsigned long long magnitude = (value < 0) ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+    char text[24];
+    char *ptr = &text[sizeof(text)];
+
+    do {
+        *--ptr = static_cast<char>('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (value < 0) {
+        *--ptr = '-';
+    }
+
+    write(output_fn, output_fn_context, ptr, &text[sizeof(text)] - ptr);
+}
+
+template <typename T>
+inline void fmt_unsigned(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    unsigned long long value = static_cast<unsigned long long>(*static_cast<const T *>(arg->_user));
+    char text[24];
+    char *ptr = &text[sizeof(text)];
+
+    do {
+        *--ptr = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    } while (value);
+
+    write(output_fn, output_fn_context, ptr, &text[sizeof(text)] - ptr);
+}
+
+template <typename T>
+inline void fmt_float(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%g", static_cast<double>(*static_cast<const T *>(arg->_user)));
+    write(output_fn, output_fn_context, text, static_cast<std::size_t>(length));
+}
+
+inline void fmt_bool(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    if (*static_cast<const bool *>(arg->_user)) {
+        write(output_fn, output_fn_context, "true", 4);
+    } else {
+        write(output_fn, output_fn_context, "false", 5);
+    }
+}
+
+inline void fmt_char(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    write(output_fn, output_fn_context, static_cast<const char *>(arg->_user), 1);
+}
+
+inline void fmt_cstr(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    const char *value = static_cast<const char *>(arg->_user);
+
+    if (value) {
+        write(output_fn, output_fn_context, value, std::strlen(value));
+    } else {
+        write(output_fn, output_fn_context, "(null)", 6);
+    }
+}
+
+inline void fmt_string(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    const std::string *value = static_cast<const std::string *>(arg->_user);
+    write(output_fn, output_fn_context, value->data(), value->size());
+}
+
+inline void fmt_pointer(const enxtxt_fstr_arg *arg, enxtxt_fstr_output_function_t output_fn, void *output_fn_context)
+{
+    std::uintptr_t value = reinterpret_cast<std::uintptr_t>(*static_cast<const void * const *>(arg->_user));
+    unsigned char bytes[sizeof(value)];
+    char text[2 + 2 * sizeof(value)] = { '0', 'x' };
+
+    for (std::size_t i = 0; i < sizeof(value); ++i) {
+        bytes[i] = static_cast<unsigned char>(value >> (8 * (sizeof(value) - 1 - i)));
+    }
+
+    enxlog_hex_encode(&text[2], bytes, sizeof(bytes));
+    write(output_fn, output_fn_context, text, sizeof(text));
+}
+
+inline enxtxt_fstr_arg make(enxtxt_fstr_fmt_function_t fn_fmt, const void *user)
+{
+    enxtxt_fstr_arg arg = enxtxt_fstr_arg();
+    arg.fn_fmt = fn_fmt;
+    arg._user = user;
+    return arg;
+}
+
+// Enums are formatted as their underlying integer type
+template <typename T, bool = std::is_enum<T>::value>
+struct integer_type
+{
+    typedef T type;
+};
+
+template <typename T>
+struct integer_type<T, true>
+{
+    typedef typename std::underlying_type<T>::type type;
+};
+
+template <typename T>
+struct is_signed_value : std::integral_constant<bool,
+    std::is_integral<typename integer_type<T>::type>::value &&
+    std::is_signed<typename integer_type<T>::type>::value &&
+    !std::is_same<T, char>::value> {};
+
+template <typename T>
+struct is_unsigned_value : std::integral_constant<bool,
+    std::is_integral<typename integer_type<T>::type>::value &&
+    std::is_unsigned<typename integer_type<T>::type>::value &&
+    !std::is_same<T, bool>::value &&
+    !std::is_same<T, char>::value> {};
+
+template <typename T>
+inline typename std::enable_if<is_signed_value<T>::value, enxtxt_fstr_arg>::type make_arg(const T &value)
+{
+    return make(fmt_signed<T>, &value);
+}
+
+template <typename T>
+inline typename std::enable_if<is_unsigned_value<T>::value, enxtxt_fstr_arg>::type make_arg(const T &value)
+{
+    return make(fmt_unsigned<T>, &value);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, enxtxt_fstr_arg>::type make_arg(const T &value)
+{
+    return make(fmt_float<T>, &value);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_pointer<T>::value && !std::is_same<typename std::remove_cv<typename std::remove_pointer<T>::type>::type, char>::value, enxtxt_fstr_arg>::type make_arg(const T &value)
+{
+    return make(fmt_pointer, &value);
+}
+
+inline enxtxt_fstr_arg make_arg(const bool &value)
+{
+    return make(fmt_bool, &value);
+}
+
+inline enxtxt_fstr_arg make_arg(const char &value)
+{
+    return make(fmt_char, &value);
+}
+
+inline enxtxt_fstr_arg make_arg(const char *value)
+{
+    return make(fmt_cstr, value);
+}
+
+inline enxtxt_fstr_arg make_arg(char *value)
+{
+    return make(fmt_cstr, value);
+}
+
+inline enxtxt_fstr_arg make_arg(const std::string &value)
+{
+    return make(fmt_string, &value);
+}
+
+inline enxtxt_fstr_arg make_arg(const enxlog_hex &value)
+{
+    return make(enxlog_hex_fmt, &value);
+}
+
+inline enxtxt_fstr_arg make_arg(const enxtxt_fstr_arg &value)
+{
+    return value;
+}
+
+// The field and its value live in the caller's full expression, the
+// struct enxlog_field is kept alongside for the duration of the call
+template <typename T>
+struct field_arg
+{
+    enxlog_field field;
+
+    explicit field_arg(const enxlog::field<T> &source)
+    {
+        field.key = source.key;
+        field.value = make_arg(source.value);
+    }
+};
+
+template <typename T>
+inline enxtxt_fstr_arg make_arg(const field_arg<T> &value)
+{
+    return make(enxlog_field_fmt, &value.field);
+}
+
+template <typename T>
+inline const T &prepare(const T &value)
+{
+    return value;
+}
+
+template <typename T>
+inline field_arg<T> prepare(const field<T> &value)
+{
+    return field_arg<T>(value);
+}
+
+template <typename... Args>
+inline void log_args(
+    const enxlog_logger *logger,
+    enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    enxlog_format *cache,
+    const char *format,
+    const Args &... args)
+{
+    const enxtxt_fstr_arg array[] = { make_arg(args)... };
+    enxlog_log_format(logger, loglevel, func, line, cache, format, array, sizeof...(Args));
+}
+
+inline void log_args(
+    const enxlog_logger *logger,
+    enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    enxlog_format *cache,
+    const char *format)
+{
+    enxlog_log_format(logger, loglevel, func, line, cache, format, nullptr, 0);
+}
+
+template <typename... Args>
+inline void log(
+    const enxlog_logger *logger,
+    enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    enxlog_format *cache,
+    const char *format,
+    const Args &... args)
+{
+    log_args(logger, loglevel, func, line, cache, format, prepare(args)...);
+}
+
+} // namespace detail
+/** @endcond */
+
+} // namespace enxlog
+
+
+/**
+ * The format argument of a C++ logging macro
+ * @private
+ */
+#define ENXLOG_CXX_FORMAT(...) ENXLOG_CXX_FORMAT_(__VA_ARGS__, 0)
+#define ENXLOG_CXX_FORMAT_(_format, ...) _format
+
+/**
+ * The pre-split format of a call site, see ENXLOG_PRESPLIT_FORMAT
+ * @private
+ */
+#ifdef ENXLOG_PRESPLIT_FORMAT
+#define ENXLOG_CXX_FORMAT_CACHE()                                                                           \
+    static enxlog_format __format;                                                                          \
+    enxlog_format *__cache = &__format
+#else
+#define ENXLOG_CXX_FORMAT_CACHE()                                                                           \
+    enxlog_format *__cache = nullptr
+#endif
+
+/**
+ * Logs at the given loglevel
+ * @param _logger The logger
+ * @param _loglevel The loglevel
+ * @param ... A format string literal, followed by the arguments
+ */
+#define ENXLOG_LOG(_logger, _loglevel, ...)                                                                 \
+do {                                                                                                        \
+    static_assert(                                                                                          \
+        ::enxlog::detail::count_placeholders(ENXLOG_CXX_FORMAT(__VA_ARGS__)) ==                             \
+        decltype(::enxlog::detail::count_arguments(__VA_ARGS__))::value,                                    \
+        "The number of {} placeholders does not match the number of arguments");                            \
+    if ((_loglevel) <= enxlog_enabled_loglevel) {                                                           \
+        ENXLOG_CXX_FORMAT_CACHE();                                                                          \
+        ::enxlog::detail::log(_logger, _loglevel, __func__, __LINE__, __cache, __VA_ARGS__);                \
+    }                                                                                                       \
+} while (0)
+
+/**
+ * Logs an error
+ * @param _logger The logger
+ * @param ... A format string literal, followed by the arguments
+ */
+#define ENXLOG_ERROR(_logger, ...) ENXLOG_LOG(_logger, LOGLEVEL_ERROR, __VA_ARGS__)
+
+/**
+ * Logs a warning
+ * @param _logger The logger
+ * @param ... A format string literal, followed by the arguments
+ */
+#define ENXLOG_WARN(_logger, ...) ENXLOG_LOG(_logger, LOGLEVEL_WARN, __VA_ARGS__)
+
+/**
+ * Logs information
+ * @param _logger The logger
+ * @param ... A format string literal, followed by the arguments
+ */
+#define ENXLOG_INFO(_logger, ...) ENXLOG_LOG(_logger, LOGLEVEL_INFO, __VA_ARGS__)
+
+/**
+ * Logs debug information
+ * @param _logger The logger
+ * @param ... A format string literal, followed by the arguments
+ */
+#define ENXLOG_DEBUG(_logger, ...) ENXLOG_LOG(_logger, LOGLEVEL_DEBUG, __VA_ARGS__)
+
+/**
+ * Logs trace information
+ * @param _logger The logger
+ * @param ... A format string literal, followed by the arguments
+ */
+#define ENXLOG_TRACE(_logger, ...) ENXLOG_LOG(_logger, LOGLEVEL_TRACE, __VA_ARGS__)
+
+/** @} */
+
+#endif
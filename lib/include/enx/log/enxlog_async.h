@@ -0,0 +1,100 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_ASYNC_H
+#define ENXLOG_ASYNC_H
+
+#include <enx/log/enxlog.h>
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup async_functions Async Functions
+ *
+ * The async mode is only available when the library is built with the
+ * LIBENXLOG_ASYNC option.
+ *
+ * While the async mode runs, entries that pass the filter are formatted by
+ * the logging thread into a ring owned by that thread. The ring is created
+ * on the thread's first entry and retired when the thread exits. A consumer
+ * thread merges the rings by timestamp and writes the entries to the sinks
+ * in batches, so the sinks only ever run on the consumer thread and the
+ * output stays in time order across threads. A thread whose ring is full
+ * waits for the consumer.
+ *
+ * Structured fields reach the sinks as " key=value" text, as they do when
+ * the tail buffer is replayed.
+ * @{
+ */
+
+/**
+ * The default size of each thread's ring in bytes
+ */
+#ifndef ENXLOG_ASYNC_RING_SIZE
+#define ENXLOG_ASYNC_RING_SIZE (256 * 1024)
+#endif
+
+/**
+ * The maximum length of a queued message. Longer messages are truncated.
+ */
+#ifndef ENXLOG_ASYNC_MAX_MESSAGE
+#define ENXLOG_ASYNC_MAX_MESSAGE 1024
+#endif
+
+/**
+ * The interval at which an idle consumer looks for new entries
+ */
+#ifndef ENXLOG_ASYNC_POLL_INTERVAL_US
+#define ENXLOG_ASYNC_POLL_INTERVAL_US 1000
+#endif
+
+/**
+ * Starts the consumer thread. Call after the instances have been
+ * initialized.
+ *
+ * @param ring_size The size of each thread's ring in bytes, rounded up to a
+ * power of two, or 0 for #ENXLOG_ASYNC_RING_SIZE
+ * @returns false if the ring size is too small or the thread could not be
+ * started
+ */
+bool enxlog_async_start(size_t ring_size);
+
+/**
+ * Writes all queued entries and stops the consumer thread. Entries logged
+ * afterwards are written by the logging thread again. Called by
+ * enxlog_shutdown().
+ */
+void enxlog_async_stop(void);
+
+/**
+ * Waits until every entry logged before the call, by any thread, has been
+ * written to the sinks
+ */
+void enxlog_async_flush(void);
+
+/** @} */
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,101 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_DEFERRED_H
+#define ENXLOG_DEFERRED_H
+
+#include <enx/log/enxlog.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup deferred_functions Deferred Functions
+ *
+ * The deferred mode is only available when the library is built with the
+ * LIBENXLOG_DEFERRED option.
+ *
+ * Entries that pass the filter are formatted into a fixed ring of slots in
+ * static memory instead of being written to the sinks. Reserving a slot
+ * takes a single compare and swap and never waits, and the instance lock is
+ * not taken, so entries can be logged from any context, including interrupt
+ * handlers and signal handlers that preempt a thread that is writing to the
+ * sinks. The main loop writes the queued entries to the sinks with
+ * enxlog_deferred_drain(), which takes the instance lock.
+ *
+ * When the ring is full new entries are dropped, and the next drain writes a
+ * warning with the number of dropped entries. A slot that has been reserved
+ * but not yet filled, e.g. by a thread that was interrupted, holds back the
+ * entries after it until the next drain.
+ *
+ * Structured fields reach the sinks as " key=value" text, as they do when
+ * the tail buffer is replayed.
+ * @{
+ */
+
+/**
+ * The number of slots in the ring. Must be a power of two.
+ */
+#ifndef ENXLOG_DEFERRED_SLOTS
+#define ENXLOG_DEFERRED_SLOTS 64
+#endif
+
+/**
+ * The maximum length of a deferred message. Longer messages are truncated.
+ */
+#ifndef ENXLOG_DEFERRED_MAX_MESSAGE
+#define ENXLOG_DEFERRED_MAX_MESSAGE 128
+#endif
+
+/*
+ * Targets without a compare and swap instruction, e.g. Cortex-M0, can
+ * reserve slots with interrupts masked instead by defining
+ * ENXLOG_DEFERRED_IRQ_SAVE(state) and ENXLOG_DEFERRED_IRQ_RESTORE(state)
+ * when building the library. The state is a uint32_t.
+ */
+
+/**
+ * Writes the queued entries to the sinks, oldest first. Call from the main
+ * loop, or from a single task. Calls made while another drain is running
+ * return immediately. Called by enxlog_shutdown().
+ *
+ * @returns The number of entries written
+ */
+size_t enxlog_deferred_drain(void);
+
+/**
+ * Returns true if there are entries waiting to be drained
+ */
+bool enxlog_deferred_pending(void);
+
+/**
+ * Returns the number of entries that were dropped because the ring was full
+ */
+uint32_t enxlog_deferred_dropped(void);
+
+/** @} */
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,76 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_EARLY_BUFFER_H
+#define ENXLOG_EARLY_BUFFER_H
+
+#include <enx/log/enxlog.h>
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup early_buffer_functions Early Buffer Functions
+ *
+ * The early buffer is only available when the library is built with the
+ * LIBENXLOG_EARLY_BUFFER option.
+ *
+ * Entries logged before enxlog_init(), e.g. from static constructors, are
+ * formatted into a fixed size static buffer instead of being dropped. Once
+ * enxlog_init() has initialized the sinks, the buffered entries are passed
+ * through the filter and written to the sinks in the order they were logged,
+ * with the time at which they were logged. Only entries of the default
+ * instance are buffered.
+ *
+ * When the buffer fills up the oldest entries are dropped, and a warning with
+ * the number of dropped entries is written after the replayed entries.
+ * Entries logged by other threads while enxlog_init() is running are
+ * written after the replayed entries.
+ * @{
+ */
+
+/**
+ * The size of the early buffer in bytes
+ */
+#ifndef ENXLOG_EARLY_BUFFER_SIZE
+#define ENXLOG_EARLY_BUFFER_SIZE 16384
+#endif
+
+/**
+ * The maximum length of a buffered message. Longer messages are truncated.
+ */
+#ifndef ENXLOG_EARLY_BUFFER_MAX_MESSAGE
+#define ENXLOG_EARLY_BUFFER_MAX_MESSAGE 256
+#endif
+
+/**
+ * Returns the number of entries logged before enxlog_init() that did not fit
+ * in the early buffer
+ */
+uint64_t enxlog_early_buffer_dropped(void);
+
+/** @} */
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,142 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_HEX_H
+#define ENXLOG_HEX_H
+
+#include <enx/log/enxlog.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup hex_functions Binary Payload Arguments
+ *
+ * Format arguments that write byte buffers as hex, for example protocol
+ * frames. Bytes are encoded with SIMD where available (AVX2, SSE2 or NEON)
+ * into a stack buffer, which is passed to the sinks in large chunks.
+ *
+ * \code
+ * LOG_DEBUG(logger, "Frame {}", f_hex(frame, frame_length));
+ * LOG_DEBUG(logger, "Frame:\n{}", f_hexdump(frame, frame_length));
+ * \endcode
+ *
+ * A hexdump is written as lines of 16 bytes, optionally with an offset and
+ * an ASCII column:
+ *
+ * \code
+ * 00000000  47 45 54 20 2f 20 48 54  54 50 2f 31 2e 31 0d 0a  |GET / HTTP/1.1..|
+ * \endcode
+ * @{
+ */
+
+/**
+ * The maximum number of bytes written by f_hex() and f_hexdump(). Longer
+ * buffers are truncated and the total length is noted.
+ */
+#ifndef ENXLOG_HEX_LIMIT
+#define ENXLOG_HEX_LIMIT 4096
+#endif
+
+/**
+ * Write lines of 16 bytes, separated by spaces
+ */
+#define ENXLOG_HEX_DUMP 0x01
+
+/**
+ * Start each hexdump line with its offset
+ */
+#define ENXLOG_HEX_OFFSET 0x02
+
+/**
+ * End each hexdump line with the printable ASCII characters
+ */
+#define ENXLOG_HEX_ASCII 0x04
+
+/**
+ * A byte buffer argument
+ * @private
+ */
+struct enxlog_hex
+{
+    const void *ptr;
+    size_t length;
+    size_t limit;
+    unsigned int flags;
+};
+
+/**
+ * Formats a byte buffer argument
+ * @private
+ */
+void enxlog_hex_fmt(
+    const struct enxtxt_fstr_arg *arg,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context);
+
+/**
+ * Encodes bytes as lower case hex
+ *
+ * @param output Receives 2 * length characters. It is not terminated.
+ * @param input The bytes to encode
+ * @param length The number of bytes
+ */
+void enxlog_hex_encode(char *output, const void *input, size_t length);
+
+/**
+ * Byte buffer argument with explicit flags and limit
+ *
+ * @param _ptr The buffer
+ * @param _length The length of the buffer
+ * @param _flags A combination of ENXLOG_HEX_DUMP, ENXLOG_HEX_OFFSET and ENXLOG_HEX_ASCII
+ * @param _limit The maximum number of bytes written
+ */
+#define f_hex_ex(_ptr, _length, _flags, _limit)             \
+    {                                                       \
+        .fn_fmt = enxlog_hex_fmt,                           \
+        ._user = &(const struct enxlog_hex) {               \
+            .ptr = (_ptr),                                  \
+            .length = (_length),                            \
+            .limit = (_limit),                              \
+            .flags = (_flags)                               \
+        }                                                   \
+    }
+
+/**
+ * Byte buffer argument, written as contiguous hex, e.g. a5b2aaff
+ */
+#define f_hex(_ptr, _length) \
+    f_hex_ex(_ptr, _length, 0, ENXLOG_HEX_LIMIT)
+
+/**
+ * Byte buffer argument, written as a hexdump with offset and ASCII columns
+ */
+#define f_hexdump(_ptr, _length) \
+    f_hex_ex(_ptr, _length, ENXLOG_HEX_DUMP | ENXLOG_HEX_OFFSET | ENXLOG_HEX_ASCII, ENXLOG_HEX_LIMIT)
+
+/** @} */
+
+__END_DECLS
+
+#endif
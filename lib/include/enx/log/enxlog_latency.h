@@ -0,0 +1,135 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_LATENCY_H
+#define ENXLOG_LATENCY_H
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup latency_functions Latency Functions
+ *
+ * Latency histograms are only available when the library is built with the
+ * LIBENXLOG_LATENCY option. Values are recorded in nanoseconds into
+ * log-linear buckets with a relative error of at most 1/32.
+ * @{
+ */
+
+/**
+ * Number of linear sub-buckets per power of two, as a power of two
+ */
+#define ENXLOG_HISTOGRAM_SUB_BUCKET_BITS 5
+
+/**
+ * Largest power of two that can be recorded. Larger values are clamped.
+ */
+#define ENXLOG_HISTOGRAM_MAX_BITS 40
+
+/**
+ * Number of buckets in a histogram
+ */
+#define ENXLOG_HISTOGRAM_BUCKETS \
+    ((ENXLOG_HISTOGRAM_MAX_BITS - ENXLOG_HISTOGRAM_SUB_BUCKET_BITS + 2) << ENXLOG_HISTOGRAM_SUB_BUCKET_BITS)
+
+/**
+ * Latency histogram identifiers
+ */
+enum enxlog_latency_histogram_id
+{
+    /** Time spent by the producer inside the log call */
+    ENXLOG_LATENCY_PRODUCER = 0,
+
+    /** Time from the log call until the sinks have written the record */
+    ENXLOG_LATENCY_END_TO_END,
+
+    ENXLOG_LATENCY_HISTOGRAM_COUNT
+};
+
+/**
+ * Histogram snapshot
+ */
+struct enxlog_histogram
+{
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[ENXLOG_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * Returns a timestamp in nanoseconds in the timebase used by the histograms
+ */
+uint64_t enxlog_latency_now(void);
+
+/**
+ * Records a value into a histogram
+ *
+ * Sinks that defer writing can use this to record the end to end latency
+ * once the data has actually been written.
+ *
+ * @param id The histogram to record to
+ * @param value_ns The value, in nanoseconds
+ */
+void enxlog_latency_record(enum enxlog_latency_histogram_id id, uint64_t value_ns);
+
+/**
+ * Copies a histogram
+ *
+ * @param id The histogram to copy
+ * @param histogram The destination
+ */
+void enxlog_latency_snapshot(enum enxlog_latency_histogram_id id, struct enxlog_histogram *histogram);
+
+/**
+ * Clears all histograms
+ */
+void enxlog_latency_reset(void);
+
+/**
+ * Enables periodic logging of the latency histograms
+ *
+ * When enabled, the library logs the percentiles of each histogram at
+ * LOGLEVEL_INFO on the enxlog::latency logger, which a configuration file
+ * filters as enxlog.latency. A filter entry for enxlog also applies to it.
+ *
+ * @param interval_ms The logging interval in milliseconds, or 0 to disable
+ */
+void enxlog_latency_log_interval(uint32_t interval_ms);
+
+/**
+ * Returns the value at a percentile of a histogram
+ *
+ * The returned value is the highest value equivalent to the bucket that the
+ * percentile falls in.
+ *
+ * @param histogram The histogram
+ * @param percentile The percentile, e.g. 99.9
+ */
+uint64_t enxlog_histogram_percentile(const struct enxlog_histogram *histogram, double percentile);
+
+/** @} */
+
+__END_DECLS
+
+#endif
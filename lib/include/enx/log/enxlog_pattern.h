@@ -0,0 +1,244 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_PATTERN_H
+#define ENXLOG_PATTERN_H
+
+#include <enx/log/enxlog.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup pattern_functions Header Pattern Functions
+ *
+ * A header pattern describes the prefix that text sinks write ahead of each
+ * message. The pattern is compiled once into a list of operations, so that
+ * writing a header involves no format string parsing, and values the
+ * pattern does not use are never computed.
+ *
+ * The following directives are supported:
+ *
+ * | Directive | Output                                      |
+ * |-----------|---------------------------------------------|
+ * | %%T       | Local time, e.g. 2022-01-01 12:00:00.000    |
+ * | %%L       | Level, e.g. -- INFO  --                     |
+ * | %%N       | Logger path, e.g. sys::drivers::uart::      |
+ * | %%F       | Function                                    |
+ * | %%l       | Line                                        |
+ * | %%t       | Thread id                                   |
+ * | %%C       | Color of the level                          |
+ * | %%g       | Gray                                        |
+ * | %%b       | Brown                                       |
+ * | %%c       | Reset color                                 |
+ * | %%%       | %                                           |
+ *
+ * Colors are not counted in the header width that sinks use to indent
+ * continuation lines. How newlines inside a message are written is set by
+ * the newline member of the pattern.
+ * @{
+ */
+
+/**
+ * The default header pattern
+ */
+#define ENXLOG_PATTERN_DEFAULT "%T %L %N%F:%l: "
+
+/**
+ * The default header pattern of the color sink
+ */
+#define ENXLOG_PATTERN_DEFAULT_COLOR "%g%T%c %C%L%c %b%N%F:%l%c: "
+
+/**
+ * The maximum number of operations in a pattern
+ */
+#ifndef ENXLOG_PATTERN_MAX_OPS
+#define ENXLOG_PATTERN_MAX_OPS 32
+#endif
+
+/**
+ * The maximum total length of the literal text in a pattern
+ */
+#ifndef ENXLOG_PATTERN_MAX_LITERALS
+#define ENXLOG_PATTERN_MAX_LITERALS 128
+#endif
+
+/**
+ * The size of the buffer sinks use to format a header. Longer headers are
+ * truncated.
+ */
+#ifndef ENXLOG_PATTERN_MAX_HEADER
+#define ENXLOG_PATTERN_MAX_HEADER 512
+#endif
+
+/**
+ * How text sinks write newlines inside a message
+ */
+enum enxlog_pattern_newline
+{
+    /** Start a new line, indented to the width of the header */
+    ENXLOG_PATTERN_NEWLINE_INDENT = 0,
+
+    /** Write the two characters \\n, so that every entry stays on one line */
+    ENXLOG_PATTERN_NEWLINE_ESCAPE,
+
+    /** Write the newline unchanged */
+    ENXLOG_PATTERN_NEWLINE_RAW
+};
+
+/**
+ * Pattern operation type
+ */
+enum enxlog_pattern_op_type
+{
+    ENXLOG_PATTERN_OP_LITERAL = 0,
+    ENXLOG_PATTERN_OP_COLOR,
+    ENXLOG_PATTERN_OP_LEVEL_COLOR,
+    ENXLOG_PATTERN_OP_TIMESTAMP,
+    ENXLOG_PATTERN_OP_LEVEL,
+    ENXLOG_PATTERN_OP_LOGGER,
+    ENXLOG_PATTERN_OP_FUNC,
+    ENXLOG_PATTERN_OP_LINE,
+    ENXLOG_PATTERN_OP_THREAD
+};
+
+/**
+ * Pattern operation
+ *
+ * Literal and color operations refer to length bytes at offset in the
+ * literal storage of the pattern.
+ */
+struct enxlog_pattern_op
+{
+    uint8_t type;
+    uint8_t length;
+    uint16_t offset;
+};
+
+/**
+ * Compiled pattern
+ */
+struct enxlog_pattern
+{
+    struct enxlog_pattern_op ops[ENXLOG_PATTERN_MAX_OPS];
+    size_t count;
+    char literals[ENXLOG_PATTERN_MAX_LITERALS];
+    size_t literals_length;
+    uint8_t newline;
+};
+
+/**
+ * The compiled #ENXLOG_PATTERN_DEFAULT pattern
+ */
+extern const struct enxlog_pattern enxlog_pattern_default;
+
+/**
+ * The compiled #ENXLOG_PATTERN_DEFAULT_COLOR pattern
+ */
+extern const struct enxlog_pattern enxlog_pattern_default_color;
+
+/**
+ * Compiles a pattern
+ *
+ * @param pattern The pattern to compile into
+ * @param text The pattern text
+ * @returns false if the text contains an unknown directive or does not fit
+ */
+bool enxlog_pattern_compile(struct enxlog_pattern *pattern, const char *text);
+
+#ifndef ENXLOG_NO_HEAP
+
+/**
+ * Allocates and compiles a pattern
+ *
+ * The *_destroy() functions of the sinks free the pattern of their
+ * context, which must then come from this function or be NULL.
+ *
+ * @returns NULL if the pattern could not be allocated or compiled
+ */
+struct enxlog_pattern *enxlog_pattern_create(const char *text);
+
+/**
+ * Frees a pattern returned by enxlog_pattern_create()
+ */
+void enxlog_pattern_destroy(struct enxlog_pattern *pattern);
+
+#endif
+
+/**
+ * Formats a header
+ *
+ * @param pattern The compiled pattern
+ * @param buffer The output buffer
+ * @param size The size of the output buffer
+ * @param width Receives the printed width of the header, excluding colors. May be NULL.
+ * @returns The number of bytes written
+ */
+size_t enxlog_pattern_format(
+    const struct enxlog_pattern *pattern,
+    char *buffer,
+    size_t size,
+    size_t *width,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+/**
+ * Writes part of a message through a sink
+ */
+typedef void (*enxlog_pattern_write_fn_t)(void *stream, const char *ptr, size_t length);
+
+/**
+ * Writes part of a message, handling the newlines it contains
+ *
+ * The text is scanned with memchr(), so fragments without newlines are
+ * passed through in a single write. Continuation line indentation is
+ * written as a single block.
+ *
+ * @param pattern The pattern of the sink, or NULL for the default
+ * @param width The header width returned by enxlog_pattern_format()
+ * @param ptr The text
+ * @param length The length of the text
+ * @param write The function that writes to the sink
+ * @param stream Passed to write
+ */
+void enxlog_pattern_write_message(
+    const struct enxlog_pattern *pattern,
+    size_t width,
+    const char *ptr,
+    size_t length,
+    enxlog_pattern_write_fn_t write,
+    void *stream);
+
+/**
+ * An #enxlog_pattern_write_fn_t that writes to a FILE *
+ */
+void enxlog_pattern_write_file(void *stream, const char *ptr, size_t length);
+
+/** @} */
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,131 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_POOL_H
+#define ENXLOG_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup pool_functions Buffer Pool Functions
+ *
+ * The buffer pool is only available when the library is built with the
+ * LIBENXLOG_POOL option.
+ *
+ * Once the pool is initialized, the per thread tail buffers and async rings
+ * are allocated from it instead of the heap. Blocks are sized in powers of
+ * two and the size of each block is kept in a table apart from the blocks,
+ * so a power of two buffer takes a block of exactly its size. Objects of up
+ * to a quarter of the smallest block, like the async ring headers, share a
+ * block with other objects of their size. When a thread exits its blocks
+ * are merged with their free buddies and kept on per size free lists, so
+ * that the next thread reuses them. The pool never grows
+ * beyond its capacity; a thread that cannot get a buffer logs as if the
+ * feature was disabled.
+ *
+ * There are no per thread caches, as each thread allocates its buffers
+ * once.
+ *
+ * Initialize the pool before enabling the tail buffer or starting the
+ * async mode. Buffers allocated earlier stay on the heap.
+ * @{
+ */
+
+/**
+ * The smallest block size, as a power of two
+ */
+#ifndef ENXLOG_POOL_MIN_BLOCK_BITS
+#define ENXLOG_POOL_MIN_BLOCK_BITS 12
+#endif
+
+/**
+ * Pool statistics
+ */
+struct enxlog_pool_stats
+{
+    /** The bytes available for blocks, after the block table */
+    size_t capacity;
+
+    /** The bytes in blocks that are in use */
+    size_t used;
+
+    /** The highest value of used */
+    size_t peak;
+
+    /** The bytes that have been carved into blocks */
+    size_t carved;
+
+    /** The number of blocks and small objects handed out */
+    uint64_t allocations;
+
+    /** The number of requests that did not fit */
+    uint64_t failures;
+
+    /** True if the backing memory is mapped with huge pages */
+    bool hugepages;
+};
+
+/**
+ * Initializes the pool on anonymous memory. Huge pages are used when the
+ * system has them reserved; otherwise transparent huge pages are requested.
+ *
+ * @param capacity The size of the pool in bytes
+ * @returns false if the pool is already initialized or the memory could not
+ * be mapped
+ */
+bool enxlog_pool_init(size_t capacity);
+
+/**
+ * Initializes the pool on caller supplied memory, e.g. a static array on
+ * targets without mmap
+ *
+ * @param storage The backing memory, which must outlive the pool
+ * @param size The size of the backing memory in bytes
+ * @returns false if the pool is already initialized or the memory is too
+ * small for one block
+ */
+bool enxlog_pool_init_static(void *storage, size_t size);
+
+/**
+ * Releases the backing memory
+ *
+ * @returns false if blocks are still in use, in which case the pool stays
+ * initialized
+ */
+bool enxlog_pool_shutdown(void);
+
+/**
+ * Copies the pool statistics
+ *
+ * @param stats The destination
+ */
+void enxlog_pool_snapshot(struct enxlog_pool_stats *stats);
+
+/** @} */
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,129 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_PROFILER_H
+#define ENXLOG_PROFILER_H
+
+#include <enx/log/enxlog.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup profiler_functions Profiler Functions
+ *
+ * The profiler is only available when the library is built with the
+ * LIBENXLOG_PROFILER option. It keeps counters for every call site
+ * (logger, function and line) that invokes a log macro, including
+ * invocations that are rejected by the filter.
+ * @{
+ */
+
+/**
+ * The maximum number of call sites tracked by the profiler
+ */
+#ifndef ENXLOG_PROFILER_MAX_SITES
+#define ENXLOG_PROFILER_MAX_SITES 1024
+#endif
+
+/**
+ * Profiler sort key
+ */
+enum enxlog_profiler_sort_key
+{
+    ENXLOG_PROFILER_SORT_BYTES = 0,
+    ENXLOG_PROFILER_SORT_RECORDS,
+    ENXLOG_PROFILER_SORT_INVOCATIONS,
+    ENXLOG_PROFILER_SORT_TIME
+};
+
+/**
+ * Profiler call site statistics
+ */
+struct enxlog_profiler_site
+{
+    const struct enxlog_logger *logger;
+    const char *func;
+    unsigned int line;
+
+    /** Number of times the log macro was invoked */
+    uint64_t invocations;
+
+    /** Number of records that passed the filter and were sent to the sinks */
+    uint64_t records;
+
+    /** Number of message bytes sent to the sinks (excluding sink headers) */
+    uint64_t bytes;
+
+    /** Cumulative time spent in the log call, in nanoseconds */
+    uint64_t time_ns;
+};
+
+/**
+ * Copies the call site statistics, sorted in descending order
+ *
+ * @param sites The destination array
+ * @param max_sites The size of the destination array
+ * @param sort_key The field to sort on
+ * @returns The number of sites copied
+ */
+size_t enxlog_profiler_snapshot(
+    struct enxlog_profiler_site *sites,
+    size_t max_sites,
+    enum enxlog_profiler_sort_key sort_key);
+
+/**
+ * Writes a report of the call site statistics, sorted in descending order
+ *
+ * @param file The file to write the report to
+ * @param sort_key The field to sort on
+ */
+void enxlog_profiler_report(FILE *file, enum enxlog_profiler_sort_key sort_key);
+
+/**
+ * Requests a report to be written when enxlog_shutdown() is called
+ *
+ * @param file The file to write the report to, or NULL to disable the report
+ * @param sort_key The field to sort on
+ */
+void enxlog_profiler_report_on_shutdown(FILE *file, enum enxlog_profiler_sort_key sort_key);
+
+/**
+ * Returns the number of call sites that could not be tracked because the
+ * site table was full
+ */
+uint64_t enxlog_profiler_dropped_sites(void);
+
+/**
+ * Clears all call site statistics
+ *
+ * Must not be called while other threads are logging.
+ */
+void enxlog_profiler_reset(void);
+
+/** @} */
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,91 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_TAIL_BUFFER_H
+#define ENXLOG_TAIL_BUFFER_H
+
+#include <enx/log/enxlog.h>
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/** \defgroup tail_buffer_functions Tail Buffer Functions
+ *
+ * The tail buffer is only available when the library is built with the
+ * LIBENXLOG_TAIL_BUFFER option.
+ *
+ * When enabled, entries that are rejected by the filter but are at or above
+ * the capture loglevel are formatted into a bounded buffer owned by the
+ * calling thread instead of being dropped. The buffered entries are written
+ * to the sinks, ahead of the triggering entry, when the thread logs an entry
+ * at or below the trigger loglevel, or when enxlog_tail_buffer_flush() is
+ * called. Otherwise the oldest entries are discarded as the buffer fills up.
+ *
+ * Buffered entries carry the time at which they were logged, not the time at
+ * which they are written to the sinks.
+ * @{
+ */
+
+/**
+ * The maximum length of a buffered message. Longer messages are truncated.
+ */
+#ifndef ENXLOG_TAIL_BUFFER_MAX_MESSAGE
+#define ENXLOG_TAIL_BUFFER_MAX_MESSAGE 1024
+#endif
+
+/**
+ * Enables the tail buffer for all threads
+ *
+ * @param capture_loglevel The most verbose loglevel to buffer, e.g. LOGLEVEL_TRACE
+ * @param trigger_loglevel The least verbose loglevel that flushes the buffer, e.g. LOGLEVEL_ERROR
+ * @param capacity The size of each thread's buffer in bytes
+ */
+bool enxlog_tail_buffer_enable(
+    enum enxlog_loglevel capture_loglevel,
+    enum enxlog_loglevel trigger_loglevel,
+    size_t capacity);
+
+/**
+ * Disables the tail buffer. Buffered entries are discarded as each thread
+ * exits.
+ */
+void enxlog_tail_buffer_disable(void);
+
+/**
+ * Writes the calling thread's buffered entries to the sinks, e.g. when the
+ * current request has failed
+ */
+void enxlog_tail_buffer_flush(void);
+
+/**
+ * Discards the calling thread's buffered entries, e.g. when the current
+ * request has completed successfully
+ */
+void enxlog_tail_buffer_discard(void);
+
+/** @} */
+
+__END_DECLS
+
+#endif
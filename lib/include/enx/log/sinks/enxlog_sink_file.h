@@ -24,6 +24,7 @@
 #define ENXLOG_SINK_FILE_H
 
 #include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
 
 #include <stdio.h>
 #include <sys/cdefs.h>
@@ -31,16 +32,50 @@
 __BEGIN_DECLS
 
 
+/**
+ * File compression
+ *
+ * Compression other than ENXLOG_SINK_FILE_COMPRESSION_NONE requires the
+ * library to be built with the LIBENXLOG_COMPRESSION CMake option.
+ */
+enum enxlog_sink_file_compression
+{
+    ENXLOG_SINK_FILE_COMPRESSION_NONE,
+    ENXLOG_SINK_FILE_COMPRESSION_LZ4,
+    ENXLOG_SINK_FILE_COMPRESSION_ZSTD
+};
+
+/**
+ * Size of the blocks that are compressed into independent frames. Up to four
+ * blocks, the one being filled and those waiting for the compression thread,
+ * are lost if the process crashes.
+ */
+#ifndef ENXLOG_FILE_COMPRESSION_BLOCK_SIZE
+#define ENXLOG_FILE_COMPRESSION_BLOCK_SIZE (256 * 1024)
+#endif
+
+/**
+ * Interval after which a partially filled block is compressed and written
+ */
+#ifndef ENXLOG_FILE_COMPRESSION_FLUSH_INTERVAL_MS
+#define ENXLOG_FILE_COMPRESSION_FLUSH_INTERVAL_MS 1000
+#endif
+
+
 struct enxlog_sink_file_context
 {
     const char *path;
     FILE *file;
     size_t tag_length;
+    enum enxlog_sink_file_compression compression;
+    const struct enxlog_pattern *pattern;
 };
 
 
+#ifndef ENXLOG_NO_HEAP
 struct enxlog_sink_file_context *enxlog_sink_file_create();
 void enxlog_sink_file_destroy(void *context);
+#endif
 
 bool enxlog_sink_file_init(void *context);
 void enxlog_sink_file_shutdown(void *context);
@@ -60,6 +95,11 @@ void enxlog_sink_file_log_entry_write(
 void enxlog_sink_file_log_entry_close(
     void *context);
 
+void enxlog_sink_file_log_batch(
+    void *context,
+    const struct enxlog_record *records,
+    size_t count);
+
 
 __END_DECLS
 
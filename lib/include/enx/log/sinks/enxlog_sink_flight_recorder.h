@@ -0,0 +1,104 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_SINK_FLIGHT_RECORDER_H
+#define ENXLOG_SINK_FLIGHT_RECORDER_H
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+
+#include <signal.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * Signals that trigger a crash dump
+ */
+#define ENXLOG_FLIGHT_RECORDER_SIGNAL_COUNT 5
+
+/**
+ * Flight recorder sink
+ *
+ * Keeps the most recent log output in a preallocated ring buffer. The buffer
+ * can be dumped on demand with enxlog_flight_recorder_dump() or automatically
+ * when the process crashes.
+ *
+ * For compile-time initialization, point buffer at a static array and set
+ * size to its length. Set crash_dump to "stderr" or to a file path to dump
+ * the buffer from the SIGSEGV, SIGABRT, SIGBUS, SIGILL and SIGFPE handlers.
+ *
+ * The sink is only available when the library is built with the
+ * LIBENXLOG_FLIGHT_RECORDER CMake option.
+ */
+struct enxlog_sink_flight_recorder_context
+{
+    char *buffer;
+    size_t size;
+    const char *crash_dump;
+    const struct enxlog_pattern *pattern;
+
+    size_t head;
+    bool wrapped;
+    size_t tag_length;
+    int crash_fd;
+    struct sigaction previous_actions[ENXLOG_FLIGHT_RECORDER_SIGNAL_COUNT];
+};
+
+#ifndef ENXLOG_NO_HEAP
+struct enxlog_sink_flight_recorder_context *enxlog_sink_flight_recorder_create(size_t size);
+void enxlog_sink_flight_recorder_destroy(void *context);
+#endif
+
+bool enxlog_sink_flight_recorder_init(void *context);
+void enxlog_sink_flight_recorder_shutdown(void *context);
+
+void enxlog_sink_flight_recorder_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_flight_recorder_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_flight_recorder_log_entry_close(
+    void *context);
+
+/**
+ * Writes the contents of the active flight recorder to a file descriptor
+ *
+ * The oldest, possibly partial, line is skipped when the buffer has wrapped.
+ * This function is async-signal-safe.
+ *
+ * @param fd The file descriptor to write to
+ * @returns false if no flight recorder is active or the write failed
+ */
+bool enxlog_flight_recorder_dump(int fd);
+
+
+__END_DECLS
+
+#endif
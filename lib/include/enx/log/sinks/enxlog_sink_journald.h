@@ -0,0 +1,118 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#ifndef ENXLOG_SINK_JOURNALD_H
+#define ENXLOG_SINK_JOURNALD_H
+
+#include <enx/log/enxlog.h>
+
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * Default journal socket path
+ */
+#ifndef ENXLOG_JOURNALD_PATH
+#define ENXLOG_JOURNALD_PATH "/run/systemd/journal/socket"
+#endif
+
+/**
+ * The size of the record buffer. Longer messages and fields are truncated.
+ */
+#ifndef ENXLOG_JOURNALD_RECORD_SIZE
+#define ENXLOG_JOURNALD_RECORD_SIZE (64 * 1024)
+#endif
+
+/**
+ * The maximum length of a journal field name
+ */
+#define ENXLOG_JOURNALD_MAX_FIELD_NAME 64
+
+
+/**
+ * journald sink
+ *
+ * Sends each record to the journal over its native protocol, as fields
+ * rather than text:
+ *
+ * | Field             | Value                                |
+ * |-------------------|--------------------------------------|
+ * | MESSAGE           | The message                          |
+ * | PRIORITY          | 3 (error), 4 (warn), 6 (info), 7     |
+ * | SYSLOG_IDENTIFIER | identifier, or the program name      |
+ * | CODE_FUNC         | Function                             |
+ * | CODE_LINE         | Line                                 |
+ * | ENXLOG_LOGGER     | Logger path, e.g. sys.drivers.uart   |
+ *
+ * Structured fields are sent as journal fields, with the key converted to
+ * upper case and characters other than A-Z, 0-9 and _ replaced by _.
+ *
+ * Records that the socket cannot take as a single datagram, or that are
+ * larger than max_datagram when it is set, are passed to the journal in a
+ * sealed memfd. Sends to path, or ENXLOG_JOURNALD_PATH when it is NULL.
+ */
+struct enxlog_sink_journald_context
+{
+    const char *path;
+    const char *identifier;
+    size_t max_datagram;
+
+    int fd;
+    char *record;
+    size_t length;
+    size_t message_start;
+    bool message_open;
+};
+
+
+struct enxlog_sink_journald_context *enxlog_sink_journald_create();
+void enxlog_sink_journald_destroy(void *context);
+
+bool enxlog_sink_journald_init(void *context);
+void enxlog_sink_journald_shutdown(void *context);
+
+void enxlog_sink_journald_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_journald_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_journald_log_entry_field(
+    void *context,
+    const char *key,
+    const struct enxtxt_fstr_arg *value);
+
+void enxlog_sink_journald_log_entry_close(
+    void *context);
+
+
+__END_DECLS
+
+#endif
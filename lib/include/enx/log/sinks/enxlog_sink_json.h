@@ -0,0 +1,99 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#ifndef ENXLOG_SINK_JSON_H
+#define ENXLOG_SINK_JSON_H
+
+#include <enx/log/enxlog.h>
+
+#include <stdio.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * The size of the line buffer. Longer records are truncated, but remain
+ * valid JSON.
+ */
+#ifndef ENXLOG_SINK_JSON_LINE_SIZE
+#define ENXLOG_SINK_JSON_LINE_SIZE 8192
+#endif
+
+
+/**
+ * JSON lines sink
+ *
+ * Writes one JSON object per record:
+ *
+ *     {"timestamp":"2022-01-01T00:00:00.000Z","level":"info","logger":"a.b",
+ *      "func":"main","line":12,"message":"...","fields":{"key":value}}
+ *
+ * Field values that format as integers are written as JSON numbers, all
+ * other values as strings. The record is assembled in a line buffer held in
+ * the context, so no memory is allocated per record. Writes to stdout when
+ * path is NULL.
+ */
+struct enxlog_sink_json_context
+{
+    const char *path;
+    FILE *file;
+
+    char line[ENXLOG_SINK_JSON_LINE_SIZE];
+    size_t length;
+    bool message_open;
+    bool fields_open;
+};
+
+
+#ifndef ENXLOG_NO_HEAP
+struct enxlog_sink_json_context *enxlog_sink_json_create();
+void enxlog_sink_json_destroy(void *context);
+#endif
+
+bool enxlog_sink_json_init(void *context);
+void enxlog_sink_json_shutdown(void *context);
+
+void enxlog_sink_json_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_json_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_json_log_entry_field(
+    void *context,
+    const char *key,
+    const struct enxtxt_fstr_arg *value);
+
+void enxlog_sink_json_log_entry_close(
+    void *context);
+
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,143 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_SINK_MMAP_RING_H
+#define ENXLOG_SINK_MMAP_RING_H
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * Ring file magic ("ENXLRING")
+ */
+#define ENXLOG_MMAP_RING_MAGIC 0x474e49524c584e45ull
+
+/**
+ * Ring file format version
+ */
+#define ENXLOG_MMAP_RING_VERSION 1
+
+/**
+ * Record length that marks the end of the used space before a wrap
+ */
+#define ENXLOG_MMAP_RING_WRAP 0xffffffffu
+
+/**
+ * Record alignment in the data area
+ */
+#define ENXLOG_MMAP_RING_ALIGNMENT 8
+
+/**
+ * Ring file header
+ *
+ * The data area follows the header. Records are stored from tail to head,
+ * each one starting with a struct enxlog_mmap_ring_record and padded to
+ * ENXLOG_MMAP_RING_ALIGNMENT. The ring is empty when head equals tail.
+ * A record with length ENXLOG_MMAP_RING_WRAP, or reaching the end of the
+ * data area, continues at offset 0.
+ */
+struct enxlog_mmap_ring_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t dropped;
+};
+
+/**
+ * Ring record header
+ */
+struct enxlog_mmap_ring_record
+{
+    uint32_t length;
+    uint32_t reserved;
+};
+
+
+/**
+ * Memory mapped ring file sink
+ *
+ * Writes records into a fixed size, file backed mapping that is used as a
+ * circular log. Writing a record is a memory copy; the page cache keeps the
+ * data if the process crashes. Use enxlog_mmap_ring_reader to extract the
+ * records in order.
+ *
+ * The sink and the reader are only available when the library is built
+ * with the LIBENXLOG_MMAP_RING CMake option. The ring file format above is
+ * always available, as the shared memory sink uses its records.
+ */
+struct enxlog_sink_mmap_ring_context
+{
+    const char *path;
+    size_t size;
+    const struct enxlog_pattern *pattern;
+
+    int fd;
+    struct enxlog_mmap_ring_header *header;
+    char *data;
+    char *record;
+    size_t record_length;
+    size_t tag_length;
+};
+
+/**
+ * The maximum length of a single record. Longer records are truncated.
+ */
+#ifndef ENXLOG_MMAP_RING_MAX_RECORD
+#define ENXLOG_MMAP_RING_MAX_RECORD 4096
+#endif
+
+#ifndef ENXLOG_NO_HEAP
+struct enxlog_sink_mmap_ring_context *enxlog_sink_mmap_ring_create();
+void enxlog_sink_mmap_ring_destroy(void *context);
+#endif
+
+bool enxlog_sink_mmap_ring_init(void *context);
+void enxlog_sink_mmap_ring_shutdown(void *context);
+
+void enxlog_sink_mmap_ring_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_mmap_ring_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_mmap_ring_log_entry_close(
+    void *context);
+
+
+__END_DECLS
+
+#endif
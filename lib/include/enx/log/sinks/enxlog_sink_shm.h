@@ -0,0 +1,140 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_SINK_SHM_H
+#define ENXLOG_SINK_SHM_H
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+#include <enx/log/sinks/enxlog_sink_mmap_ring.h>
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * Shared memory ring magic ("ENXLSHMR")
+ */
+#define ENXLOG_SHM_RING_MAGIC 0x524d48534c584e45ull
+
+/**
+ * Shared memory ring format version
+ */
+#define ENXLOG_SHM_RING_VERSION 1
+
+/**
+ * Shared memory ring header
+ *
+ * The data area follows the header and holds records in the memory mapped
+ * ring layout: a struct enxlog_mmap_ring_record, the text, and padding to
+ * ENXLOG_MMAP_RING_ALIGNMENT.
+ *
+ * The producer owns head and the collector owns tail. A producer never
+ * waits for the collector: records that do not fit are dropped and
+ * counted. After moving head the producer increments sequence, and wakes
+ * the collector with a futex on sequence if waiters is set.
+ */
+struct enxlog_shm_ring_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t dropped;
+    uint32_t pid;
+    uint32_t sequence;
+    uint32_t waiters;
+    uint32_t reserved;
+};
+
+
+/**
+ * Shared memory sink
+ *
+ * Writes records into a POSIX shared memory ring that is drained by the
+ * enxlog_collect tool. Writing a record is a memory copy, so the
+ * application never blocks on disk or on a pipe, and records that were
+ * committed before a crash remain in shared memory for the collector.
+ *
+ * The name may contain %p, which is replaced by the process id, so that
+ * several processes can share a configuration. The shared memory object is
+ * removed by the collector once the producer has exited and the ring has
+ * been drained.
+ */
+struct enxlog_sink_shm_context
+{
+    const char *name;
+    size_t size;
+    const struct enxlog_pattern *pattern;
+
+    int fd;
+    struct enxlog_shm_ring_header *header;
+    char *data;
+    char *record;
+    size_t record_length;
+    size_t tag_length;
+};
+
+/**
+ * The maximum length of a single record. Longer records are truncated.
+ */
+#ifndef ENXLOG_SHM_MAX_RECORD
+#define ENXLOG_SHM_MAX_RECORD 4096
+#endif
+
+/**
+ * The maximum length of a shared memory name, after %p is expanded
+ */
+#ifndef ENXLOG_SHM_MAX_NAME
+#define ENXLOG_SHM_MAX_NAME 255
+#endif
+
+#ifndef ENXLOG_NO_HEAP
+struct enxlog_sink_shm_context *enxlog_sink_shm_create();
+void enxlog_sink_shm_destroy(void *context);
+#endif
+
+bool enxlog_sink_shm_init(void *context);
+void enxlog_sink_shm_shutdown(void *context);
+
+void enxlog_sink_shm_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_shm_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_shm_log_entry_close(
+    void *context);
+
+
+__END_DECLS
+
+#endif
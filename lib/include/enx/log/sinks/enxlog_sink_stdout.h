@@ -24,6 +24,7 @@
 #define ENXLOG_SINK_STDOUT_H
 
 #include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
 
 #include <sys/cdefs.h>
 
@@ -32,10 +33,13 @@ __BEGIN_DECLS
 struct enxlog_sink_stdout_context
 {
     size_t tag_length;
+    const struct enxlog_pattern *pattern;
 };
 
+#ifndef ENXLOG_NO_HEAP
 struct enxlog_sink_stdout_context *enxlog_sink_stdout_create();
 void enxlog_sink_stdout_destroy(void *context);
+#endif
 
 bool enxlog_sink_stdout_init(void *context);
 void enxlog_sink_stdout_shutdown(void *context);
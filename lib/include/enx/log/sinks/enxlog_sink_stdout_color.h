@@ -24,6 +24,7 @@
 #define ENXLOG_SINK_STDOUT_COLOR_H
 
 #include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
 
 #include <sys/cdefs.h>
 
@@ -33,10 +34,13 @@ __BEGIN_DECLS
 struct enxlog_sink_stdout_color_context
 {
     size_t tag_length;
+    const struct enxlog_pattern *pattern;
 };
 
+#ifndef ENXLOG_NO_HEAP
 struct enxlog_sink_stdout_color_context *enxlog_sink_stdout_color_create();
 void enxlog_sink_stdout_color_destroy(void *context);
+#endif
 
 bool enxlog_sink_stdout_color_init(void *context);
 void enxlog_sink_stdout_color_shutdown(void *context);
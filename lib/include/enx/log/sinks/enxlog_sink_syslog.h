@@ -0,0 +1,167 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#ifndef ENXLOG_SINK_SYSLOG_H
+#define ENXLOG_SINK_SYSLOG_H
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * The default header pattern of the syslog sink. The time and level are
+ * carried by the syslog header.
+ */
+#define ENXLOG_PATTERN_DEFAULT_SYSLOG "%N%F:%l: "
+
+/**
+ * Default socket path
+ */
+#ifndef ENXLOG_SYSLOG_PATH
+#define ENXLOG_SYSLOG_PATH "/dev/log"
+#endif
+
+/**
+ * Default number of records sent per sendmmsg call
+ */
+#ifndef ENXLOG_SYSLOG_BATCH_SIZE
+#define ENXLOG_SYSLOG_BATCH_SIZE 16
+#endif
+
+/**
+ * Default number of records that can wait to be sent
+ */
+#ifndef ENXLOG_SYSLOG_QUEUE_LENGTH
+#define ENXLOG_SYSLOG_QUEUE_LENGTH 256
+#endif
+
+/**
+ * Default interval after which a partial batch is sent
+ */
+#ifndef ENXLOG_SYSLOG_FLUSH_INTERVAL_MS
+#define ENXLOG_SYSLOG_FLUSH_INTERVAL_MS 100
+#endif
+
+/**
+ * The maximum length of a record, including the syslog header. Longer
+ * records are truncated.
+ */
+#ifndef ENXLOG_SYSLOG_MAX_RECORD
+#define ENXLOG_SYSLOG_MAX_RECORD 2048
+#endif
+
+/**
+ * Syslog facilities. The values are the RFC 5424 facility codes; syslog.h
+ * is not used as its LOG_* severities clash with the logging macros.
+ */
+enum enxlog_syslog_facility
+{
+    ENXLOG_SYSLOG_FACILITY_USER = 1,
+    ENXLOG_SYSLOG_FACILITY_DAEMON = 3,
+    ENXLOG_SYSLOG_FACILITY_AUTH = 4,
+    ENXLOG_SYSLOG_FACILITY_LOCAL0 = 16,
+    ENXLOG_SYSLOG_FACILITY_LOCAL1,
+    ENXLOG_SYSLOG_FACILITY_LOCAL2,
+    ENXLOG_SYSLOG_FACILITY_LOCAL3,
+    ENXLOG_SYSLOG_FACILITY_LOCAL4,
+    ENXLOG_SYSLOG_FACILITY_LOCAL5,
+    ENXLOG_SYSLOG_FACILITY_LOCAL6,
+    ENXLOG_SYSLOG_FACILITY_LOCAL7
+};
+
+
+struct enxlog_syslog_state;
+
+/**
+ * Syslog sink
+ *
+ * Sends RFC 5424 records to a Unix datagram socket, or over UDP to
+ * 127.0.0.1 when port is set. Records are queued and sent with sendmmsg
+ * once batch_size of them are waiting, or by a background thread once
+ * flush_interval_ms has passed.
+ *
+ * The socket is nonblocking. Records that the receiver cannot take yet stay
+ * queued and are retried. When the queue is full, new records are dropped
+ * and counted.
+ *
+ * Fields that are left at zero use the ENXLOG_SYSLOG_* defaults. A facility
+ * of zero selects ENXLOG_SYSLOG_FACILITY_USER, and app_name defaults to the
+ * program name.
+ */
+struct enxlog_sink_syslog_context
+{
+    const char *path;
+    unsigned int port;
+    const char *app_name;
+    enum enxlog_syslog_facility facility;
+    unsigned int batch_size;
+    unsigned int queue_length;
+    unsigned int flush_interval_ms;
+    const struct enxlog_pattern *pattern;
+
+    struct enxlog_syslog_state *state;
+};
+
+
+#ifndef ENXLOG_NO_HEAP
+struct enxlog_sink_syslog_context *enxlog_sink_syslog_create();
+void enxlog_sink_syslog_destroy(void *context);
+#endif
+
+bool enxlog_sink_syslog_init(void *context);
+void enxlog_sink_syslog_shutdown(void *context);
+
+void enxlog_sink_syslog_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_syslog_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_syslog_log_entry_close(
+    void *context);
+
+void enxlog_sink_syslog_log_batch(
+    void *context,
+    const struct enxlog_record *records,
+    size_t count);
+
+/**
+ * Returns the number of records that were dropped because the queue was
+ * full or the receiver rejected them
+ */
+uint64_t enxlog_sink_syslog_dropped(void *context);
+
+
+__END_DECLS
+
+#endif
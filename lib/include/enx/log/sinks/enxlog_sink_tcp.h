@@ -0,0 +1,169 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#ifndef ENXLOG_SINK_TCP_H
+#define ENXLOG_SINK_TCP_H
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * Default size of the memory buffer
+ */
+#ifndef ENXLOG_TCP_BUFFER_SIZE
+#define ENXLOG_TCP_BUFFER_SIZE (1024 * 1024)
+#endif
+
+/**
+ * Default maximum size of the spill file
+ */
+#ifndef ENXLOG_TCP_SPILL_SIZE
+#define ENXLOG_TCP_SPILL_SIZE (64 * 1024 * 1024)
+#endif
+
+/**
+ * Default interval after which buffered records are sent
+ */
+#ifndef ENXLOG_TCP_FLUSH_INTERVAL_MS
+#define ENXLOG_TCP_FLUSH_INTERVAL_MS 50
+#endif
+
+/**
+ * The first and the longest delay between connection attempts
+ */
+#ifndef ENXLOG_TCP_RECONNECT_MIN_MS
+#define ENXLOG_TCP_RECONNECT_MIN_MS 100
+#endif
+
+#ifndef ENXLOG_TCP_RECONNECT_MAX_MS
+#define ENXLOG_TCP_RECONNECT_MAX_MS 5000
+#endif
+
+/**
+ * The time after which a connection attempt, or a send to a peer that has
+ * stopped reading, is abandoned and the connection is reset
+ */
+#ifndef ENXLOG_TCP_TIMEOUT_MS
+#define ENXLOG_TCP_TIMEOUT_MS 5000
+#endif
+
+/**
+ * The maximum length of a record. Longer records are truncated.
+ */
+#ifndef ENXLOG_TCP_MAX_RECORD
+#define ENXLOG_TCP_MAX_RECORD 8192
+#endif
+
+/**
+ * How records are delimited on the stream
+ */
+enum enxlog_sink_tcp_framing
+{
+    /** Each record ends with a newline */
+    ENXLOG_SINK_TCP_FRAMING_NEWLINE = 0,
+
+    /** Each record is preceded by its length as a 32 bit big endian integer */
+    ENXLOG_SINK_TCP_FRAMING_LENGTH
+};
+
+
+struct enxlog_tcp_state;
+
+/**
+ * TCP sink
+ *
+ * Streams records to a collector at host:port. The log call only copies
+ * the record into a memory buffer. A background thread connects, sends
+ * buffered records in large batches, and reconnects with a doubling
+ * backoff when the connection fails.
+ *
+ * While the collector is unreachable the memory buffer fills up. Records
+ * that do not fit are then appended to the spill file if spill_path is
+ * set, and dropped and counted otherwise. The spill file is sent once the
+ * memory buffer has been drained. It is also kept across restarts: records
+ * that are still buffered at shutdown are written to it, and are sent by
+ * the next process that uses it.
+ *
+ * A record that was cut short by a lost connection is sent again, in full,
+ * on the next connection.
+ *
+ * Fields that are left at zero use the ENXLOG_TCP_* defaults.
+ */
+struct enxlog_sink_tcp_context
+{
+    const char *host;
+    unsigned int port;
+    enum enxlog_sink_tcp_framing framing;
+    size_t buffer_size;
+    const char *spill_path;
+    size_t spill_size;
+    unsigned int flush_interval_ms;
+    const struct enxlog_pattern *pattern;
+
+    struct enxlog_tcp_state *state;
+};
+
+
+#ifndef ENXLOG_NO_HEAP
+struct enxlog_sink_tcp_context *enxlog_sink_tcp_create();
+void enxlog_sink_tcp_destroy(void *context);
+#endif
+
+bool enxlog_sink_tcp_init(void *context);
+void enxlog_sink_tcp_shutdown(void *context);
+
+void enxlog_sink_tcp_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_tcp_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_tcp_log_entry_close(
+    void *context);
+
+/**
+ * Returns the number of records that were dropped because neither the
+ * memory buffer nor the spill file had room for them
+ */
+uint64_t enxlog_sink_tcp_dropped(void *context);
+
+/**
+ * Returns true while the sink is connected to the collector
+ */
+bool enxlog_sink_tcp_connected(void *context);
+
+
+__END_DECLS
+
+#endif
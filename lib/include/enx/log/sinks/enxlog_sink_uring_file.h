@@ -0,0 +1,114 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#ifndef ENXLOG_SINK_URING_FILE_H
+#define ENXLOG_SINK_URING_FILE_H
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * Default size of each write buffer
+ */
+#ifndef ENXLOG_URING_FILE_BUFFER_SIZE
+#define ENXLOG_URING_FILE_BUFFER_SIZE (1024 * 1024)
+#endif
+
+/**
+ * Default number of write buffers
+ */
+#ifndef ENXLOG_URING_FILE_BUFFER_COUNT
+#define ENXLOG_URING_FILE_BUFFER_COUNT 4
+#endif
+
+/**
+ * Default interval after which a partially filled buffer is written
+ */
+#ifndef ENXLOG_URING_FILE_FLUSH_INTERVAL_MS
+#define ENXLOG_URING_FILE_FLUSH_INTERVAL_MS 100
+#endif
+
+
+struct enxlog_uring_file_state;
+
+/**
+ * io_uring file sink
+ *
+ * Formats records into one of several large buffers. A buffer is submitted
+ * to io_uring when it is full, or by a background thread once it has been
+ * waiting for flush_interval_ms, and the next buffer is filled in the
+ * meantime. The writer only waits when every buffer is still in flight.
+ * When io_uring is not available the buffers are written with pwrite.
+ *
+ * Fields that are left at zero use the ENXLOG_URING_FILE_* defaults.
+ */
+struct enxlog_sink_uring_file_context
+{
+    const char *path;
+    size_t buffer_size;
+    unsigned int buffer_count;
+    unsigned int flush_interval_ms;
+    const struct enxlog_pattern *pattern;
+
+    struct enxlog_uring_file_state *state;
+};
+
+
+#ifndef ENXLOG_NO_HEAP
+struct enxlog_sink_uring_file_context *enxlog_sink_uring_file_create();
+void enxlog_sink_uring_file_destroy(void *context);
+#endif
+
+bool enxlog_sink_uring_file_init(void *context);
+void enxlog_sink_uring_file_shutdown(void *context);
+
+void enxlog_sink_uring_file_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+void enxlog_sink_uring_file_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+void enxlog_sink_uring_file_log_entry_close(
+    void *context);
+
+/**
+ * Returns true when the sink is writing through io_uring, and false when it
+ * has fallen back to pwrite
+ */
+bool enxlog_sink_uring_file_using_uring(void *context);
+
+
+__END_DECLS
+
+#endif
@@ -139,13 +139,11 @@ static struct enxlog_filter_config_entry *enxlog_filter_config_entry_append_chil
     // Has children
     } else {
         struct enxlog_filter_config_entry *search = parent->child;
-        bool found = false;
-        do {
+        bool found = (strcmp(search->name_part, name_part) == 0);
+        while (!found && search->next) {
+            search = search->next;
             found = (strcmp(search->name_part, name_part) == 0);
-            if (!found && search->next) {
-                search = search->next;
-            }
-        } while (!found && search->next);
+        }
 
         if (found) {
             result = search;
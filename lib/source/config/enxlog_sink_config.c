@@ -95,7 +95,8 @@ struct enxlog_sink *enxlog_sink_config_transform(
         source = source->next;
     }
 
-    result = (struct enxlog_sink *)malloc(sizeof(struct enxlog_sink) * (count + 1));
+    // Zeroed, so that callbacks a factory does not set are NULL
+    result = (struct enxlog_sink *)calloc(count + 1, sizeof(struct enxlog_sink));
     source = obj->sinks;
 
     for (i=0; i < count; ++i) {
@@ -109,7 +110,9 @@ struct enxlog_sink *enxlog_sink_config_transform(
 
     if (initialized != count) {
         for (i=0; i < initialized; ++i) {
-            if (result[i].fn_shutdown) {
+            if (result[i].fn_destroy) {
+                result[i].fn_destroy(result[i].context);
+            } else if (result[i].fn_shutdown) {
                 result[i].fn_shutdown(result[i].context);
             }
         }
@@ -126,6 +129,7 @@ struct enxlog_sink *enxlog_sink_config_transform(
         result[count].fn_log_entry_open = NULL;
         result[count].fn_log_entry_write = NULL;
         result[count].fn_log_entry_close = NULL;
+        result[count].fn_log_entry_field = NULL;
     }
 
     return result;
@@ -136,7 +140,10 @@ void enxlog_sink_config_transform_destroy(
 {
     struct enxlog_sink *ptr = obj;
     while (ptr->valid) {
-        if (ptr->fn_shutdown) {
+        // Destroying a sink also shuts it down
+        if (ptr->fn_destroy) {
+            ptr->fn_destroy(ptr->context);
+        } else if (ptr->fn_shutdown) {
             ptr->fn_shutdown(ptr->context);
         }
         ptr++;
@@ -21,19 +21,93 @@
  */
 
 #include <enx/log/config/enxlog_sink_factory.h>
+#include <enx/log/enxlog_pattern.h>
 #include <enx/log/sinks/enxlog_sink_stdout.h>
 #include <enx/log/sinks/enxlog_sink_stdout_color.h>
 #include <enx/log/sinks/enxlog_sink_file.h>
+#include <enx/log/sinks/enxlog_sink_json.h>
+#ifdef ENXLOG_FLIGHT_RECORDER
+#include <enx/log/sinks/enxlog_sink_flight_recorder.h>
+#endif
+#ifdef ENXLOG_MMAP_RING
+#include <enx/log/sinks/enxlog_sink_mmap_ring.h>
+#endif
+#ifdef ENXLOG_URING_FILE
+#include <enx/log/sinks/enxlog_sink_uring_file.h>
+#endif
+#ifdef ENXLOG_SHM
+#include <enx/log/sinks/enxlog_sink_shm.h>
+#endif
+#ifdef ENXLOG_SYSLOG
+#include <enx/log/sinks/enxlog_sink_syslog.h>
+#endif
+#ifdef ENXLOG_JOURNALD
+#include <enx/log/sinks/enxlog_sink_journald.h>
+#endif
+#ifdef ENXLOG_TCP
+#include <enx/log/sinks/enxlog_sink_tcp.h>
+#endif
 
+#include <stdlib.h>
 #include <string.h>
 
 
+static bool enxlog_sink_factory_create_pattern(
+    const struct enxlog_sink_parameters *parameters,
+    const char *default_pattern,
+    struct enxlog_pattern **pattern,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    *pattern = NULL;
+
+    const char *value = enxlog_sink_parameters_find(parameters, "pattern");
+    const char *newlines = enxlog_sink_parameters_find(parameters, "newlines");
+
+    enum enxlog_pattern_newline newline = ENXLOG_PATTERN_NEWLINE_INDENT;
+    if (newlines) {
+        if (strcmp(newlines, "indent") == 0) {
+            newline = ENXLOG_PATTERN_NEWLINE_INDENT;
+        } else if (strcmp(newlines, "escape") == 0) {
+            newline = ENXLOG_PATTERN_NEWLINE_ESCAPE;
+        } else if (strcmp(newlines, "raw") == 0) {
+            newline = ENXLOG_PATTERN_NEWLINE_RAW;
+        } else {
+            error_callback(0, 0, "Sink 'newlines' must be indent, escape or raw");
+            return false;
+        }
+    }
+
+    if (value || newlines) {
+        *pattern = enxlog_pattern_create(value ? value : default_pattern);
+        if (*pattern == NULL) {
+            error_callback(0, 0, "Sink 'pattern' is not valid");
+            return false;
+        }
+
+        (*pattern)->newline = newline;
+    }
+
+    return true;
+}
+
 static bool enxlog_sink_factory_create_stdout_sink(
     struct enxlog_sink *sink,
     const struct enxlog_sink_parameters *parameters,
     enxlog_config_parser_error_callback_t error_callback)
 {
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT, &pattern, error_callback)) {
+        return false;
+    }
+
     struct enxlog_sink_stdout_context *context = enxlog_sink_stdout_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
 
     sink->fn_init = enxlog_sink_stdout_init;
     sink->fn_shutdown = enxlog_sink_stdout_shutdown;
@@ -41,6 +115,7 @@ static bool enxlog_sink_factory_create_stdout_sink(
     sink->fn_log_entry_write = enxlog_sink_stdout_log_entry_write;
     sink->fn_log_entry_close = enxlog_sink_stdout_log_entry_close;
     sink->context = context;
+    sink->fn_destroy = enxlog_sink_stdout_destroy;
     sink->valid = true;
 
     return true;
@@ -51,7 +126,19 @@ static bool enxlog_sink_factory_create_stdout_color_sink(
     const struct enxlog_sink_parameters *parameters,
     enxlog_config_parser_error_callback_t error_callback)
 {
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT_COLOR, &pattern, error_callback)) {
+        return false;
+    }
+
     struct enxlog_sink_stdout_color_context *context = enxlog_sink_stdout_color_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
 
     sink->fn_init = enxlog_sink_stdout_color_init;
     sink->fn_shutdown = enxlog_sink_stdout_color_shutdown;
@@ -59,6 +146,7 @@ static bool enxlog_sink_factory_create_stdout_color_sink(
     sink->fn_log_entry_write = enxlog_sink_stdout_color_log_entry_write;
     sink->fn_log_entry_close = enxlog_sink_stdout_color_log_entry_close;
     sink->context = context;
+    sink->fn_destroy = enxlog_sink_stdout_color_destroy;
     sink->valid = true;
 
     return true;
@@ -75,11 +163,48 @@ static bool enxlog_sink_factory_create_file_sink(
         return false;
     }
 
+    enum enxlog_sink_file_compression compression = ENXLOG_SINK_FILE_COMPRESSION_NONE;
+
+    const char *value = enxlog_sink_parameters_find(parameters, "compress");
+    if (value) {
+        if (strcmp(value, "lz4") == 0) {
+            compression = ENXLOG_SINK_FILE_COMPRESSION_LZ4;
+
+        } else if (strcmp(value, "zstd") == 0) {
+            compression = ENXLOG_SINK_FILE_COMPRESSION_ZSTD;
+
+        } else if (strcmp(value, "none") != 0) {
+            error_callback(0, 0, "File sink 'compress' should be one of none, lz4 or zstd");
+            return false;
+        }
+
+#ifndef ENXLOG_COMPRESSION
+        if (compression != ENXLOG_SINK_FILE_COMPRESSION_NONE) {
+            error_callback(0, 0, "File sink compression requires LIBENXLOG_COMPRESSION");
+            return false;
+        }
+#endif
+    }
+
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT, &pattern, error_callback)) {
+        return false;
+    }
+
     struct enxlog_sink_file_context *context = enxlog_sink_file_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
     context->path = path;
     context->file = NULL;
+    context->compression = compression;
     if (!enxlog_sink_file_init(context)) {
         error_callback(0, 0, "Could not open log file");
+        enxlog_pattern_destroy(pattern);
         free(context);
         return false;
     }
@@ -88,11 +213,503 @@ static bool enxlog_sink_factory_create_file_sink(
     sink->fn_log_entry_open = enxlog_sink_file_log_entry_open;
     sink->fn_log_entry_write = enxlog_sink_file_log_entry_write;
     sink->fn_log_entry_close = enxlog_sink_file_log_entry_close;
+    sink->fn_log_batch = enxlog_sink_file_log_batch;
     sink->fn_shutdown = enxlog_sink_file_shutdown;
+    sink->fn_destroy = enxlog_sink_file_destroy;
+    sink->valid = true;
+
+    return true;
+}
+
+static bool enxlog_sink_factory_create_json_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    struct enxlog_sink_json_context *context = enxlog_sink_json_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        return false;
+    }
+
+    context->path = enxlog_sink_parameters_find(parameters, "path");
+    if (!enxlog_sink_json_init(context)) {
+        error_callback(0, 0, "Could not open log file");
+        free(context);
+        return false;
+    }
+
+    sink->context = context;
+    sink->fn_log_entry_open = enxlog_sink_json_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_json_log_entry_write;
+    sink->fn_log_entry_field = enxlog_sink_json_log_entry_field;
+    sink->fn_log_entry_close = enxlog_sink_json_log_entry_close;
+    sink->fn_shutdown = enxlog_sink_json_shutdown;
+    sink->fn_destroy = enxlog_sink_json_destroy;
+    sink->valid = true;
+
+    return true;
+}
+
+#ifdef ENXLOG_FLIGHT_RECORDER
+static bool enxlog_sink_factory_create_flight_recorder_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    size_t size = 1024 * 1024;
+
+    const char *value = enxlog_sink_parameters_find(parameters, "size");
+    if (value) {
+        char *end;
+        size = strtoul(value, &end, 10);
+        if ((*end != '\0') || (size == 0)) {
+            error_callback(0, 0, "Flight recorder sink 'size' should be a positive number of bytes");
+            return false;
+        }
+    }
+
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT, &pattern, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_sink_flight_recorder_context *context = enxlog_sink_flight_recorder_create(size);
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate flight recorder buffer");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
+    context->crash_dump = enxlog_sink_parameters_find(parameters, "crash_dump");
+
+    sink->fn_init = enxlog_sink_flight_recorder_init;
+    sink->fn_shutdown = enxlog_sink_flight_recorder_shutdown;
+    sink->fn_log_entry_open = enxlog_sink_flight_recorder_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_flight_recorder_log_entry_write;
+    sink->fn_log_entry_close = enxlog_sink_flight_recorder_log_entry_close;
+    sink->context = context;
+    sink->fn_destroy = enxlog_sink_flight_recorder_destroy;
+    sink->valid = true;
+
+    return true;
+}
+#endif
+
+#ifdef ENXLOG_MMAP_RING
+static bool enxlog_sink_factory_create_mmap_ring_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    size_t size = 16 * 1024 * 1024;
+
+    const char *path = enxlog_sink_parameters_find(parameters, "path");
+    if (path == NULL) {
+        error_callback(0, 0, "Memory mapped ring sink should specify 'path'");
+        return false;
+    }
+
+    const char *value = enxlog_sink_parameters_find(parameters, "size");
+    if (value) {
+        char *end;
+        size = strtoul(value, &end, 10);
+        if ((*end != '\0') || (size == 0)) {
+            error_callback(0, 0, "Memory mapped ring sink 'size' should be a positive number of bytes");
+            return false;
+        }
+    }
+
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT, &pattern, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_sink_mmap_ring_context *context = enxlog_sink_mmap_ring_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
+    context->path = path;
+    context->size = size;
+    if (!enxlog_sink_mmap_ring_init(context)) {
+        error_callback(0, 0, "Could not map ring file");
+        enxlog_pattern_destroy(pattern);
+        free(context);
+        return false;
+    }
+
+    sink->context = context;
+    sink->fn_shutdown = enxlog_sink_mmap_ring_shutdown;
+    sink->fn_log_entry_open = enxlog_sink_mmap_ring_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_mmap_ring_log_entry_write;
+    sink->fn_log_entry_close = enxlog_sink_mmap_ring_log_entry_close;
+    sink->fn_destroy = enxlog_sink_mmap_ring_destroy;
     sink->valid = true;
 
     return true;
 }
+#endif
+
+#if defined(ENXLOG_URING_FILE) || defined(ENXLOG_SYSLOG) || defined(ENXLOG_JOURNALD) || defined(ENXLOG_TCP)
+static bool enxlog_sink_factory_parse_count(
+    const struct enxlog_sink_parameters *parameters,
+    const char *key,
+    size_t *result,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    const char *value = enxlog_sink_parameters_find(parameters, key);
+    if (value) {
+        char *end;
+        *result = strtoul(value, &end, 10);
+        if ((*end != '\0') || (*result == 0)) {
+            error_callback(0, 0, "Sink parameter should be a positive number");
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+#ifdef ENXLOG_SHM
+static bool enxlog_sink_factory_create_shm_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    size_t size = 4 * 1024 * 1024;
+
+    const char *name = enxlog_sink_parameters_find(parameters, "name");
+    if (name == NULL) {
+        error_callback(0, 0, "Shared memory sink should specify 'name'");
+        return false;
+    }
+
+    const char *value = enxlog_sink_parameters_find(parameters, "size");
+    if (value) {
+        char *end;
+        size = strtoul(value, &end, 10);
+        if ((*end != '\0') || (size == 0)) {
+            error_callback(0, 0, "Shared memory sink 'size' should be a positive number of bytes");
+            return false;
+        }
+    }
+
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT, &pattern, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_sink_shm_context *context = enxlog_sink_shm_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
+    context->name = name;
+    context->size = size;
+    if (!enxlog_sink_shm_init(context)) {
+        error_callback(0, 0, "Could not map shared memory ring");
+        enxlog_pattern_destroy(pattern);
+        free(context);
+        return false;
+    }
+
+    sink->context = context;
+    sink->fn_shutdown = enxlog_sink_shm_shutdown;
+    sink->fn_log_entry_open = enxlog_sink_shm_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_shm_log_entry_write;
+    sink->fn_log_entry_close = enxlog_sink_shm_log_entry_close;
+    sink->fn_destroy = enxlog_sink_shm_destroy;
+    sink->valid = true;
+
+    return true;
+}
+#endif
+
+#ifdef ENXLOG_URING_FILE
+static bool enxlog_sink_factory_create_uring_file_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    size_t buffer_size = 0;
+    size_t buffer_count = 0;
+    size_t flush_interval_ms = 0;
+
+    const char* path = enxlog_sink_parameters_find(parameters, "path");
+    if (path == NULL) {
+        error_callback(0, 0, "io_uring file sink should specify 'path'");
+        return false;
+    }
+
+    if (!enxlog_sink_factory_parse_count(parameters, "buffer_size", &buffer_size, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "buffers", &buffer_count, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "flush_interval_ms", &flush_interval_ms, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT, &pattern, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_sink_uring_file_context *context = enxlog_sink_uring_file_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
+    context->path = path;
+    context->buffer_size = buffer_size;
+    context->buffer_count = buffer_count;
+    context->flush_interval_ms = flush_interval_ms;
+    if (!enxlog_sink_uring_file_init(context)) {
+        error_callback(0, 0, "Could not open log file");
+        enxlog_pattern_destroy(pattern);
+        free(context);
+        return false;
+    }
+
+    sink->context = context;
+    sink->fn_log_entry_open = enxlog_sink_uring_file_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_uring_file_log_entry_write;
+    sink->fn_log_entry_close = enxlog_sink_uring_file_log_entry_close;
+    sink->fn_shutdown = enxlog_sink_uring_file_shutdown;
+    sink->fn_destroy = enxlog_sink_uring_file_destroy;
+    sink->valid = true;
+
+    return true;
+}
+#endif
+
+#ifdef ENXLOG_SYSLOG
+static bool enxlog_sink_factory_parse_facility(
+    const char *value,
+    enum enxlog_syslog_facility *facility)
+{
+    static const char *names[] = {
+        "user", "daemon", "auth", "local0", "local1", "local2", "local3",
+        "local4", "local5", "local6", "local7"
+    };
+
+    static const enum enxlog_syslog_facility values[] = {
+        ENXLOG_SYSLOG_FACILITY_USER,
+        ENXLOG_SYSLOG_FACILITY_DAEMON,
+        ENXLOG_SYSLOG_FACILITY_AUTH,
+        ENXLOG_SYSLOG_FACILITY_LOCAL0,
+        ENXLOG_SYSLOG_FACILITY_LOCAL1,
+        ENXLOG_SYSLOG_FACILITY_LOCAL2,
+        ENXLOG_SYSLOG_FACILITY_LOCAL3,
+        ENXLOG_SYSLOG_FACILITY_LOCAL4,
+        ENXLOG_SYSLOG_FACILITY_LOCAL5,
+        ENXLOG_SYSLOG_FACILITY_LOCAL6,
+        ENXLOG_SYSLOG_FACILITY_LOCAL7
+    };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (strcmp(value, names[i]) == 0) {
+            *facility = values[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool enxlog_sink_factory_create_syslog_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    size_t port = 0;
+    size_t batch_size = 0;
+    size_t queue_length = 0;
+    size_t flush_interval_ms = 0;
+    enum enxlog_syslog_facility facility = ENXLOG_SYSLOG_FACILITY_USER;
+
+    if (!enxlog_sink_factory_parse_count(parameters, "port", &port, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "batch_size", &batch_size, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "queue_length", &queue_length, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "flush_interval_ms", &flush_interval_ms, error_callback)) {
+        return false;
+    }
+
+    const char *value = enxlog_sink_parameters_find(parameters, "facility");
+    if (value && !enxlog_sink_factory_parse_facility(value, &facility)) {
+        error_callback(0, 0, "Syslog sink 'facility' should be one of user, daemon, auth or local0 to local7");
+        return false;
+    }
+
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT_SYSLOG, &pattern, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_sink_syslog_context *context = enxlog_sink_syslog_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
+    context->path = enxlog_sink_parameters_find(parameters, "path");
+    context->port = port;
+    context->app_name = enxlog_sink_parameters_find(parameters, "app_name");
+    context->facility = facility;
+    context->batch_size = batch_size;
+    context->queue_length = queue_length;
+    context->flush_interval_ms = flush_interval_ms;
+    if (!enxlog_sink_syslog_init(context)) {
+        error_callback(0, 0, "Could not create syslog socket");
+        enxlog_pattern_destroy(pattern);
+        free(context);
+        return false;
+    }
+
+    sink->context = context;
+    sink->fn_log_entry_open = enxlog_sink_syslog_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_syslog_log_entry_write;
+    sink->fn_log_entry_close = enxlog_sink_syslog_log_entry_close;
+    sink->fn_log_batch = enxlog_sink_syslog_log_batch;
+    sink->fn_shutdown = enxlog_sink_syslog_shutdown;
+    sink->fn_destroy = enxlog_sink_syslog_destroy;
+    sink->valid = true;
+
+    return true;
+}
+#endif
+
+#ifdef ENXLOG_JOURNALD
+static bool enxlog_sink_factory_create_journald_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    size_t max_datagram = 0;
+
+    if (!enxlog_sink_factory_parse_count(parameters, "max_datagram", &max_datagram, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_sink_journald_context *context = enxlog_sink_journald_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        return false;
+    }
+
+    context->path = enxlog_sink_parameters_find(parameters, "path");
+    context->identifier = enxlog_sink_parameters_find(parameters, "identifier");
+    context->max_datagram = max_datagram;
+    if (!enxlog_sink_journald_init(context)) {
+        error_callback(0, 0, "Could not create journal socket");
+        free(context);
+        return false;
+    }
+
+    sink->context = context;
+    sink->fn_log_entry_open = enxlog_sink_journald_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_journald_log_entry_write;
+    sink->fn_log_entry_field = enxlog_sink_journald_log_entry_field;
+    sink->fn_log_entry_close = enxlog_sink_journald_log_entry_close;
+    sink->fn_shutdown = enxlog_sink_journald_shutdown;
+    sink->fn_destroy = enxlog_sink_journald_destroy;
+    sink->valid = true;
+
+    return true;
+}
+#endif
+
+#ifdef ENXLOG_TCP
+static bool enxlog_sink_factory_create_tcp_sink(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    size_t port = 0;
+    size_t buffer_size = 0;
+    size_t spill_size = 0;
+    size_t flush_interval_ms = 0;
+    enum enxlog_sink_tcp_framing framing = ENXLOG_SINK_TCP_FRAMING_NEWLINE;
+
+    const char *host = enxlog_sink_parameters_find(parameters, "host");
+    if (host == NULL) {
+        error_callback(0, 0, "TCP sink should specify 'host'");
+        return false;
+    }
+
+    if (!enxlog_sink_factory_parse_count(parameters, "port", &port, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "buffer_size", &buffer_size, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "spill_size", &spill_size, error_callback) ||
+        !enxlog_sink_factory_parse_count(parameters, "flush_interval_ms", &flush_interval_ms, error_callback)) {
+        return false;
+    }
+
+    if ((port == 0) || (port > 65535)) {
+        error_callback(0, 0, "TCP sink should specify a 'port' between 1 and 65535");
+        return false;
+    }
+
+    const char *value = enxlog_sink_parameters_find(parameters, "framing");
+    if (value) {
+        if (strcmp(value, "newline") == 0) {
+            framing = ENXLOG_SINK_TCP_FRAMING_NEWLINE;
+        } else if (strcmp(value, "length") == 0) {
+            framing = ENXLOG_SINK_TCP_FRAMING_LENGTH;
+        } else {
+            error_callback(0, 0, "TCP sink 'framing' should be newline or length");
+            return false;
+        }
+    }
+
+    struct enxlog_pattern *pattern;
+    if (!enxlog_sink_factory_create_pattern(parameters, ENXLOG_PATTERN_DEFAULT, &pattern, error_callback)) {
+        return false;
+    }
+
+    struct enxlog_sink_tcp_context *context = enxlog_sink_tcp_create();
+    if (context == NULL) {
+        error_callback(0, 0, "Could not allocate sink");
+        enxlog_pattern_destroy(pattern);
+        return false;
+    }
+
+    context->pattern = pattern;
+    context->host = host;
+    context->port = port;
+    context->framing = framing;
+    context->buffer_size = buffer_size;
+    context->spill_path = enxlog_sink_parameters_find(parameters, "spill_path");
+    context->spill_size = spill_size;
+    context->flush_interval_ms = flush_interval_ms;
+    if (!enxlog_sink_tcp_init(context)) {
+        error_callback(0, 0, "Could not start TCP sink");
+        enxlog_pattern_destroy(pattern);
+        free(context);
+        return false;
+    }
+
+    sink->context = context;
+    sink->fn_log_entry_open = enxlog_sink_tcp_log_entry_open;
+    sink->fn_log_entry_write = enxlog_sink_tcp_log_entry_write;
+    sink->fn_log_entry_close = enxlog_sink_tcp_log_entry_close;
+    sink->fn_shutdown = enxlog_sink_tcp_shutdown;
+    sink->fn_destroy = enxlog_sink_tcp_destroy;
+    sink->valid = true;
+
+    return true;
+}
+#endif
 
 
 bool enxlog_sink_factory_create_sink(
@@ -116,6 +733,44 @@ bool enxlog_sink_factory_create_sink(
     } else if (strcmp(value, "file") == 0) {
         return enxlog_sink_factory_create_file_sink(sink, parameters, error_callback);
 
+    } else if (strcmp(value, "json") == 0) {
+        return enxlog_sink_factory_create_json_sink(sink, parameters, error_callback);
+
+#ifdef ENXLOG_FLIGHT_RECORDER
+    } else if (strcmp(value, "flight_recorder") == 0) {
+        return enxlog_sink_factory_create_flight_recorder_sink(sink, parameters, error_callback);
+#endif
+
+#ifdef ENXLOG_MMAP_RING
+    } else if (strcmp(value, "mmap_ring") == 0) {
+        return enxlog_sink_factory_create_mmap_ring_sink(sink, parameters, error_callback);
+#endif
+
+#ifdef ENXLOG_URING_FILE
+    } else if (strcmp(value, "uring_file") == 0) {
+        return enxlog_sink_factory_create_uring_file_sink(sink, parameters, error_callback);
+#endif
+
+#ifdef ENXLOG_SHM
+    } else if (strcmp(value, "shm") == 0) {
+        return enxlog_sink_factory_create_shm_sink(sink, parameters, error_callback);
+#endif
+
+#ifdef ENXLOG_SYSLOG
+    } else if (strcmp(value, "syslog") == 0) {
+        return enxlog_sink_factory_create_syslog_sink(sink, parameters, error_callback);
+#endif
+
+#ifdef ENXLOG_JOURNALD
+    } else if (strcmp(value, "journald") == 0) {
+        return enxlog_sink_factory_create_journald_sink(sink, parameters, error_callback);
+#endif
+
+#ifdef ENXLOG_TCP
+    } else if (strcmp(value, "tcp") == 0) {
+        return enxlog_sink_factory_create_tcp_sink(sink, parameters, error_callback);
+#endif
+
     } else {
         return false;
     }
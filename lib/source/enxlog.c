@@ -21,17 +21,47 @@
  */
 
 #include <enx/log/enxlog.h>
+#include <enx/log/enxlog_async.h>
+#include <enx/log/enxlog_deferred.h>
+#include <enx/log/enxlog_latency.h>
 #include <enx/txt/format.h>
+
+#include "enxlog_internal.h"
+
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <sys/time.h>
 
 
 /**
- * Returns true when output is allowed for the given logger and loglevel
+ * Log entry state, passed as context to the formatter output function
+ * @private
+ */
+struct enxlog_entry
+{
+    const struct enxlog_instance *instance;
+    size_t length;
+};
+
+/**
+ * Output decision for a log entry
  * @private
  */
-static bool enxlog_allow_output(
+enum enxlog_output
+{
+    ENXLOG_OUTPUT_NONE = 0,
+    ENXLOG_OUTPUT_EMIT,
+    ENXLOG_OUTPUT_CAPTURE
+};
+
+/**
+ * Returns the output decision of a filter for the given logger and loglevel
+ * @private
+ */
+static enum enxlog_output enxlog_allow_output(
+    const struct enxlog_instance *instance,
+    const struct enxlog_filter *filter,
     const struct enxlog_logger *logger,
     enum enxlog_loglevel loglevel);
 
@@ -40,6 +70,7 @@ static bool enxlog_allow_output(
  * @private
  */
 static void enxlog_log_entry_open(
+    const struct enxlog_instance *instance,
     const struct enxlog_logger* logger,
     enum enxlog_loglevel loglevel,
     const char *func,
@@ -58,13 +89,72 @@ static bool enxlog_log_entry_write(
  * Closes a log entry
  * @private
  */
-static void enxlog_log_entry_close(void);
+static void enxlog_log_entry_close(const struct enxlog_instance *instance);
+
+/**
+ * Delivers the structured fields of a log entry to the sinks
+ * @private
+ */
+static void enxlog_log_entry_fields(
+    const struct enxlog_instance *instance,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count);
 
+/**
+ * Formatter output function that writes to a single sink
+ * @private
+ */
+static bool enxlog_sink_write(void *context, const char *ptr, size_t length);
 
-static enum enxlog_loglevel enxlog_default_loglevel = LOGLEVEL_NONE;
-static const struct enxlog_sink *enxlog_sinks = NULL;
-static const struct enxlog_lock *enxlog_lock = NULL;
-static const struct enxlog_filter *enxlog_filter = NULL;
+/**
+ * Writes a formatted record to a single sink through its entry callbacks
+ * @private
+ */
+static void enxlog_sink_write_record(
+    const struct enxlog_sink *sink,
+    const struct enxlog_record *record);
+
+
+/**
+ * Returns the most verbose loglevel in a filter tree
+ * @private
+ */
+static enum enxlog_loglevel enxlog_filter_max_loglevel(
+    const struct enxlog_filter_entry *entries,
+    enum enxlog_loglevel loglevel);
+
+/**
+ * Adds bytes to a 32 bit FNV-1a hash
+ * @private
+ */
+static uint32_t enxlog_logger_id_update(uint32_t id, const char *ptr, size_t length);
+
+/**
+ * Acquires the spinlock of the instance list
+ * @private
+ */
+static void enxlog_instances_lock(void);
+
+/**
+ * Releases the spinlock of the instance list
+ * @private
+ */
+static void enxlog_instances_unlock(void);
+
+#ifdef ENXLOG_EARLY_BUFFER
+// Everything is captured until the filter is known
+enum enxlog_loglevel enxlog_enabled_loglevel = LOGLEVEL_TRACE;
+#else
+enum enxlog_loglevel enxlog_enabled_loglevel = LOGLEVEL_NONE;
+#endif
+
+_Thread_local const struct timeval *enxlog_entry_replay_time = NULL;
+
+struct enxlog_instance enxlog_default_instance = { .default_loglevel = LOGLEVEL_NONE };
+
+// Instances that have been initialized, for enxlog_enabled_loglevel
+static struct enxlog_instance *enxlog_instances = NULL;
+static bool enxlog_instances_locked = false;
 
 
 bool enxlog_init(
@@ -72,15 +162,61 @@ bool enxlog_init(
     const struct enxlog_sink *sinks,
     const struct enxlog_lock *lock,
     const struct enxlog_filter *filter)
+{
+    return enxlog_instance_init(&enxlog_default_instance, default_loglevel, sinks, lock, filter);
+}
+
+void enxlog_shutdown(void)
+{
+#ifdef ENXLOG_DEFERRED
+    while (enxlog_deferred_drain()) {
+    }
+#endif
+
+#ifdef ENXLOG_ASYNC
+    enxlog_async_stop();
+#endif
+
+#ifdef ENXLOG_PROFILER
+    enxlog_profiler_shutdown();
+#endif
+
+    enxlog_instance_shutdown(&enxlog_default_instance);
+}
+
+bool enxlog_instance_init(
+    struct enxlog_instance *instance,
+    enum enxlog_loglevel default_loglevel,
+    const struct enxlog_sink *sinks,
+    const struct enxlog_lock *lock,
+    const struct enxlog_filter *filter)
 {
     bool result = true;
 
-    enxlog_default_loglevel = default_loglevel;
-    enxlog_sinks = sinks;
-    enxlog_lock = lock;
-    enxlog_filter = filter;
+    instance->default_loglevel = default_loglevel;
+    instance->sinks = sinks;
+    instance->lock = lock;
 
-    const struct enxlog_sink *sink = enxlog_sinks;
+    // Logging stays disabled without a filter
+    instance->filter_loglevel = filter ?
+        enxlog_filter_max_loglevel(filter->entries, default_loglevel) :
+        LOGLEVEL_NONE;
+
+    enxlog_instances_lock();
+
+    struct enxlog_instance *search = enxlog_instances;
+    while (search && (search != instance)) {
+        search = search->next;
+    }
+
+    if (search == NULL) {
+        instance->next = enxlog_instances;
+        enxlog_instances = instance;
+    }
+
+    enxlog_instances_unlock();
+
+    const struct enxlog_sink *sink = instance->sinks;
     while (sink->valid) {
         if (sink->fn_init) {
             result &= sink->fn_init(sink->context);
@@ -88,12 +224,56 @@ bool enxlog_init(
         sink++;
     }
 
+#ifdef ENXLOG_EARLY_BUFFER
+    // The buffered entries reach the sinks before any entry logged directly
+    bool replay = (instance == &enxlog_default_instance);
+    if (replay) {
+        enxlog_lock_acquire(instance);
+        enxlog_early_buffer_replay(filter);
+    }
+#endif
+
+    // Entries are accepted once the filter is set
+    __atomic_store_n(&instance->filter, filter, __ATOMIC_RELEASE);
+    enxlog_enabled_loglevel_update();
+
+#ifdef ENXLOG_EARLY_BUFFER
+    if (replay) {
+        // Entries captured during the first replay. Captures that start
+        // after this one see the filter and log directly.
+        enxlog_early_buffer_replay(filter);
+        enxlog_lock_release(instance);
+    }
+#endif
+
     return result;
 }
 
-void enxlog_shutdown(void)
+void enxlog_instance_shutdown(struct enxlog_instance *instance)
 {
-    const struct enxlog_sink *sink = enxlog_sinks;
+    // The instance may be freed once it is shut down
+    enxlog_instances_lock();
+
+    struct enxlog_instance **link = &enxlog_instances;
+    while (*link && (*link != instance)) {
+        link = &(*link)->next;
+    }
+
+    if (*link) {
+        *link = instance->next;
+        instance->next = NULL;
+    }
+
+    enxlog_instances_unlock();
+
+    __atomic_store_n(&instance->filter, NULL, __ATOMIC_RELEASE);
+    enxlog_enabled_loglevel_update();
+
+    const struct enxlog_sink *sink = instance->sinks;
+    if (sink == NULL) {
+        return;
+    }
+
     while (sink->valid) {
         if (sink->fn_shutdown) {
             sink->fn_shutdown(sink->context);
@@ -103,33 +283,184 @@ void enxlog_shutdown(void)
     }
 }
 
+void enxlog_enabled_loglevel_update(void)
+{
+    enum enxlog_loglevel loglevel = LOGLEVEL_NONE;
+    const struct enxlog_instance *instance;
+
+    enxlog_instances_lock();
+
+    for (instance = enxlog_instances; instance; instance = instance->next) {
+        if (instance->filter_loglevel > loglevel) {
+            loglevel = instance->filter_loglevel;
+        }
+    }
+
+    enxlog_instances_unlock();
+
+#ifdef ENXLOG_TAIL_BUFFER
+    if (enxlog_tail_buffer_capture_loglevel > loglevel) {
+        loglevel = enxlog_tail_buffer_capture_loglevel;
+    }
+#endif
+
+#ifdef ENXLOG_PROFILER
+    // The profiler also counts suppressed entries
+    loglevel = LOGLEVEL_TRACE;
+#endif
+
+    enxlog_enabled_loglevel = loglevel;
+}
+
+uint32_t enxlog_logger_id(const struct enxlog_logger *logger)
+{
+    uint32_t id = 2166136261u;
+
+    if (logger->path) {
+        id = enxlog_logger_id_update(id, logger->path, logger->path_length);
+    } else {
+        // The parts hash the same as the path they would be joined into
+        for (const char **name_part = logger->name; *name_part; ++name_part) {
+            id = enxlog_logger_id_update(id, *name_part, strlen(*name_part));
+            id = enxlog_logger_id_update(id, "::", 2);
+        }
+    }
+
+    if (id == 0) {
+        id = 1;
+    }
+
+    return id;
+}
+
 void enxlog_log(
     const struct enxlog_logger *logger,
     enum enxlog_loglevel loglevel,
     const char *func,
     unsigned int line,
     const char *format,
-    const struct enxtxt_fstr_arg *args)
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count)
 {
-    if (enxlog_filter == NULL) {
+    enxlog_log_format(logger, loglevel, func, line, NULL, format, args, arg_count);
+}
+
+void enxlog_log_format(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count)
+{
+    const struct enxlog_instance *instance = enxlog_logger_instance(logger);
+
+    // Read once, as enxlog_instance_shutdown() clears it
+    const struct enxlog_filter *filter = __atomic_load_n(&instance->filter, __ATOMIC_ACQUIRE);
+
+    if (filter == NULL) {
+#ifdef ENXLOG_EARLY_BUFFER
+        // The capture is refused once enxlog_init() has published the filter
+        if ((instance != &enxlog_default_instance) ||
+            enxlog_early_buffer_capture(logger, loglevel, func, line, cache, format, args, arg_count)) {
+            return;
+        }
+
+        filter = __atomic_load_n(&instance->filter, __ATOMIC_ACQUIRE);
+        if (filter == NULL) {
+            return;
+        }
+#else
         return;
+#endif
     }
 
-    if (enxlog_allow_output(logger, loglevel)) {
+#if defined(ENXLOG_PROFILER) || defined(ENXLOG_LATENCY)
+    uint64_t start = enxlog_clock_now();
+#endif
+
+    struct enxlog_entry entry = { .instance = instance, .length = 0 };
+    enum enxlog_output output = enxlog_allow_output(instance, filter, logger, loglevel);
+    bool emitted = (output == ENXLOG_OUTPUT_EMIT);
+    bool queued = false;
+
+#ifdef ENXLOG_ASYNC
+    // The consumer thread writes the entry to the sinks
+    if (emitted && enxlog_async_active()) {
+#ifdef ENXLOG_TAIL_BUFFER
+        if (loglevel <= enxlog_tail_buffer_trigger_loglevel) {
+            enxlog_tail_buffer_replay();
+        }
+#endif
 
-        enxlog_log_entry_open(logger, loglevel, func, line);
-        _enxtxt_fstr_cb(enxlog_log_entry_write, NULL, format, args);
-        enxlog_log_entry_close();
+        queued = enxlog_async_capture(logger, loglevel, func, line, cache, format, args, arg_count, &entry.length);
     }
+#endif
+
+#ifdef ENXLOG_DEFERRED
+    // Never takes the lock; enxlog_deferred_drain() writes the entry
+    if (emitted && !queued) {
+        entry.length = enxlog_deferred_capture(logger, loglevel, func, line, cache, format, args, arg_count);
+        queued = true;
+    }
+#endif
+
+    if (queued) {
+
+#ifdef ENXLOG_LATENCY
+        uint64_t now = enxlog_clock_now();
+
+        enxlog_latency_record(ENXLOG_LATENCY_PRODUCER, now - start);
+        enxlog_latency_log_periodic(now);
+#endif
+    }
+
+    else if (emitted) {
+
+#ifdef ENXLOG_TAIL_BUFFER
+        // Emit the buffered context ahead of the triggering entry, before
+        // the lock is taken, as the context may belong to other instances
+        if (loglevel <= enxlog_tail_buffer_trigger_loglevel) {
+            enxlog_tail_buffer_replay();
+        }
+#endif
+
+        enxlog_lock_acquire(instance);
+
+        enxlog_log_entry_open(instance, logger, loglevel, func, line);
+        enxlog_format_write(cache, format, enxlog_log_entry_write, &entry, args);
+        enxlog_log_entry_fields(instance, args, arg_count);
+        enxlog_log_entry_close(instance);
+
+        enxlog_lock_release(instance);
+
+#ifdef ENXLOG_LATENCY
+        enxlog_latency_record_entry(start);
+#endif
+    }
+
+#ifdef ENXLOG_TAIL_BUFFER
+    else if (output == ENXLOG_OUTPUT_CAPTURE) {
+        enxlog_tail_buffer_capture(logger, loglevel, func, line, cache, format, args, arg_count);
+    }
+#endif
+
+#ifdef ENXLOG_PROFILER
+    enxlog_profiler_record(logger, func, line, emitted, entry.length, enxlog_clock_now() - start);
+#endif
 }
 
-static bool enxlog_allow_output(
+static enum enxlog_output enxlog_allow_output(
+    const struct enxlog_instance *instance,
+    const struct enxlog_filter *filter,
     const struct enxlog_logger *logger,
     enum enxlog_loglevel loglevel)
 {
-    enum enxlog_loglevel config_loglevel = enxlog_default_loglevel;
+    enum enxlog_loglevel config_loglevel = instance->default_loglevel;
 
-    const struct enxlog_filter_entry *filter_entry = enxlog_filter->entries;
+    const struct enxlog_filter_entry *filter_entry = filter->entries;
     const char **name_part = logger->name;
 
     while (*name_part) {
@@ -150,27 +481,135 @@ static bool enxlog_allow_output(
         }
     }
 
-    return (loglevel <= config_loglevel);
+    if (loglevel <= config_loglevel) {
+        return ENXLOG_OUTPUT_EMIT;
+    }
+
+#ifdef ENXLOG_TAIL_BUFFER
+    if (loglevel <= enxlog_tail_buffer_capture_loglevel) {
+        return ENXLOG_OUTPUT_CAPTURE;
+    }
+#endif
+
+    return ENXLOG_OUTPUT_NONE;
 }
 
-static void enxlog_log_entry_open(
+bool enxlog_filter_allows(
+    const struct enxlog_instance *instance,
+    const struct enxlog_filter *filter,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel)
+{
+    if (filter == NULL) {
+        return false;
+    }
+
+    return enxlog_allow_output(instance, filter, logger, loglevel) == ENXLOG_OUTPUT_EMIT;
+}
+
+void enxlog_entry_time(struct timeval *time)
+{
+    if (enxlog_entry_replay_time) {
+        *time = *enxlog_entry_replay_time;
+    } else {
+        gettimeofday(time, NULL);
+    }
+}
+
+static enum enxlog_loglevel enxlog_filter_max_loglevel(
+    const struct enxlog_filter_entry *entries,
+    enum enxlog_loglevel loglevel)
+{
+    while (entries && entries->name_part) {
+        if (entries->loglevel > loglevel) {
+            loglevel = entries->loglevel;
+        }
+
+        loglevel = enxlog_filter_max_loglevel(entries->children, loglevel);
+        entries++;
+    }
+
+    return loglevel;
+}
+
+void enxlog_lock_acquire(const struct enxlog_instance *instance)
+{
+    if (instance->lock) {
+        instance->lock->fn_lock(instance->lock->context);
+    }
+}
+
+void enxlog_lock_release(const struct enxlog_instance *instance)
+{
+    if (instance->lock) {
+        instance->lock->fn_unlock(instance->lock->context);
+    }
+}
+
+void enxlog_sinks_write_record(
+    const struct enxlog_instance *instance,
     const struct enxlog_logger *logger,
     enum enxlog_loglevel loglevel,
     const char *func,
-    unsigned int line)
+    unsigned int line,
+    const char *message,
+    size_t length)
 {
-    // No sinks
-    if (enxlog_sinks == NULL) {
+    struct enxlog_record record = {
+        .logger = logger,
+        .loglevel = loglevel,
+        .func = func,
+        .line = line,
+        .time = enxlog_entry_replay_time,
+        .message = message,
+        .length = length
+    };
+
+    enxlog_sinks_write_batch(instance, &record, 1);
+}
+
+void enxlog_sinks_write_batch(
+    const struct enxlog_instance *instance,
+    const struct enxlog_record *records,
+    size_t count)
+{
+    const struct timeval *time = enxlog_entry_replay_time;
+
+    if (instance->sinks == NULL) {
         return;
     }
 
-    // Lock
-    if (enxlog_lock) {
-        enxlog_lock->fn_lock(enxlog_lock->context);
+    const struct enxlog_sink *sink = instance->sinks;
+    while (sink->valid) {
+        if (sink->fn_log_batch) {
+            sink->fn_log_batch(sink->context, records, count);
+
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                enxlog_entry_replay_time = records[i].time;
+                enxlog_sink_write_record(sink, &records[i]);
+            }
+        }
+
+        enxlog_entry_replay_time = time;
+        sink++;
     }
+}
 
+void enxlog_record_select(const struct enxlog_record *record)
+{
+    enxlog_entry_replay_time = record->time;
+}
+
+static void enxlog_log_entry_open(
+    const struct enxlog_instance *instance,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
     // Log
-    const struct enxlog_sink *sink = enxlog_sinks;
+    const struct enxlog_sink *sink = instance->sinks;
     while (sink->valid) {
         if (sink->fn_log_entry_open) {
             sink->fn_log_entry_open(sink->context, logger, loglevel, func, line);
@@ -181,8 +620,11 @@ static void enxlog_log_entry_open(
 
 static bool enxlog_log_entry_write(void *context, const char *ptr, size_t length)
 {
+    struct enxlog_entry *entry = (struct enxlog_entry *)context;
+    entry->length += length;
+
     // Log
-    const struct enxlog_sink *sink = enxlog_sinks;
+    const struct enxlog_sink *sink = entry->instance->sinks;
     while (sink->valid) {
         if (sink->fn_log_entry_write) {
             sink->fn_log_entry_write(sink->context, ptr, length);
@@ -193,18 +635,128 @@ static bool enxlog_log_entry_write(void *context, const char *ptr, size_t length
     return true;
 }
 
-static void enxlog_log_entry_close(void)
+static void enxlog_log_entry_close(const struct enxlog_instance *instance)
 {
     // Log
-    const struct enxlog_sink *sink = enxlog_sinks;
+    const struct enxlog_sink *sink = instance->sinks;
     while (sink->valid) {
         if (sink->fn_log_entry_close) {
             sink->fn_log_entry_close(sink->context);
         }
         sink++;
     }
+}
+
+static void enxlog_log_entry_fields(
+    const struct enxlog_instance *instance,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count)
+{
+    for (size_t i = 0; i < arg_count; ++i) {
+        if (args[i].fn_fmt != enxlog_field_fmt) {
+            continue;
+        }
+
+        const struct enxlog_field *field = (const struct enxlog_field *)args[i]._user;
+
+        const struct enxlog_sink *sink = instance->sinks;
+        while (sink->valid) {
+            if (sink->fn_log_entry_field) {
+                sink->fn_log_entry_field(sink->context, field->key, &field->value);
+
+            } else if (sink->fn_log_entry_write) {
+                sink->fn_log_entry_write(sink->context, " ", 1);
+                enxlog_field_fmt(&args[i], enxlog_sink_write, (void *)sink);
+            }
+            sink++;
+        }
+    }
+}
+
+static bool enxlog_sink_write(void *context, const char *ptr, size_t length)
+{
+    const struct enxlog_sink *sink = (const struct enxlog_sink *)context;
+
+    sink->fn_log_entry_write(sink->context, ptr, length);
+
+    return true;
+}
+
+static void enxlog_sink_write_record(
+    const struct enxlog_sink *sink,
+    const struct enxlog_record *record)
+{
+    const char *message = record->message;
+    const char *end = message + record->length;
+
+    if (sink->fn_log_entry_open) {
+        sink->fn_log_entry_open(sink->context, record->logger, record->loglevel, record->func, record->line);
+    }
+
+    // Newlines are written separately, as the formatter does
+    while (sink->fn_log_entry_write && (message < end)) {
+        const char *newline = memchr(message, '\n', end - message);
+        if (newline == NULL) {
+            sink->fn_log_entry_write(sink->context, message, end - message);
+            break;
+        }
+
+        if (newline > message) {
+            sink->fn_log_entry_write(sink->context, message, newline - message);
+        }
+
+        sink->fn_log_entry_write(sink->context, "\n", 1);
+        message = newline + 1;
+    }
 
-    if (enxlog_lock) {
-        enxlog_lock->fn_unlock(enxlog_lock->context);
+    if (sink->fn_log_entry_close) {
+        sink->fn_log_entry_close(sink->context);
     }
 }
+
+void enxlog_field_fmt(
+    const struct enxtxt_fstr_arg *arg,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context)
+{
+    const struct enxlog_field *field = (const struct enxlog_field *)arg->_user;
+
+    output_fn(output_fn_context, field->key, strlen(field->key));
+    output_fn(output_fn_context, "=", 1);
+    field->value.fn_fmt(&field->value, output_fn, output_fn_context);
+}
+
+void enxlog_fields_format(
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count)
+{
+    for (size_t i = 0; i < arg_count; ++i) {
+        if (args[i].fn_fmt == enxlog_field_fmt) {
+            output_fn(output_fn_context, " ", 1);
+            enxlog_field_fmt(&args[i], output_fn, output_fn_context);
+        }
+    }
+}
+
+static uint32_t enxlog_logger_id_update(uint32_t id, const char *ptr, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        id ^= (unsigned char)ptr[i];
+        id *= 16777619u;
+    }
+
+    return id;
+}
+
+static void enxlog_instances_lock(void)
+{
+    while (__atomic_test_and_set(&enxlog_instances_locked, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void enxlog_instances_unlock(void)
+{
+    __atomic_clear(&enxlog_instances_locked, __ATOMIC_RELEASE);
+}
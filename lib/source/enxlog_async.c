@@ -0,0 +1,825 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog_async.h>
+#include <enx/log/enxlog_latency.h>
+
+#include "enxlog_internal.h"
+#include "enxlog_record_buffer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+
+/**
+ * Rounds a record length up to the header alignment
+ * @private
+ */
+#define ENXLOG_ASYNC_ALIGN(_length) (((_length) + 7) & ~(size_t)7)
+
+/**
+ * Timestamp that makes a push read the clock when the record is published
+ * @private
+ */
+#define ENXLOG_ASYNC_TIMESTAMP_NOW 0
+
+/**
+ * Per thread single producer, single consumer ring
+ *
+ * Records are a struct enxlog_record_header followed by the message. A
+ * record that does not fit before the end of the ring starts at the
+ * beginning; the gap is marked by a header without a logger, or left
+ * unmarked if it is shorter than a header. The producer and the consumer
+ * are kept on separate cache lines. The ring outlives its thread, until the
+ * consumer has written the remaining records.
+ *
+ * @private
+ */
+struct enxlog_async_ring
+{
+    struct enxlog_async_ring *next;
+    char *data;
+    size_t size;
+    bool retired;
+
+    // Written by the producer. The sequence is odd while a record is being
+    // written.
+    _Alignas(64) uint64_t head;
+    uint64_t sequence;
+
+    // Written by the consumer
+    _Alignas(64) uint64_t tail;
+};
+
+/**
+ * Message being captured by a producer, before it is pushed to the ring
+ * @private
+ */
+struct enxlog_async_scratch
+{
+    size_t message_length;
+    char message[ENXLOG_ASYNC_MAX_MESSAGE];
+};
+
+/**
+ * Consumer position in a ring
+ * @private
+ */
+struct enxlog_async_cursor
+{
+    struct enxlog_async_ring *ring;
+    uint64_t position;
+    uint64_t head;
+    const struct enxlog_record_header *header;
+};
+
+/**
+ * Returns the calling thread's ring, creating it if required
+ * @private
+ */
+static struct enxlog_async_ring *enxlog_async_ring_get(void);
+
+/**
+ * Retires a thread's ring when the thread exits
+ * @private
+ */
+static void enxlog_async_ring_retire(void *context);
+
+/**
+ * Removes a ring from the ring list. The caller must hold the mutex.
+ * @private
+ */
+static void enxlog_async_ring_unlink(struct enxlog_async_ring *ring);
+
+/**
+ * Frees up to #ENXLOG_BATCH_MAX_RECORDS rings that have been removed from
+ * the ring list
+ * @private
+ */
+static void enxlog_async_rings_free(void *const *rings, size_t count);
+
+/**
+ * Creates the thread exit key
+ * @private
+ */
+static void enxlog_async_create_key(void);
+
+/**
+ * Formatter output function that appends to the message being captured
+ * @private
+ */
+static bool enxlog_async_write(void *context, const char *ptr, size_t length);
+
+/**
+ * Appends a record to a ring, waiting for room if required
+ * @param timestamp The time at which the record was logged, or
+ * ENXLOG_ASYNC_TIMESTAMP_NOW to read the clock when the record is published
+ * @returns false if the consumer is not running
+ * @private
+ */
+static bool enxlog_async_ring_push(
+    struct enxlog_async_ring *ring,
+    uint64_t timestamp,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    const char *message,
+    size_t length);
+
+/**
+ * Finds the next record at or after the cursor position
+ * @private
+ */
+static void enxlog_async_cursor_peek(struct enxlog_async_cursor *cursor);
+
+/**
+ * Writes every published record with a timestamp before the horizon to the
+ * sinks, in timestamp order
+ * @returns true if any record was written
+ * @private
+ */
+static bool enxlog_async_merge(uint64_t horizon);
+
+/**
+ * Writes the batched records to the sinks and hands the space they used
+ * back to the producers
+ * @param timestamps The timestamps of the batched records, for the end to
+ * end latency
+ * @private
+ */
+static void enxlog_async_write_merged(
+    struct enxlog_batch *batch,
+    const uint64_t *timestamps,
+    struct enxlog_async_cursor *cursors,
+    size_t cursor_count);
+
+/**
+ * Restores the heap order below a heap position
+ * @private
+ */
+static void enxlog_async_heap_down(struct enxlog_async_cursor **heap, size_t count, size_t index);
+
+/**
+ * Consumer thread
+ * @private
+ */
+static void *enxlog_async_thread(void *arg);
+
+
+static pthread_mutex_t enxlog_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t enxlog_async_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t enxlog_async_written_condition = PTHREAD_COND_INITIALIZER;
+static pthread_key_t enxlog_async_key;
+static pthread_once_t enxlog_async_key_once = PTHREAD_ONCE_INIT;
+static pthread_t enxlog_async_consumer;
+
+// Set while entries may be queued, and while the consumer thread exists
+static bool enxlog_async_running = false;
+static bool enxlog_async_consumer_alive = false;
+
+static struct enxlog_async_ring *enxlog_async_rings = NULL;
+static size_t enxlog_async_ring_size = 0;
+
+// Entries with an earlier timestamp have been written
+static uint64_t enxlog_async_written = 0;
+
+// Converts the monotonic timestamps of the records to wall clock time
+static int64_t enxlog_async_wall_offset = 0;
+
+static _Thread_local struct enxlog_async_ring *enxlog_async_thread_ring = NULL;
+static _Thread_local struct enxlog_async_scratch enxlog_async_thread_scratch;
+static _Thread_local bool enxlog_async_is_consumer = false;
+
+// Merge state, only used by the consumer thread
+static struct enxlog_async_cursor *enxlog_async_cursors = NULL;
+static struct enxlog_async_cursor **enxlog_async_heap = NULL;
+static size_t enxlog_async_cursor_capacity = 0;
+
+
+bool enxlog_async_start(size_t ring_size)
+{
+    struct timeval now;
+    size_t size = 64;
+
+    if (ring_size == 0) {
+        ring_size = ENXLOG_ASYNC_RING_SIZE;
+    }
+
+    // Room for a few maximum length records, including the wrap gap
+    if (ring_size < 4 * (sizeof(struct enxlog_record_header) + ENXLOG_ASYNC_MAX_MESSAGE)) {
+        return false;
+    }
+
+    while (size < ring_size) {
+        size <<= 1;
+    }
+
+    pthread_once(&enxlog_async_key_once, enxlog_async_create_key);
+
+    pthread_mutex_lock(&enxlog_async_mutex);
+
+    if (enxlog_async_consumer_alive) {
+        pthread_mutex_unlock(&enxlog_async_mutex);
+        return false;
+    }
+
+    gettimeofday(&now, NULL);
+    enxlog_async_wall_offset =
+        (int64_t)(((uint64_t)now.tv_sec * 1000000000ull) + ((uint64_t)now.tv_usec * 1000ull)) -
+        (int64_t)enxlog_clock_now();
+
+    enxlog_async_ring_size = size;
+    enxlog_async_written = 0;
+    __atomic_store_n(&enxlog_async_running, true, __ATOMIC_SEQ_CST);
+
+    if (pthread_create(&enxlog_async_consumer, NULL, enxlog_async_thread, NULL) != 0) {
+        __atomic_store_n(&enxlog_async_running, false, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&enxlog_async_mutex);
+        return false;
+    }
+
+    enxlog_async_consumer_alive = true;
+
+    pthread_mutex_unlock(&enxlog_async_mutex);
+
+    return true;
+}
+
+void enxlog_async_stop(void)
+{
+    pthread_mutex_lock(&enxlog_async_mutex);
+
+    if (!enxlog_async_consumer_alive || !enxlog_async_running) {
+        pthread_mutex_unlock(&enxlog_async_mutex);
+        return;
+    }
+
+    __atomic_store_n(&enxlog_async_running, false, __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&enxlog_async_wakeup);
+
+    pthread_mutex_unlock(&enxlog_async_mutex);
+
+    pthread_join(enxlog_async_consumer, NULL);
+}
+
+void enxlog_async_flush(void)
+{
+    uint64_t now = enxlog_clock_now();
+
+    if (enxlog_async_is_consumer) {
+        return;
+    }
+
+    pthread_mutex_lock(&enxlog_async_mutex);
+
+    pthread_cond_signal(&enxlog_async_wakeup);
+
+    while (enxlog_async_consumer_alive && (enxlog_async_written <= now)) {
+        pthread_cond_wait(&enxlog_async_written_condition, &enxlog_async_mutex);
+    }
+
+    pthread_mutex_unlock(&enxlog_async_mutex);
+}
+
+bool enxlog_async_active(void)
+{
+    return __atomic_load_n(&enxlog_async_running, __ATOMIC_RELAXED) && !enxlog_async_is_consumer;
+}
+
+bool enxlog_async_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count,
+    size_t *length)
+{
+    struct enxlog_async_ring *ring = enxlog_async_ring_get();
+    struct enxlog_async_scratch *scratch = &enxlog_async_thread_scratch;
+    if (ring == NULL) {
+        return false;
+    }
+
+    // Fields are kept as text, as the arguments do not outlive the call
+    scratch->message_length = 0;
+    enxlog_format_write(cache, format, enxlog_async_write, scratch, args);
+    enxlog_fields_format(enxlog_async_write, scratch, args, arg_count);
+    *length = scratch->message_length;
+
+    return enxlog_async_ring_push(
+        ring,
+        ENXLOG_ASYNC_TIMESTAMP_NOW,
+        logger,
+        loglevel,
+        func,
+        line,
+        scratch->message,
+        scratch->message_length);
+}
+
+size_t enxlog_async_write_batch(
+    const struct enxlog_record *records,
+    const uint64_t *timestamps,
+    size_t count)
+{
+    struct enxlog_async_ring *ring = enxlog_async_ring_get();
+    size_t i;
+
+    if (ring == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < count; ++i) {
+        size_t length = records[i].length;
+        if (length > ENXLOG_ASYNC_MAX_MESSAGE) {
+            length = ENXLOG_ASYNC_MAX_MESSAGE;
+        }
+
+        if (!enxlog_async_ring_push(
+                ring,
+                timestamps[i],
+                records[i].logger,
+                records[i].loglevel,
+                records[i].func,
+                records[i].line,
+                records[i].message,
+                length)) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+static struct enxlog_async_ring *enxlog_async_ring_get(void)
+{
+    struct enxlog_async_ring *ring = enxlog_async_thread_ring;
+
+    if (ring) {
+        return ring;
+    }
+
+    pthread_mutex_lock(&enxlog_async_mutex);
+
+    if (!enxlog_async_running) {
+        pthread_mutex_unlock(&enxlog_async_mutex);
+        return NULL;
+    }
+
+#ifdef ENXLOG_POOL
+    // The data takes a block of exactly the ring size, and the ring shares
+    // a block with the rings of other threads
+    ring = enxlog_pool_alloc(sizeof(struct enxlog_async_ring));
+    char *data = enxlog_pool_alloc(enxlog_async_ring_size);
+
+    if ((ring == NULL) || (data == NULL)) {
+        void *blocks[] = { ring, data };
+        enxlog_pool_free_batch(blocks, 2);
+        ring = NULL;
+    }
+#else
+    ring = aligned_alloc(64, sizeof(struct enxlog_async_ring) + enxlog_async_ring_size);
+    char *data = (char *)(ring + 1);
+#endif
+    if (ring) {
+        memset(ring, 0, sizeof(struct enxlog_async_ring));
+        ring->data = data;
+        ring->size = enxlog_async_ring_size;
+
+        // The consumer walks the list without the mutex; it is the only
+        // thread that removes rings
+        ring->next = enxlog_async_rings;
+        __atomic_store_n(&enxlog_async_rings, ring, __ATOMIC_RELEASE);
+
+        pthread_setspecific(enxlog_async_key, ring);
+        enxlog_async_thread_ring = ring;
+    }
+
+    pthread_mutex_unlock(&enxlog_async_mutex);
+
+    return ring;
+}
+
+static void enxlog_async_ring_retire(void *context)
+{
+    struct enxlog_async_ring *ring = (struct enxlog_async_ring *)context;
+
+    pthread_mutex_lock(&enxlog_async_mutex);
+
+    // The consumer frees the ring once it has written the remaining records
+    if (enxlog_async_consumer_alive) {
+        __atomic_store_n(&ring->retired, true, __ATOMIC_RELEASE);
+    } else {
+        void *block = ring;
+
+        enxlog_async_ring_unlink(ring);
+        enxlog_async_rings_free(&block, 1);
+    }
+
+    pthread_mutex_unlock(&enxlog_async_mutex);
+
+    enxlog_async_thread_ring = NULL;
+}
+
+static void enxlog_async_ring_unlink(struct enxlog_async_ring *ring)
+{
+    struct enxlog_async_ring **link = &enxlog_async_rings;
+
+    while (*link && (*link != ring)) {
+        link = &(*link)->next;
+    }
+
+    if (*link) {
+        __atomic_store_n(link, ring->next, __ATOMIC_RELEASE);
+    }
+}
+
+static void enxlog_async_rings_free(void *const *rings, size_t count)
+{
+#ifdef ENXLOG_POOL
+    void *blocks[2 * ENXLOG_BATCH_MAX_RECORDS];
+
+    for (size_t i = 0; i < count; ++i) {
+        blocks[2 * i] = ((struct enxlog_async_ring *)rings[i])->data;
+        blocks[2 * i + 1] = rings[i];
+    }
+
+    enxlog_pool_free_batch(blocks, 2 * count);
+#else
+    for (size_t i = 0; i < count; ++i) {
+        free(rings[i]);
+    }
+#endif
+}
+
+static void enxlog_async_create_key(void)
+{
+    pthread_key_create(&enxlog_async_key, enxlog_async_ring_retire);
+}
+
+static bool enxlog_async_write(void *context, const char *ptr, size_t length)
+{
+    struct enxlog_async_scratch *scratch = (struct enxlog_async_scratch *)context;
+    size_t available = sizeof(scratch->message) - scratch->message_length;
+
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&scratch->message[scratch->message_length], ptr, length);
+    scratch->message_length += length;
+
+    return true;
+}
+
+static bool enxlog_async_ring_push(
+    struct enxlog_async_ring *ring,
+    uint64_t timestamp,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    const char *message,
+    size_t length)
+{
+    size_t record_length = sizeof(struct enxlog_record_header) + ENXLOG_ASYNC_ALIGN(length);
+    uint64_t head = ring->head;
+    size_t position = head & (ring->size - 1);
+    size_t gap = 0;
+
+    if (ring->size - position < record_length) {
+        gap = ring->size - position;
+    }
+
+    // Wait for room outside of the sequence, which the consumer waits on
+    while (head + gap + record_length - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > ring->size) {
+        if (!__atomic_load_n(&enxlog_async_running, __ATOMIC_RELAXED)) {
+            return false;
+        }
+
+        sched_yield();
+    }
+
+    // The consumer reads the clock before it looks at the sequence, so a
+    // record it has not seen yet always has a later timestamp than its
+    // horizon
+    __atomic_store_n(&ring->sequence, ring->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (!__atomic_load_n(&enxlog_async_running, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&ring->sequence, ring->sequence + 1, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    if (gap) {
+        if (gap >= sizeof(struct enxlog_record_header)) {
+            struct enxlog_record_header *marker = (struct enxlog_record_header *)&ring->data[position];
+            marker->logger = NULL;
+        }
+
+        head += gap;
+        position = 0;
+    }
+
+    struct enxlog_record_header *header = (struct enxlog_record_header *)&ring->data[position];
+    header->logger = logger;
+    header->func = func;
+    // Records logged earlier have a timestamp before the horizon, and are
+    // written by the next pass
+    header->timestamp = (timestamp == ENXLOG_ASYNC_TIMESTAMP_NOW) ? enxlog_clock_now() : timestamp;
+    header->line = line;
+    header->loglevel = loglevel;
+    header->length = length;
+    memcpy(header + 1, message, length);
+
+    __atomic_store_n(&ring->head, head + record_length, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->sequence, ring->sequence + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static void enxlog_async_cursor_peek(struct enxlog_async_cursor *cursor)
+{
+    struct enxlog_async_ring *ring = cursor->ring;
+
+    cursor->header = NULL;
+
+    while (cursor->position < cursor->head) {
+        size_t position = cursor->position & (ring->size - 1);
+        size_t gap = ring->size - position;
+
+        if (gap >= sizeof(struct enxlog_record_header)) {
+            const struct enxlog_record_header *header = (const struct enxlog_record_header *)&ring->data[position];
+            if (header->logger) {
+                cursor->header = header;
+                return;
+            }
+        }
+
+        cursor->position += gap;
+    }
+}
+
+static bool enxlog_async_merge(uint64_t horizon)
+{
+    struct enxlog_async_ring *ring;
+    struct enxlog_async_cursor **heap = enxlog_async_heap;
+    struct enxlog_batch batch = { .instance = NULL, .count = 0 };
+    uint64_t timestamps[ENXLOG_BATCH_MAX_RECORDS];
+    void *retired[ENXLOG_BATCH_MAX_RECORDS];
+    size_t retired_count = 0;
+    size_t cursor_count = 0;
+    size_t heap_count = 0;
+    bool written = false;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // New rings are added in front of the first one, so the rings from the
+    // first one onwards stay the same during the pass
+    struct enxlog_async_ring *first = __atomic_load_n(&enxlog_async_rings, __ATOMIC_ACQUIRE);
+    size_t ring_count = 0;
+
+    for (ring = first; ring; ring = ring->next) {
+        ring_count++;
+    }
+
+    if (ring_count > enxlog_async_cursor_capacity) {
+        struct enxlog_async_cursor *cursors = realloc(enxlog_async_cursors, ring_count * sizeof(*cursors));
+        if (cursors) {
+            enxlog_async_cursors = cursors;
+        }
+
+        struct enxlog_async_cursor **heap_entries = realloc(enxlog_async_heap, ring_count * sizeof(*heap_entries));
+        if (heap_entries) {
+            enxlog_async_heap = heap = heap_entries;
+        }
+
+        if (cursors && heap_entries) {
+            enxlog_async_cursor_capacity = ring_count;
+        }
+    }
+
+    // Rings that do not fit are merged once memory is available
+    for (ring = first; ring && (cursor_count < enxlog_async_cursor_capacity); ring = ring->next) {
+        // Wait for a record that is being written, as its timestamp may be
+        // before the horizon
+        uint64_t sequence = __atomic_load_n(&ring->sequence, __ATOMIC_ACQUIRE);
+        while ((sequence & 1) && (__atomic_load_n(&ring->sequence, __ATOMIC_ACQUIRE) == sequence)) {
+            sched_yield();
+        }
+
+        struct enxlog_async_cursor *cursor = &enxlog_async_cursors[cursor_count++];
+        cursor->ring = ring;
+        cursor->position = ring->tail;
+        cursor->head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        enxlog_async_cursor_peek(cursor);
+        if (cursor->header && (cursor->header->timestamp < horizon)) {
+            heap[heap_count++] = cursor;
+        }
+    }
+
+    for (size_t i = heap_count / 2; i-- > 0;) {
+        enxlog_async_heap_down(heap, heap_count, i);
+    }
+
+    // K-way merge of the rings, each of which is in timestamp order
+    while (heap_count) {
+        struct enxlog_async_cursor *cursor = heap[0];
+        const struct enxlog_record_header *header = cursor->header;
+        const struct enxlog_instance *instance = enxlog_logger_instance(header->logger);
+
+        if ((batch.count == ENXLOG_BATCH_MAX_RECORDS) || (batch.instance != instance)) {
+            enxlog_async_write_merged(&batch, timestamps, enxlog_async_cursors, cursor_count);
+            batch.instance = instance;
+        }
+
+        uint64_t wall = header->timestamp + enxlog_async_wall_offset;
+        struct timeval *time = &batch.times[batch.count];
+        time->tv_sec = (time_t)(wall / 1000000000ull);
+        time->tv_usec = (suseconds_t)((wall % 1000000000ull) / 1000ull);
+
+        timestamps[batch.count] = header->timestamp;
+        batch.records[batch.count++] = (struct enxlog_record) {
+            .logger = header->logger,
+            .loglevel = (enum enxlog_loglevel)header->loglevel,
+            .func = header->func,
+            .line = header->line,
+            .time = time,
+            .message = (const char *)(header + 1),
+            .length = header->length
+        };
+
+        cursor->position += sizeof(struct enxlog_record_header) + ENXLOG_ASYNC_ALIGN(header->length);
+        enxlog_async_cursor_peek(cursor);
+
+        if ((cursor->header == NULL) || (cursor->header->timestamp >= horizon)) {
+            heap[0] = heap[--heap_count];
+        }
+
+        enxlog_async_heap_down(heap, heap_count, 0);
+        written = true;
+    }
+
+    enxlog_async_write_merged(&batch, timestamps, enxlog_async_cursors, cursor_count);
+
+    pthread_mutex_lock(&enxlog_async_mutex);
+
+    // Rings of threads that have exited are freed together once they are
+    // empty
+    for (size_t i = 0; i < cursor_count; ++i) {
+        ring = enxlog_async_cursors[i].ring;
+        if (__atomic_load_n(&ring->retired, __ATOMIC_ACQUIRE) &&
+            (ring->tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))) {
+            enxlog_async_ring_unlink(ring);
+            retired[retired_count++] = ring;
+        }
+
+        if ((retired_count == ENXLOG_BATCH_MAX_RECORDS) || ((i + 1 == cursor_count) && retired_count)) {
+            enxlog_async_rings_free(retired, retired_count);
+            retired_count = 0;
+        }
+    }
+
+    enxlog_async_written = horizon;
+    pthread_cond_broadcast(&enxlog_async_written_condition);
+
+    pthread_mutex_unlock(&enxlog_async_mutex);
+
+    return written;
+}
+
+static void enxlog_async_write_merged(
+    struct enxlog_batch *batch,
+    const uint64_t *timestamps,
+    struct enxlog_async_cursor *cursors,
+    size_t cursor_count)
+{
+    if (batch->count) {
+        enxlog_lock_acquire(batch->instance);
+        enxlog_sinks_write_batch(batch->instance, batch->records, batch->count);
+        enxlog_lock_release(batch->instance);
+
+#ifdef ENXLOG_LATENCY
+        // Measured once the sinks have written the records
+        uint64_t now = enxlog_clock_now();
+        for (size_t i = 0; i < batch->count; ++i) {
+            enxlog_latency_record(ENXLOG_LATENCY_END_TO_END, now - timestamps[i]);
+        }
+#endif
+
+        batch->count = 0;
+    }
+
+    for (size_t i = 0; i < cursor_count; ++i) {
+        __atomic_store_n(&cursors[i].ring->tail, cursors[i].position, __ATOMIC_RELEASE);
+    }
+}
+
+static void enxlog_async_heap_down(struct enxlog_async_cursor **heap, size_t count, size_t index)
+{
+    for (;;) {
+        size_t smallest = index;
+        size_t left = (2 * index) + 1;
+        size_t right = left + 1;
+
+        if ((left < count) && (heap[left]->header->timestamp < heap[smallest]->header->timestamp)) {
+            smallest = left;
+        }
+        if ((right < count) && (heap[right]->header->timestamp < heap[smallest]->header->timestamp)) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+
+        struct enxlog_async_cursor *swap = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = swap;
+        index = smallest;
+    }
+}
+
+static void *enxlog_async_thread(void *arg)
+{
+    struct timespec deadline;
+
+    // Entries logged by the sinks are written directly
+    enxlog_async_is_consumer = true;
+
+    while (__atomic_load_n(&enxlog_async_running, __ATOMIC_SEQ_CST)) {
+        if (enxlog_async_merge(enxlog_clock_now())) {
+            continue;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += ENXLOG_ASYNC_POLL_INTERVAL_US * 1000l;
+        while (deadline.tv_nsec >= 1000000000l) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000l;
+        }
+
+        pthread_mutex_lock(&enxlog_async_mutex);
+        if (__atomic_load_n(&enxlog_async_running, __ATOMIC_SEQ_CST)) {
+            pthread_cond_timedwait(&enxlog_async_wakeup, &enxlog_async_mutex, &deadline);
+        }
+        pthread_mutex_unlock(&enxlog_async_mutex);
+    }
+
+    // Producers that have not seen the stop yet finish their record before
+    // the last pass sees their sequence
+    enxlog_async_merge(UINT64_MAX);
+
+    pthread_mutex_lock(&enxlog_async_mutex);
+
+    struct enxlog_async_ring *ring = enxlog_async_rings;
+    while (ring) {
+        struct enxlog_async_ring *next = ring->next;
+        if (ring->retired) {
+            void *block = ring;
+
+            enxlog_async_ring_unlink(ring);
+            enxlog_async_rings_free(&block, 1);
+        }
+        ring = next;
+    }
+
+    enxlog_async_consumer_alive = false;
+    pthread_cond_broadcast(&enxlog_async_written_condition);
+
+    pthread_mutex_unlock(&enxlog_async_mutex);
+
+    free(enxlog_async_cursors);
+    free(enxlog_async_heap);
+    enxlog_async_cursors = NULL;
+    enxlog_async_heap = NULL;
+    enxlog_async_cursor_capacity = 0;
+
+    return NULL;
+}
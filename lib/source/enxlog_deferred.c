@@ -0,0 +1,350 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog_deferred.h>
+#include <enx/log/enxlog_latency.h>
+
+#include "enxlog_internal.h"
+#include "enxlog_record_buffer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+
+#if (ENXLOG_DEFERRED_SLOTS & (ENXLOG_DEFERRED_SLOTS - 1)) != 0
+#error "ENXLOG_DEFERRED_SLOTS must be a power of two"
+#endif
+
+/**
+ * Mask of the slot index in a position
+ * @private
+ */
+#define ENXLOG_DEFERRED_MASK ((uint32_t)ENXLOG_DEFERRED_SLOTS - 1)
+
+/**
+ * The sequence of a free slot at the given position. The sequence is one
+ * higher once the slot is filled, and moves to the next lap when the slot
+ * is drained, so the zero initialized ring starts out free.
+ * @private
+ */
+#define ENXLOG_DEFERRED_LAP(_position) ((_position) & ~ENXLOG_DEFERRED_MASK)
+
+/**
+ * Fixed size slot in the deferred ring
+ * @private
+ */
+struct enxlog_deferred_slot
+{
+    uint32_t sequence;
+    struct enxlog_record_header header;
+    char message[ENXLOG_DEFERRED_MAX_MESSAGE];
+};
+
+
+/**
+ * Reserves the next slot
+ * @returns false if the ring is full
+ * @private
+ */
+static bool enxlog_deferred_reserve(uint32_t *position);
+
+/**
+ * Counts an entry that did not fit in the ring
+ * @private
+ */
+static void enxlog_deferred_drop(void);
+
+/**
+ * Formatter output function that appends to the message of a slot
+ * @private
+ */
+static bool enxlog_deferred_write(void *context, const char *ptr, size_t length);
+
+/**
+ * Writes the batch to the sinks and frees the slots up to the position
+ * @private
+ */
+static void enxlog_deferred_flush(struct enxlog_batch *batch, uint32_t *release, uint32_t position);
+
+
+LOGGER(enxlog_deferred_logger, "enxlog");
+
+static struct enxlog_deferred_slot enxlog_deferred_slots[ENXLOG_DEFERRED_SLOTS];
+
+// The next position to reserve, and the next position to drain
+static uint32_t enxlog_deferred_head = 0;
+static uint32_t enxlog_deferred_tail = 0;
+
+static uint32_t enxlog_deferred_dropped_count = 0;
+static uint32_t enxlog_deferred_reported = 0;
+static bool enxlog_deferred_draining = false;
+
+
+size_t enxlog_deferred_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count)
+{
+    uint32_t position;
+    if (!enxlog_deferred_reserve(&position)) {
+        enxlog_deferred_drop();
+        return 0;
+    }
+
+    struct enxlog_deferred_slot *slot = &enxlog_deferred_slots[position & ENXLOG_DEFERRED_MASK];
+
+    slot->header = (struct enxlog_record_header) {
+        .logger = logger,
+        .func = func,
+        .timestamp = enxlog_clock_now(),
+        .line = line,
+        .loglevel = loglevel,
+        .length = 0
+    };
+
+    // Fields are kept as text, as the arguments do not outlive the call
+    enxlog_format_write(cache, format, enxlog_deferred_write, slot, args);
+    enxlog_fields_format(enxlog_deferred_write, slot, args, arg_count);
+
+    size_t length = slot->header.length;
+
+    __atomic_store_n(&slot->sequence, ENXLOG_DEFERRED_LAP(position) + 1, __ATOMIC_RELEASE);
+
+    return length;
+}
+
+size_t enxlog_deferred_drain(void)
+{
+    if (__atomic_test_and_set(&enxlog_deferred_draining, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+
+    struct enxlog_batch batch = { .instance = NULL };
+    uint32_t tail = enxlog_deferred_tail;
+    uint32_t release = tail;
+    size_t written = 0;
+    struct timeval now;
+
+    // Converts the monotonic timestamps of the entries to wall clock time
+    gettimeofday(&now, NULL);
+    int64_t wall_offset =
+        (((int64_t)now.tv_sec * 1000000000ll) + ((int64_t)now.tv_usec * 1000ll)) - (int64_t)enxlog_clock_now();
+
+    // Bounded, so that a flood of entries cannot stall the main loop
+    while (written < ENXLOG_DEFERRED_SLOTS) {
+        struct enxlog_deferred_slot *slot = &enxlog_deferred_slots[tail & ENXLOG_DEFERRED_MASK];
+
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != ENXLOG_DEFERRED_LAP(tail) + 1) {
+            break;
+        }
+
+        const struct enxlog_instance *instance = enxlog_logger_instance(slot->header.logger);
+
+        if ((batch.count == ENXLOG_BATCH_MAX_RECORDS) || (batch.count && (instance != batch.instance))) {
+            enxlog_deferred_flush(&batch, &release, tail);
+        }
+
+        batch.instance = instance;
+
+        // Sinks read the time of the entry through enxlog_entry_time()
+        uint64_t wall = slot->header.timestamp + wall_offset;
+        struct timeval *time = &batch.times[batch.count];
+        time->tv_sec = (time_t)(wall / 1000000000ull);
+        time->tv_usec = (suseconds_t)((wall % 1000000000ull) / 1000ull);
+
+        batch.records[batch.count] = (struct enxlog_record) {
+            .logger = slot->header.logger,
+            .loglevel = (enum enxlog_loglevel)slot->header.loglevel,
+            .func = slot->header.func,
+            .line = slot->header.line,
+            .time = time,
+            .message = slot->message,
+            .length = slot->header.length
+        };
+
+        batch.count++;
+        tail++;
+        written++;
+    }
+
+    if (batch.count) {
+        enxlog_deferred_flush(&batch, &release, tail);
+    }
+
+    __atomic_store_n(&enxlog_deferred_tail, tail, __ATOMIC_RELAXED);
+
+    uint32_t dropped = __atomic_load_n(&enxlog_deferred_dropped_count, __ATOMIC_RELAXED);
+    if (dropped != enxlog_deferred_reported) {
+        char message[96];
+        int length = snprintf(
+            message,
+            sizeof(message),
+            "%lu entries were dropped because the deferred ring was full",
+            (unsigned long)(uint32_t)(dropped - enxlog_deferred_reported));
+
+        enxlog_lock_acquire(&enxlog_default_instance);
+        enxlog_sinks_write_record(
+            &enxlog_default_instance,
+            enxlog_deferred_logger,
+            LOGLEVEL_WARN,
+            __func__,
+            __LINE__,
+            message,
+            length);
+        enxlog_lock_release(&enxlog_default_instance);
+
+        enxlog_deferred_reported = dropped;
+    }
+
+#ifdef ENXLOG_LATENCY
+    enxlog_latency_log_periodic(enxlog_clock_now());
+#endif
+
+    __atomic_clear(&enxlog_deferred_draining, __ATOMIC_RELEASE);
+
+    return written;
+}
+
+bool enxlog_deferred_pending(void)
+{
+    uint32_t tail = __atomic_load_n(&enxlog_deferred_tail, __ATOMIC_RELAXED);
+    const struct enxlog_deferred_slot *slot = &enxlog_deferred_slots[tail & ENXLOG_DEFERRED_MASK];
+
+    return __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == ENXLOG_DEFERRED_LAP(tail) + 1;
+}
+
+uint32_t enxlog_deferred_dropped(void)
+{
+    return __atomic_load_n(&enxlog_deferred_dropped_count, __ATOMIC_RELAXED);
+}
+
+#ifdef ENXLOG_DEFERRED_IRQ_SAVE
+
+static bool enxlog_deferred_reserve(uint32_t *position)
+{
+    uint32_t state;
+    bool reserved;
+
+    ENXLOG_DEFERRED_IRQ_SAVE(state);
+
+    *position = __atomic_load_n(&enxlog_deferred_head, __ATOMIC_RELAXED);
+    const struct enxlog_deferred_slot *slot = &enxlog_deferred_slots[*position & ENXLOG_DEFERRED_MASK];
+
+    reserved = (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == ENXLOG_DEFERRED_LAP(*position));
+    if (reserved) {
+        __atomic_store_n(&enxlog_deferred_head, *position + 1, __ATOMIC_RELAXED);
+    }
+
+    ENXLOG_DEFERRED_IRQ_RESTORE(state);
+
+    return reserved;
+}
+
+static void enxlog_deferred_drop(void)
+{
+    uint32_t state;
+
+    ENXLOG_DEFERRED_IRQ_SAVE(state);
+    __atomic_store_n(
+        &enxlog_deferred_dropped_count,
+        __atomic_load_n(&enxlog_deferred_dropped_count, __ATOMIC_RELAXED) + 1,
+        __ATOMIC_RELAXED);
+    ENXLOG_DEFERRED_IRQ_RESTORE(state);
+}
+
+#else
+
+static bool enxlog_deferred_reserve(uint32_t *position)
+{
+    uint32_t head = __atomic_load_n(&enxlog_deferred_head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        const struct enxlog_deferred_slot *slot = &enxlog_deferred_slots[head & ENXLOG_DEFERRED_MASK];
+        int32_t difference = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - ENXLOG_DEFERRED_LAP(head));
+
+        if (difference == 0) {
+            // A failed exchange reloads the head
+            if (__atomic_compare_exchange_n(
+                    &enxlog_deferred_head, &head, head + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *position = head;
+                return true;
+            }
+
+        } else if (difference < 0) {
+            // The slot still holds an entry from the previous lap
+            return false;
+
+        } else {
+            head = __atomic_load_n(&enxlog_deferred_head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void enxlog_deferred_drop(void)
+{
+    __atomic_fetch_add(&enxlog_deferred_dropped_count, 1, __ATOMIC_RELAXED);
+}
+
+#endif
+
+static bool enxlog_deferred_write(void *context, const char *ptr, size_t length)
+{
+    struct enxlog_deferred_slot *slot = (struct enxlog_deferred_slot *)context;
+    size_t available = sizeof(slot->message) - slot->header.length;
+
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&slot->message[slot->header.length], ptr, length);
+    slot->header.length += length;
+
+    return true;
+}
+
+static void enxlog_deferred_flush(struct enxlog_batch *batch, uint32_t *release, uint32_t position)
+{
+    enxlog_lock_acquire(batch->instance);
+    enxlog_sinks_write_batch(batch->instance, batch->records, batch->count);
+    enxlog_lock_release(batch->instance);
+
+    batch->count = 0;
+
+#ifdef ENXLOG_LATENCY
+    uint64_t now = enxlog_clock_now();
+#endif
+
+    for (; *release != position; ++*release) {
+        struct enxlog_deferred_slot *slot = &enxlog_deferred_slots[*release & ENXLOG_DEFERRED_MASK];
+
+#ifdef ENXLOG_LATENCY
+        enxlog_latency_record(ENXLOG_LATENCY_END_TO_END, now - slot->header.timestamp);
+#endif
+        __atomic_store_n(&slot->sequence, ENXLOG_DEFERRED_LAP(*release) + ENXLOG_DEFERRED_SLOTS, __ATOMIC_RELEASE);
+    }
+}
@@ -0,0 +1,241 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog_early_buffer.h>
+
+#include "enxlog_internal.h"
+#include "enxlog_record_buffer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+
+/**
+ * Acquires the early buffer spinlock. There is no user lock before
+ * enxlog_init().
+ * @private
+ */
+static void enxlog_early_buffer_lock(void);
+
+/**
+ * Releases the early buffer spinlock
+ * @private
+ */
+static void enxlog_early_buffer_unlock(void);
+
+/**
+ * Formatter output function that appends to the message being captured
+ * @private
+ */
+static bool enxlog_early_buffer_write(void *context, const char *ptr, size_t length);
+
+/**
+ * Adds a buffered record to the batch, if the filter allows it, writing the
+ * batch first if it is full
+ * @private
+ */
+static void enxlog_early_buffer_replay_record(
+    void *context,
+    const struct enxlog_record_header *header,
+    const char *message);
+
+
+/**
+ * The state of a replay
+ * @private
+ */
+struct enxlog_early_buffer_replay_state
+{
+    struct enxlog_batch batch;
+    const struct enxlog_filter *filter;
+};
+
+
+LOGGER(enxlog_early_buffer_logger, "enxlog");
+
+static uint64_t enxlog_early_buffer_storage[ENXLOG_EARLY_BUFFER_SIZE / sizeof(uint64_t)];
+static struct enxlog_record_buffer enxlog_early_buffer_records;
+static char enxlog_early_buffer_message[ENXLOG_EARLY_BUFFER_MAX_MESSAGE];
+static size_t enxlog_early_buffer_message_length;
+static uint64_t enxlog_early_buffer_reported = 0;
+static bool enxlog_early_buffer_locked = false;
+
+
+uint64_t enxlog_early_buffer_dropped(void)
+{
+    enxlog_early_buffer_lock();
+    uint64_t dropped = enxlog_early_buffer_records.dropped;
+    enxlog_early_buffer_unlock();
+
+    return dropped;
+}
+
+bool enxlog_early_buffer_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    enxlog_early_buffer_lock();
+
+    // The last replay runs under this lock after the filter is published
+    if (__atomic_load_n(&enxlog_default_instance.filter, __ATOMIC_ACQUIRE)) {
+        enxlog_early_buffer_unlock();
+        return false;
+    }
+
+    if (enxlog_early_buffer_records.data == NULL) {
+        enxlog_record_buffer_init(
+            &enxlog_early_buffer_records,
+            enxlog_early_buffer_storage,
+            sizeof(enxlog_early_buffer_storage));
+    }
+
+    // Fields are kept as text, as the arguments do not outlive the call
+    enxlog_early_buffer_message_length = 0;
+    enxlog_format_write(cache, format, enxlog_early_buffer_write, NULL, args);
+    enxlog_fields_format(enxlog_early_buffer_write, NULL, args, arg_count);
+
+    struct enxlog_record_header header = {
+        .logger = logger,
+        .func = func,
+        .timestamp = ((uint64_t)now.tv_sec * 1000000ull) + (uint64_t)now.tv_usec,
+        .line = line,
+        .loglevel = loglevel,
+        .length = enxlog_early_buffer_message_length
+    };
+
+    enxlog_record_buffer_push(&enxlog_early_buffer_records, &header, enxlog_early_buffer_message);
+
+    enxlog_early_buffer_unlock();
+
+    return true;
+}
+
+void enxlog_early_buffer_replay(const struct enxlog_filter *filter)
+{
+    enxlog_early_buffer_lock();
+
+    if (enxlog_early_buffer_records.data) {
+        struct enxlog_early_buffer_replay_state state = {
+            .batch = { .instance = &enxlog_default_instance },
+            .filter = filter
+        };
+
+        enxlog_record_buffer_drain(&enxlog_early_buffer_records, enxlog_early_buffer_replay_record, &state);
+        if (state.batch.count) {
+            enxlog_sinks_write_batch(state.batch.instance, state.batch.records, state.batch.count);
+        }
+    }
+
+    // Each replay warns about the entries dropped since the previous one
+    uint64_t dropped = enxlog_early_buffer_records.dropped - enxlog_early_buffer_reported;
+    enxlog_early_buffer_reported = enxlog_early_buffer_records.dropped;
+
+    enxlog_early_buffer_unlock();
+
+    if (dropped) {
+        char message[96];
+        int length = snprintf(
+            message,
+            sizeof(message),
+            "%llu entries logged before enxlog_init() were dropped",
+            (unsigned long long)dropped);
+
+        enxlog_sinks_write_record(
+            &enxlog_default_instance,
+            enxlog_early_buffer_logger,
+            LOGLEVEL_WARN,
+            __func__,
+            __LINE__,
+            message,
+            length);
+    }
+}
+
+static void enxlog_early_buffer_lock(void)
+{
+    while (__atomic_test_and_set(&enxlog_early_buffer_locked, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void enxlog_early_buffer_unlock(void)
+{
+    __atomic_clear(&enxlog_early_buffer_locked, __ATOMIC_RELEASE);
+}
+
+static bool enxlog_early_buffer_write(void *context, const char *ptr, size_t length)
+{
+    size_t available = sizeof(enxlog_early_buffer_message) - enxlog_early_buffer_message_length;
+
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&enxlog_early_buffer_message[enxlog_early_buffer_message_length], ptr, length);
+    enxlog_early_buffer_message_length += length;
+
+    return true;
+}
+
+static void enxlog_early_buffer_replay_record(
+    void *context,
+    const struct enxlog_record_header *header,
+    const char *message)
+{
+    struct enxlog_early_buffer_replay_state *state = (struct enxlog_early_buffer_replay_state *)context;
+    struct enxlog_batch *batch = &state->batch;
+
+    if (!enxlog_filter_allows(batch->instance, state->filter, header->logger, (enum enxlog_loglevel)header->loglevel)) {
+        return;
+    }
+
+    if (batch->count == ENXLOG_BATCH_MAX_RECORDS) {
+        enxlog_sinks_write_batch(batch->instance, batch->records, batch->count);
+        batch->count = 0;
+    }
+
+    // Sinks read the time of the entry through enxlog_entry_time()
+    struct timeval *time = &batch->times[batch->count];
+    time->tv_sec = (time_t)(header->timestamp / 1000000ull);
+    time->tv_usec = (suseconds_t)(header->timestamp % 1000000ull);
+
+    batch->records[batch->count] = (struct enxlog_record) {
+        .logger = header->logger,
+        .loglevel = (enum enxlog_loglevel)header->loglevel,
+        .func = header->func,
+        .line = header->line,
+        .time = time,
+        .message = message,
+        .length = header->length
+    };
+
+    batch->count++;
+}
@@ -0,0 +1,124 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+
+#include "enxlog_internal.h"
+
+#include <string.h>
+
+
+/**
+ * Pre-split format cache state
+ * @private
+ */
+enum enxlog_format_state
+{
+    ENXLOG_FORMAT_EMPTY = 0,
+    ENXLOG_FORMAT_BUSY,
+    ENXLOG_FORMAT_READY,
+    ENXLOG_FORMAT_UNSUPPORTED
+};
+
+/**
+ * Splits a format into the cache. Only the first caller does the work;
+ * callers that race with it format without the cache.
+ * @private
+ */
+static void enxlog_format_split(struct enxlog_format *cache, const char *format);
+
+
+void enxlog_format_write(
+    struct enxlog_format *cache,
+    const char *format,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context,
+    const struct enxtxt_fstr_arg *args)
+{
+    if (cache) {
+        const char *text = __atomic_load_n(&cache->text, __ATOMIC_ACQUIRE);
+
+        if ((text == NULL) && (__atomic_load_n(&cache->state, __ATOMIC_RELAXED) == ENXLOG_FORMAT_EMPTY)) {
+            enxlog_format_split(cache, format);
+            text = __atomic_load_n(&cache->text, __ATOMIC_ACQUIRE);
+        }
+
+        if (text == format) {
+            for (size_t i = 0; i < cache->count; ++i) {
+                if (cache->spans[i].length) {
+                    output_fn(output_fn_context, &text[cache->spans[i].offset], cache->spans[i].length);
+                }
+                args[i].fn_fmt(&args[i], output_fn, output_fn_context);
+            }
+
+            if (cache->spans[cache->count].length) {
+                output_fn(output_fn_context, &text[cache->spans[cache->count].offset], cache->spans[cache->count].length);
+            }
+
+            return;
+        }
+    }
+
+    _enxtxt_fstr_cb(output_fn, output_fn_context, format, args);
+}
+
+static void enxlog_format_split(struct enxlog_format *cache, const char *format)
+{
+    int expected = ENXLOG_FORMAT_EMPTY;
+    if (!__atomic_compare_exchange_n(&cache->state, &expected, ENXLOG_FORMAT_BUSY, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    size_t length = strlen(format);
+    size_t start = 0;
+    size_t count = 0;
+
+    if (length > UINT16_MAX) {
+        __atomic_store_n(&cache->state, ENXLOG_FORMAT_UNSUPPORTED, __ATOMIC_RELAXED);
+        return;
+    }
+
+    for (size_t i = 0; i + 1 < length; ++i) {
+        if ((format[i] != '{') || (format[i + 1] != '}')) {
+            continue;
+        }
+
+        if (count == ENXLOG_FORMAT_MAX_ARGS) {
+            __atomic_store_n(&cache->state, ENXLOG_FORMAT_UNSUPPORTED, __ATOMIC_RELAXED);
+            return;
+        }
+
+        cache->spans[count].offset = (uint16_t)start;
+        cache->spans[count].length = (uint16_t)(i - start);
+        count++;
+
+        start = i + 2;
+        i++;
+    }
+
+    cache->spans[count].offset = (uint16_t)start;
+    cache->spans[count].length = (uint16_t)(length - start);
+    cache->count = (uint8_t)count;
+
+    __atomic_store_n(&cache->state, ENXLOG_FORMAT_READY, __ATOMIC_RELAXED);
+    __atomic_store_n(&cache->text, format, __ATOMIC_RELEASE);
+}
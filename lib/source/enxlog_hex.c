@@ -0,0 +1,290 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog_hex.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+
+/**
+ * The size of the stack buffer output is collected in before it is passed
+ * to the sinks
+ * @private
+ */
+#define ENXLOG_HEX_CHUNK 1024
+
+/**
+ * The longest hexdump line: offset, 16 bytes and the ASCII column
+ * @private
+ */
+#define ENXLOG_HEX_MAX_LINE 80
+
+/**
+ * Writes a buffer as contiguous hex
+ * @private
+ */
+static bool enxlog_hex_write_plain(
+    const uint8_t *ptr,
+    size_t length,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context);
+
+/**
+ * Writes a buffer as hexdump lines
+ * @private
+ */
+static bool enxlog_hex_write_dump(
+    const uint8_t *ptr,
+    size_t length,
+    unsigned int flags,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context);
+
+/**
+ * Formats one hexdump line of up to 16 bytes
+ * @private
+ */
+static size_t enxlog_hex_dump_line(
+    char *line,
+    const uint8_t *ptr,
+    size_t length,
+    size_t offset,
+    unsigned int flags);
+
+
+void enxlog_hex_fmt(
+    const struct enxtxt_fstr_arg *arg,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context)
+{
+    const struct enxlog_hex *hex = (const struct enxlog_hex *)arg->_user;
+    size_t length = (hex->length > hex->limit) ? hex->limit : hex->length;
+    bool result;
+
+    if (hex->flags & ENXLOG_HEX_DUMP) {
+        result = enxlog_hex_write_dump(hex->ptr, length, hex->flags, output_fn, output_fn_context);
+    } else {
+        result = enxlog_hex_write_plain(hex->ptr, length, output_fn, output_fn_context);
+    }
+
+    if (result && (length < hex->length)) {
+        char text[64];
+        int text_length = snprintf(text, sizeof(text), "%s... (%zu bytes)",
+            (hex->flags & ENXLOG_HEX_DUMP) ? "\n" : "", hex->length);
+        output_fn(output_fn_context, text, text_length);
+    }
+}
+
+void enxlog_hex_encode(char *output, const void *input, size_t length)
+{
+    static const char digits[] = "0123456789abcdef";
+    const uint8_t *ptr = (const uint8_t *)input;
+    size_t i = 0;
+
+    // Each nibble becomes '0' + nibble, plus the distance to 'a' for nibbles above 9
+#if defined(__AVX2__)
+    const __m256i mask_256 = _mm256_set1_epi8(0x0f);
+    const __m256i nine_256 = _mm256_set1_epi8(9);
+    const __m256i zero_256 = _mm256_set1_epi8('0');
+    const __m256i letter_256 = _mm256_set1_epi8('a' - '0' - 10);
+
+    while (i + 32 <= length) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)&ptr[i]);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask_256);
+        __m256i low = _mm256_and_si256(bytes, mask_256);
+
+        // Unpacking works within 128 bit lanes, so a holds bytes 0-7 and 16-23
+        __m256i a = _mm256_unpacklo_epi8(high, low);
+        __m256i b = _mm256_unpackhi_epi8(high, low);
+        a = _mm256_add_epi8(_mm256_add_epi8(a, zero_256), _mm256_and_si256(_mm256_cmpgt_epi8(a, nine_256), letter_256));
+        b = _mm256_add_epi8(_mm256_add_epi8(b, zero_256), _mm256_and_si256(_mm256_cmpgt_epi8(b, nine_256), letter_256));
+
+        _mm256_storeu_si256((__m256i *)&output[2 * i], _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)&output[2 * i + 32], _mm256_permute2x128_si256(a, b, 0x31));
+        i += 32;
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+
+    while (i + 16 <= length) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)&ptr[i]);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+        __m128i low = _mm_and_si128(bytes, mask);
+
+        __m128i a = _mm_unpacklo_epi8(high, low);
+        __m128i b = _mm_unpackhi_epi8(high, low);
+        a = _mm_add_epi8(_mm_add_epi8(a, zero), _mm_and_si128(_mm_cmpgt_epi8(a, nine), letter));
+        b = _mm_add_epi8(_mm_add_epi8(b, zero), _mm_and_si128(_mm_cmpgt_epi8(b, nine), letter));
+
+        _mm_storeu_si128((__m128i *)&output[2 * i], a);
+        _mm_storeu_si128((__m128i *)&output[2 * i + 16], b);
+        i += 16;
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t mask = vdupq_n_u8(0x0f);
+    const uint8x16_t nine = vdupq_n_u8(9);
+    const uint8x16_t zero = vdupq_n_u8('0');
+    const uint8x16_t letter = vdupq_n_u8('a' - '0' - 10);
+
+    while (i + 16 <= length) {
+        uint8x16_t bytes = vld1q_u8(&ptr[i]);
+        uint8x16x2_t nibbles;
+        nibbles.val[0] = vshrq_n_u8(bytes, 4);
+        nibbles.val[1] = vandq_u8(bytes, mask);
+        nibbles.val[0] = vaddq_u8(vaddq_u8(nibbles.val[0], zero), vandq_u8(vcgtq_u8(nibbles.val[0], nine), letter));
+        nibbles.val[1] = vaddq_u8(vaddq_u8(nibbles.val[1], zero), vandq_u8(vcgtq_u8(nibbles.val[1], nine), letter));
+
+        // Interleaves the high and low digits
+        vst2q_u8((uint8_t *)&output[2 * i], nibbles);
+        i += 16;
+    }
+#endif
+
+    while (i < length) {
+        output[2 * i] = digits[ptr[i] >> 4];
+        output[2 * i + 1] = digits[ptr[i] & 0x0f];
+        i++;
+    }
+}
+
+static bool enxlog_hex_write_plain(
+    const uint8_t *ptr,
+    size_t length,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context)
+{
+    char buffer[ENXLOG_HEX_CHUNK];
+
+    while (length) {
+        size_t count = (length < sizeof(buffer) / 2) ? length : sizeof(buffer) / 2;
+
+        enxlog_hex_encode(buffer, ptr, count);
+        if (!output_fn(output_fn_context, buffer, 2 * count)) {
+            return false;
+        }
+
+        ptr += count;
+        length -= count;
+    }
+
+    return true;
+}
+
+static bool enxlog_hex_write_dump(
+    const uint8_t *ptr,
+    size_t length,
+    unsigned int flags,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context)
+{
+    char buffer[ENXLOG_HEX_CHUNK];
+    size_t buffer_length = 0;
+    size_t offset = 0;
+
+    while (offset < length) {
+        size_t count = (length - offset < 16) ? length - offset : 16;
+
+        // Lines are separated, not terminated, so that the sink ends the entry
+        if (offset) {
+            buffer[buffer_length++] = '\n';
+        }
+
+        buffer_length += enxlog_hex_dump_line(&buffer[buffer_length], &ptr[offset], count, offset, flags);
+        offset += count;
+
+        if (buffer_length + ENXLOG_HEX_MAX_LINE + 1 > sizeof(buffer)) {
+            if (!output_fn(output_fn_context, buffer, buffer_length)) {
+                return false;
+            }
+            buffer_length = 0;
+        }
+    }
+
+    return (buffer_length == 0) || output_fn(output_fn_context, buffer, buffer_length);
+}
+
+static size_t enxlog_hex_dump_line(
+    char *line,
+    const uint8_t *ptr,
+    size_t length,
+    size_t offset,
+    unsigned int flags)
+{
+    char hex[32];
+    char *out = line;
+
+    if (flags & ENXLOG_HEX_OFFSET) {
+        uint8_t offset_bytes[4] = {
+            (uint8_t)(offset >> 24), (uint8_t)(offset >> 16), (uint8_t)(offset >> 8), (uint8_t)offset
+        };
+
+        enxlog_hex_encode(out, offset_bytes, sizeof(offset_bytes));
+        out[8] = ' ';
+        out[9] = ' ';
+        out += 10;
+    }
+
+    enxlog_hex_encode(hex, ptr, length);
+
+    // Short lines are padded only when the ASCII column follows
+    size_t columns = (flags & ENXLOG_HEX_ASCII) ? 16 : length;
+    for (size_t i = 0; i < columns; ++i) {
+        if (i) {
+            *out++ = ' ';
+        }
+        if (i == 8) {
+            *out++ = ' ';
+        }
+
+        if (i < length) {
+            *out++ = hex[2 * i];
+            *out++ = hex[2 * i + 1];
+        } else {
+            *out++ = ' ';
+            *out++ = ' ';
+        }
+    }
+
+    if (flags & ENXLOG_HEX_ASCII) {
+        *out++ = ' ';
+        *out++ = ' ';
+        *out++ = '|';
+        for (size_t i = 0; i < length; ++i) {
+            *out++ = ((ptr[i] >= 0x20) && (ptr[i] < 0x7f)) ? (char)ptr[i] : '.';
+        }
+        *out++ = '|';
+    }
+
+    return out - line;
+}
@@ -0,0 +1,385 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_INTERNAL_H
+#define ENXLOG_INTERNAL_H
+
+#include <enx/log/enxlog.h>
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/cdefs.h>
+#include <sys/time.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds
+ * @private
+ */
+static inline uint64_t enxlog_clock_now(void)
+{
+    struct timespec ts;
+
+#ifdef CLOCK_MONOTONIC_RAW
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Returns the instance a logger writes to
+ * @private
+ */
+static inline const struct enxlog_instance *enxlog_logger_instance(const struct enxlog_logger *logger)
+{
+    return logger->instance ? logger->instance : &enxlog_default_instance;
+}
+
+/**
+ * @brief Recomputes enxlog_enabled_loglevel after the filter or the tail
+ * buffer changes
+ * @private
+ */
+void enxlog_enabled_loglevel_update(void);
+
+/**
+ * @brief Formats a message, using the pre-split format when one is given
+ *
+ * The format is split into the cache on first use. Formats that do not fit
+ * the cache, or that differ from the one the cache was filled with, are
+ * passed to the formatter.
+ * @private
+ */
+void enxlog_format_write(
+    struct enxlog_format *cache,
+    const char *format,
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context,
+    const struct enxtxt_fstr_arg *args);
+
+/**
+ * @brief Returns true if the filter emits entries of the given loglevel for
+ * the logger
+ *
+ * The filter need not be published in the instance yet.
+ *
+ * @private
+ */
+bool enxlog_filter_allows(
+    const struct enxlog_instance *instance,
+    const struct enxlog_filter *filter,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel);
+
+/**
+ * @brief The time returned by enxlog_entry_time() while a buffered record is
+ * written, or NULL to read the clock
+ * @private
+ */
+extern _Thread_local const struct timeval *enxlog_entry_replay_time;
+
+/**
+ * @brief Acquires the lock of an instance, if it has one
+ * @private
+ */
+void enxlog_lock_acquire(const struct enxlog_instance *instance);
+
+/**
+ * @brief Releases the lock of an instance, if it has one
+ * @private
+ */
+void enxlog_lock_release(const struct enxlog_instance *instance);
+
+/**
+ * @brief Writes a formatted record to all sinks of an instance
+ *
+ * Used to deliver records that were formatted earlier. The caller must hold
+ * the lock of the instance.
+ *
+ * @private
+ */
+void enxlog_sinks_write_record(
+    const struct enxlog_instance *instance,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    const char *message,
+    size_t length);
+
+/**
+ * @brief The number of buffered records that are collected into one batch
+ * @private
+ */
+#define ENXLOG_BATCH_MAX_RECORDS 64
+
+/**
+ * @brief Buffered records that are collected before they are written
+ * @private
+ */
+struct enxlog_batch
+{
+    const struct enxlog_instance *instance;
+    size_t count;
+    struct enxlog_record records[ENXLOG_BATCH_MAX_RECORDS];
+    struct timeval times[ENXLOG_BATCH_MAX_RECORDS];
+};
+
+/**
+ * @brief Writes a batch of formatted records to all sinks of an instance
+ *
+ * Sinks with a batch callback receive all records in one call. The other
+ * sinks receive them one by one. The caller must hold the lock of the
+ * instance.
+ *
+ * @private
+ */
+void enxlog_sinks_write_batch(
+    const struct enxlog_instance *instance,
+    const struct enxlog_record *records,
+    size_t count);
+
+/**
+ * @brief Formats the structured fields in an argument array as " key=value"
+ * @private
+ */
+void enxlog_fields_format(
+    enxtxt_fstr_output_function_t output_fn,
+    void *output_fn_context,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count);
+
+#ifdef ENXLOG_PROFILER
+
+/**
+ * @brief Records a log macro invocation against its call site
+ * @private
+ */
+void enxlog_profiler_record(
+    const struct enxlog_logger *logger,
+    const char *func,
+    unsigned int line,
+    bool emitted,
+    size_t bytes,
+    uint64_t time_ns);
+
+/**
+ * @brief Writes the shutdown report, if one was requested
+ * @private
+ */
+void enxlog_profiler_shutdown(void);
+
+#endif
+
+#ifdef ENXLOG_LATENCY
+
+/**
+ * @brief Records the latency of a log entry written by the synchronous path
+ *
+ * The sinks have returned by the time this is called, so the producer and
+ * end to end latencies are the same.
+ *
+ * @param start The timestamp taken when the log call was made
+ * @private
+ */
+void enxlog_latency_record_entry(uint64_t start);
+
+/**
+ * @brief Logs the histograms if the periodic logging interval has passed
+ *
+ * Called for every entry, whichever path writes it to the sinks.
+ *
+ * @param now The current timestamp
+ * @private
+ */
+void enxlog_latency_log_periodic(uint64_t now);
+
+#endif
+
+#ifdef ENXLOG_EARLY_BUFFER
+
+/**
+ * @brief Formats an entry logged before enxlog_init() into the early buffer
+ * @returns false if the filter of the default instance has been published
+ * meanwhile, in which case the entry must be logged directly
+ * @private
+ */
+bool enxlog_early_buffer_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count);
+
+/**
+ * @brief Writes the entries in the early buffer that pass the filter to the
+ * sinks of the default instance
+ *
+ * The caller must hold the lock of the default instance. The filter is
+ * passed, as it is published only after the first replay.
+ *
+ * @private
+ */
+void enxlog_early_buffer_replay(const struct enxlog_filter *filter);
+
+#endif
+
+#ifdef ENXLOG_TAIL_BUFFER
+
+/**
+ * @brief The most verbose loglevel captured in the tail buffer
+ * @private
+ */
+extern enum enxlog_loglevel enxlog_tail_buffer_capture_loglevel;
+
+/**
+ * @brief The least verbose loglevel that flushes the tail buffer
+ * @private
+ */
+extern enum enxlog_loglevel enxlog_tail_buffer_trigger_loglevel;
+
+/**
+ * @brief Formats an entry into the tail buffer of the calling thread
+ * @private
+ */
+void enxlog_tail_buffer_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count);
+
+/**
+ * @brief Writes the tail buffer of the calling thread to the sinks
+ *
+ * Each record goes to the instance of its logger. The caller must not hold
+ * any instance lock, as the lock of each instance is taken only while its
+ * records are written, so that replays on different instances never wait
+ * for each other.
+ *
+ * @private
+ */
+void enxlog_tail_buffer_replay(void);
+
+#endif
+
+#ifdef ENXLOG_ASYNC
+
+/**
+ * @brief Returns true if entries logged by the calling thread are queued
+ * for the consumer thread
+ * @private
+ */
+bool enxlog_async_active(void);
+
+/**
+ * @brief Formats an entry into the ring of the calling thread
+ * @param length Set to the length of the formatted message
+ * @returns false if the async mode is not running
+ * @private
+ */
+bool enxlog_async_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count,
+    size_t *length);
+
+/**
+ * @brief Queues formatted records in the ring of the calling thread
+ *
+ * The records keep the timestamps at which they were logged, so that the
+ * consumer writes them with that time.
+ *
+ * @param timestamps The enxlog_clock_now() timestamp of each record
+ * @returns The number of records queued, which is less than the count if
+ * the async mode stopped
+ * @private
+ */
+size_t enxlog_async_write_batch(
+    const struct enxlog_record *records,
+    const uint64_t *timestamps,
+    size_t count);
+
+#endif
+
+#ifdef ENXLOG_DEFERRED
+
+/**
+ * @brief Formats an entry into the next free slot of the deferred ring, or
+ * drops it if the ring is full
+ * @returns The length of the formatted message, or 0 if it was dropped
+ * @private
+ */
+size_t enxlog_deferred_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count);
+
+#endif
+
+#ifdef ENXLOG_POOL
+
+/**
+ * @brief Allocates a block aligned to 64 bytes from the pool, or from the
+ * heap if the pool is not initialized and LIBENXLOG_NO_HEAP is off
+ * @returns NULL if the block does not fit in the pool
+ * @private
+ */
+void *enxlog_pool_alloc(size_t size);
+
+/**
+ * @brief Returns a block allocated with enxlog_pool_alloc()
+ * @private
+ */
+void enxlog_pool_free(void *ptr);
+
+/**
+ * @brief Returns several blocks, taking the pool lock once
+ * @private
+ */
+void enxlog_pool_free_batch(void *const *blocks, size_t count);
+
+#endif
+
+__END_DECLS
+
+#endif
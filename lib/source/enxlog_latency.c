@@ -0,0 +1,246 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_latency.h>
+
+#include "enxlog_internal.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define ENXLOG_HISTOGRAM_SUB_BUCKETS (1u << ENXLOG_HISTOGRAM_SUB_BUCKET_BITS)
+#define ENXLOG_HISTOGRAM_MAX_VALUE ((1ull << (ENXLOG_HISTOGRAM_MAX_BITS + 1)) - 1)
+
+/**
+ * Histogram storage
+ * @private
+ */
+struct enxlog_histogram_storage
+{
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t min;
+    atomic_uint_fast64_t max;
+    atomic_uint_fast64_t buckets[ENXLOG_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * Returns the bucket index for a value
+ * @private
+ */
+static size_t enxlog_histogram_index(uint64_t value);
+
+/**
+ * Returns the highest value equivalent to a bucket
+ * @private
+ */
+static uint64_t enxlog_histogram_bucket_value(size_t index);
+
+/**
+ * Logs the percentiles of a histogram
+ * @private
+ */
+static void enxlog_latency_log_histogram(const char *name, enum enxlog_latency_histogram_id id);
+
+
+LOGGER(enxlog_latency_logger, "enxlog", "latency");
+
+static struct enxlog_histogram_storage enxlog_latency_histograms[ENXLOG_LATENCY_HISTOGRAM_COUNT] = {
+    { .min = UINT64_MAX },
+    { .min = UINT64_MAX }
+};
+static atomic_uint_fast64_t enxlog_latency_interval_ns = 0;
+static atomic_uint_fast64_t enxlog_latency_last_log = 0;
+
+
+uint64_t enxlog_latency_now(void)
+{
+    return enxlog_clock_now();
+}
+
+void enxlog_latency_record(enum enxlog_latency_histogram_id id, uint64_t value_ns)
+{
+    struct enxlog_histogram_storage *storage = &enxlog_latency_histograms[id];
+
+    atomic_fetch_add_explicit(&storage->buckets[enxlog_histogram_index(value_ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&storage->count, 1, memory_order_relaxed);
+
+    uint64_t current = atomic_load_explicit(&storage->min, memory_order_relaxed);
+    while ((value_ns < current) &&
+           !atomic_compare_exchange_weak_explicit(&storage->min, &current, value_ns, memory_order_relaxed, memory_order_relaxed)) {
+    }
+
+    current = atomic_load_explicit(&storage->max, memory_order_relaxed);
+    while ((value_ns > current) &&
+           !atomic_compare_exchange_weak_explicit(&storage->max, &current, value_ns, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void enxlog_latency_snapshot(enum enxlog_latency_histogram_id id, struct enxlog_histogram *histogram)
+{
+    struct enxlog_histogram_storage *storage = &enxlog_latency_histograms[id];
+    size_t i;
+
+    histogram->count = 0;
+    for (i=0; i < ENXLOG_HISTOGRAM_BUCKETS; ++i) {
+        histogram->buckets[i] = atomic_load_explicit(&storage->buckets[i], memory_order_relaxed);
+        histogram->count += histogram->buckets[i];
+    }
+
+    histogram->min = histogram->count ? atomic_load_explicit(&storage->min, memory_order_relaxed) : 0;
+    histogram->max = atomic_load_explicit(&storage->max, memory_order_relaxed);
+}
+
+void enxlog_latency_reset(void)
+{
+    size_t id;
+    size_t i;
+
+    for (id=0; id < ENXLOG_LATENCY_HISTOGRAM_COUNT; ++id) {
+        struct enxlog_histogram_storage *storage = &enxlog_latency_histograms[id];
+
+        for (i=0; i < ENXLOG_HISTOGRAM_BUCKETS; ++i) {
+            atomic_store_explicit(&storage->buckets[i], 0, memory_order_relaxed);
+        }
+
+        atomic_store_explicit(&storage->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&storage->min, UINT64_MAX, memory_order_relaxed);
+        atomic_store_explicit(&storage->max, 0, memory_order_relaxed);
+    }
+}
+
+void enxlog_latency_log_interval(uint32_t interval_ms)
+{
+    atomic_store_explicit(&enxlog_latency_last_log, enxlog_clock_now(), memory_order_relaxed);
+    atomic_store_explicit(&enxlog_latency_interval_ns, (uint64_t)interval_ms * 1000000ull, memory_order_relaxed);
+}
+
+uint64_t enxlog_histogram_percentile(const struct enxlog_histogram *histogram, double percentile)
+{
+    uint64_t target;
+    uint64_t cumulative = 0;
+    size_t i;
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    target = (uint64_t)((percentile / 100.0) * (double)histogram->count + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+
+    for (i=0; i < ENXLOG_HISTOGRAM_BUCKETS; ++i) {
+        cumulative += histogram->buckets[i];
+        if (cumulative >= target) {
+            uint64_t value = enxlog_histogram_bucket_value(i);
+            return (value < histogram->max) ? value : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+void enxlog_latency_record_entry(uint64_t start)
+{
+    uint64_t now = enxlog_clock_now();
+
+    enxlog_latency_record(ENXLOG_LATENCY_END_TO_END, now - start);
+    enxlog_latency_record(ENXLOG_LATENCY_PRODUCER, now - start);
+
+    enxlog_latency_log_periodic(now);
+}
+
+void enxlog_latency_log_periodic(uint64_t now)
+{
+    uint64_t interval = atomic_load_explicit(&enxlog_latency_interval_ns, memory_order_relaxed);
+    if (interval == 0) {
+        return;
+    }
+
+    uint64_t last = atomic_load_explicit(&enxlog_latency_last_log, memory_order_relaxed);
+    if ((now - last) < interval) {
+        return;
+    }
+
+    // Only one thread logs per interval
+    if (!atomic_compare_exchange_strong_explicit(&enxlog_latency_last_log, &last, now, memory_order_relaxed, memory_order_relaxed)) {
+        return;
+    }
+
+    enxlog_latency_log_histogram("producer", ENXLOG_LATENCY_PRODUCER);
+    enxlog_latency_log_histogram("end_to_end", ENXLOG_LATENCY_END_TO_END);
+}
+
+static void enxlog_latency_log_histogram(const char *name, enum enxlog_latency_histogram_id id)
+{
+    struct enxlog_histogram histogram;
+    char text[160];
+
+    enxlog_latency_snapshot(id, &histogram);
+
+    snprintf(
+        text,
+        sizeof(text),
+        "count=%llu min=%lluns p50=%lluns p99=%lluns p999=%lluns max=%lluns",
+        (unsigned long long)histogram.count,
+        (unsigned long long)histogram.min,
+        (unsigned long long)enxlog_histogram_percentile(&histogram, 50.0),
+        (unsigned long long)enxlog_histogram_percentile(&histogram, 99.0),
+        (unsigned long long)enxlog_histogram_percentile(&histogram, 99.9),
+        (unsigned long long)histogram.max);
+
+    // The log macros use __FUNCTION__, which is not available in ISO C
+    const struct enxtxt_fstr_arg args[] = { f_str(name), f_str(text) };
+    enxlog_log(enxlog_latency_logger, LOGLEVEL_INFO, __func__, __LINE__, "{}: {}", args, 2);
+}
+
+static size_t enxlog_histogram_index(uint64_t value)
+{
+    if (value > ENXLOG_HISTOGRAM_MAX_VALUE) {
+        value = ENXLOG_HISTOGRAM_MAX_VALUE;
+    }
+
+    if (value < ENXLOG_HISTOGRAM_SUB_BUCKETS) {
+        return (size_t)value;
+    }
+
+    // The top ENXLOG_HISTOGRAM_SUB_BUCKET_BITS + 1 bits select the bucket
+    unsigned int msb = 63 - __builtin_clzll(value);
+    unsigned int shift = msb - ENXLOG_HISTOGRAM_SUB_BUCKET_BITS;
+
+    return ((size_t)shift << ENXLOG_HISTOGRAM_SUB_BUCKET_BITS) + (size_t)(value >> shift);
+}
+
+static uint64_t enxlog_histogram_bucket_value(size_t index)
+{
+    if (index < ENXLOG_HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+
+    unsigned int shift = (index >> ENXLOG_HISTOGRAM_SUB_BUCKET_BITS) - 1;
+    uint64_t mantissa = (index & (ENXLOG_HISTOGRAM_SUB_BUCKETS - 1)) + ENXLOG_HISTOGRAM_SUB_BUCKETS;
+
+    return ((mantissa + 1) << shift) - 1;
+}
@@ -0,0 +1,480 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#include <enx/log/enxlog_pattern.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+
+
+/**
+ * Fixed colors, indexed by the offset of a color operation
+ * @private
+ */
+enum enxlog_pattern_color
+{
+    ENXLOG_PATTERN_COLOR_RESET = 0,
+    ENXLOG_PATTERN_COLOR_GRAY,
+    ENXLOG_PATTERN_COLOR_BROWN,
+    ENXLOG_PATTERN_COLOR_RED,
+    ENXLOG_PATTERN_COLOR_YELLOW
+};
+
+static const char *enxlog_pattern_colors[] = {
+    "\x1b[0m",
+    "\x1b[90m",
+    "\x1b[33m",
+    "\x1b[31m",
+    "\x1b[93m"
+};
+
+const struct enxlog_pattern enxlog_pattern_default = {
+    .ops = {
+        { .type = ENXLOG_PATTERN_OP_TIMESTAMP },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 1, .offset = 0 },
+        { .type = ENXLOG_PATTERN_OP_LEVEL },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 1, .offset = 0 },
+        { .type = ENXLOG_PATTERN_OP_LOGGER },
+        { .type = ENXLOG_PATTERN_OP_FUNC },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 1, .offset = 1 },
+        { .type = ENXLOG_PATTERN_OP_LINE },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 2, .offset = 1 }
+    },
+    .count = 9,
+    .literals = " : ",
+    .literals_length = 3
+};
+
+const struct enxlog_pattern enxlog_pattern_default_color = {
+    .ops = {
+        { .type = ENXLOG_PATTERN_OP_COLOR, .offset = ENXLOG_PATTERN_COLOR_GRAY },
+        { .type = ENXLOG_PATTERN_OP_TIMESTAMP },
+        { .type = ENXLOG_PATTERN_OP_COLOR, .offset = ENXLOG_PATTERN_COLOR_RESET },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 1, .offset = 0 },
+        { .type = ENXLOG_PATTERN_OP_LEVEL_COLOR },
+        { .type = ENXLOG_PATTERN_OP_LEVEL },
+        { .type = ENXLOG_PATTERN_OP_COLOR, .offset = ENXLOG_PATTERN_COLOR_RESET },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 1, .offset = 0 },
+        { .type = ENXLOG_PATTERN_OP_COLOR, .offset = ENXLOG_PATTERN_COLOR_BROWN },
+        { .type = ENXLOG_PATTERN_OP_LOGGER },
+        { .type = ENXLOG_PATTERN_OP_FUNC },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 1, .offset = 1 },
+        { .type = ENXLOG_PATTERN_OP_LINE },
+        { .type = ENXLOG_PATTERN_OP_COLOR, .offset = ENXLOG_PATTERN_COLOR_RESET },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 2, .offset = 1 }
+    },
+    .count = 15,
+    .literals = " : ",
+    .literals_length = 3
+};
+
+#define ENXLOG_PATTERN_SPACES "                "
+
+/**
+ * A newline followed by the spaces written to indent continuation lines
+ * @private
+ */
+static const char enxlog_pattern_indent[] =
+    "\n"
+    ENXLOG_PATTERN_SPACES ENXLOG_PATTERN_SPACES ENXLOG_PATTERN_SPACES ENXLOG_PATTERN_SPACES
+    ENXLOG_PATTERN_SPACES ENXLOG_PATTERN_SPACES ENXLOG_PATTERN_SPACES ENXLOG_PATTERN_SPACES;
+
+#define ENXLOG_PATTERN_INDENT_SPACES (sizeof(enxlog_pattern_indent) - 2)
+
+
+/**
+ * Output position while a header is formatted
+ * @private
+ */
+struct enxlog_pattern_output
+{
+    char *buffer;
+    size_t size;
+    size_t length;
+    size_t width;
+};
+
+/**
+ * Appends text that takes up space on screen
+ * @private
+ */
+static void enxlog_pattern_put(struct enxlog_pattern_output *output, const char *ptr, size_t length);
+
+/**
+ * Appends a color escape sequence
+ * @private
+ */
+static void enxlog_pattern_put_color(struct enxlog_pattern_output *output, enum enxlog_pattern_color color);
+
+/**
+ * Appends an unsigned decimal number
+ * @private
+ */
+static void enxlog_pattern_put_uint(struct enxlog_pattern_output *output, unsigned long value);
+
+/**
+ * Appends the local time, formatting the date and time of day only when the
+ * second changes
+ * @private
+ */
+static void enxlog_pattern_put_timestamp(struct enxlog_pattern_output *output);
+
+/**
+ * Writes a newline and indents the next line by width spaces
+ * @private
+ */
+static void enxlog_pattern_write_indent(size_t width, enxlog_pattern_write_fn_t write, void *stream);
+
+/**
+ * Adds a literal operation
+ * @private
+ */
+static bool enxlog_pattern_add_literal(struct enxlog_pattern *pattern, const char *ptr, size_t length);
+
+/**
+ * Adds an operation without literal text
+ * @private
+ */
+static bool enxlog_pattern_add_op(struct enxlog_pattern *pattern, enum enxlog_pattern_op_type type, uint16_t offset);
+
+
+bool enxlog_pattern_compile(struct enxlog_pattern *pattern, const char *text)
+{
+    memset(pattern, 0, sizeof(struct enxlog_pattern));
+
+    while (*text) {
+        if (*text != '%') {
+            size_t length = strcspn(text, "%");
+            if (!enxlog_pattern_add_literal(pattern, text, length)) {
+                return false;
+            }
+            text += length;
+            continue;
+        }
+
+        bool result;
+        switch (text[1]) {
+            case 'T': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_TIMESTAMP, 0); break;
+            case 'L': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_LEVEL, 0); break;
+            case 'N': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_LOGGER, 0); break;
+            case 'F': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_FUNC, 0); break;
+            case 'l': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_LINE, 0); break;
+            case 't': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_THREAD, 0); break;
+            case 'C': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_LEVEL_COLOR, 0); break;
+            case 'g': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_COLOR, ENXLOG_PATTERN_COLOR_GRAY); break;
+            case 'b': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_COLOR, ENXLOG_PATTERN_COLOR_BROWN); break;
+            case 'c': result = enxlog_pattern_add_op(pattern, ENXLOG_PATTERN_OP_COLOR, ENXLOG_PATTERN_COLOR_RESET); break;
+            case '%': result = enxlog_pattern_add_literal(pattern, "%", 1); break;
+            default: result = false; break;
+        }
+
+        if (!result) {
+            return false;
+        }
+
+        text += 2;
+    }
+
+    return true;
+}
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_pattern *enxlog_pattern_create(const char *text)
+{
+    struct enxlog_pattern *pattern = malloc(sizeof(struct enxlog_pattern));
+
+    if (pattern && !enxlog_pattern_compile(pattern, text)) {
+        free(pattern);
+        pattern = NULL;
+    }
+
+    return pattern;
+}
+
+void enxlog_pattern_destroy(struct enxlog_pattern *pattern)
+{
+    free(pattern);
+}
+
+#endif
+
+size_t enxlog_pattern_format(
+    const struct enxlog_pattern *pattern,
+    char *buffer,
+    size_t size,
+    size_t *width,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_pattern_output output = {
+        .buffer = buffer,
+        .size = size,
+        .length = 0,
+        .width = 0
+    };
+
+    for (size_t i = 0; i < pattern->count; ++i) {
+        const struct enxlog_pattern_op *op = &pattern->ops[i];
+
+        switch (op->type) {
+            case ENXLOG_PATTERN_OP_LITERAL:
+                enxlog_pattern_put(&output, &pattern->literals[op->offset], op->length);
+                break;
+
+            case ENXLOG_PATTERN_OP_COLOR:
+                enxlog_pattern_put_color(&output, op->offset);
+                break;
+
+            case ENXLOG_PATTERN_OP_LEVEL_COLOR:
+                switch (loglevel) {
+                    case LOGLEVEL_ERROR: enxlog_pattern_put_color(&output, ENXLOG_PATTERN_COLOR_RED); break;
+                    case LOGLEVEL_WARN:  enxlog_pattern_put_color(&output, ENXLOG_PATTERN_COLOR_YELLOW); break;
+                    default: enxlog_pattern_put_color(&output, ENXLOG_PATTERN_COLOR_RESET); break;
+                }
+                break;
+
+            case ENXLOG_PATTERN_OP_TIMESTAMP:
+                enxlog_pattern_put_timestamp(&output);
+                break;
+
+            case ENXLOG_PATTERN_OP_LEVEL:
+                switch (loglevel) {
+                    case LOGLEVEL_ERROR: enxlog_pattern_put(&output, "-- ERROR --", 11); break;
+                    case LOGLEVEL_WARN:  enxlog_pattern_put(&output, "-- WARN  --", 11); break;
+                    case LOGLEVEL_INFO:  enxlog_pattern_put(&output, "-- INFO  --", 11); break;
+                    case LOGLEVEL_DEBUG: enxlog_pattern_put(&output, "-- DEBUG --", 11); break;
+                    case LOGLEVEL_TRACE: enxlog_pattern_put(&output, "-- TRACE --", 11); break;
+                    default : break;
+                }
+                break;
+
+            case ENXLOG_PATTERN_OP_LOGGER:
+                if (logger->path) {
+                    enxlog_pattern_put(&output, logger->path, logger->path_length);
+                } else {
+                    for (const char **name_part = logger->name; *name_part; ++name_part) {
+                        enxlog_pattern_put(&output, *name_part, strlen(*name_part));
+                        enxlog_pattern_put(&output, "::", 2);
+                    }
+                }
+                break;
+
+            case ENXLOG_PATTERN_OP_FUNC:
+                enxlog_pattern_put(&output, func, strlen(func));
+                break;
+
+            case ENXLOG_PATTERN_OP_LINE:
+                enxlog_pattern_put_uint(&output, line);
+                break;
+
+            case ENXLOG_PATTERN_OP_THREAD: {
+                static _Thread_local unsigned long thread_id = 0;
+                if (thread_id == 0) {
+#ifdef SYS_gettid
+                    thread_id = syscall(SYS_gettid);
+#else
+                    thread_id = getpid();
+#endif
+                }
+                enxlog_pattern_put_uint(&output, thread_id);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    if (width) {
+        *width = output.width;
+    }
+
+    return output.length;
+}
+
+void enxlog_pattern_write_message(
+    const struct enxlog_pattern *pattern,
+    size_t width,
+    const char *ptr,
+    size_t length,
+    enxlog_pattern_write_fn_t write,
+    void *stream)
+{
+    enum enxlog_pattern_newline mode = pattern ? pattern->newline : ENXLOG_PATTERN_NEWLINE_INDENT;
+    const char *end = ptr + length;
+    const char *newline;
+
+    if (mode == ENXLOG_PATTERN_NEWLINE_RAW) {
+        write(stream, ptr, length);
+        return;
+    }
+
+    while ((newline = memchr(ptr, '\n', end - ptr)) != NULL) {
+        if (newline > ptr) {
+            write(stream, ptr, newline - ptr);
+        }
+
+        if (mode == ENXLOG_PATTERN_NEWLINE_ESCAPE) {
+            write(stream, "\\n", 2);
+        } else {
+            enxlog_pattern_write_indent(width, write, stream);
+        }
+
+        ptr = newline + 1;
+    }
+
+    if (ptr < end) {
+        write(stream, ptr, end - ptr);
+    }
+}
+
+void enxlog_pattern_write_file(void *stream, const char *ptr, size_t length)
+{
+    fwrite(ptr, 1, length, (FILE *)stream);
+}
+
+static void enxlog_pattern_write_indent(size_t width, enxlog_pattern_write_fn_t write, void *stream)
+{
+    size_t count = (width < ENXLOG_PATTERN_INDENT_SPACES) ? width : ENXLOG_PATTERN_INDENT_SPACES;
+    write(stream, enxlog_pattern_indent, count + 1);
+    width -= count;
+
+    // Headers wider than the indent block
+    while (width) {
+        count = (width < ENXLOG_PATTERN_INDENT_SPACES) ? width : ENXLOG_PATTERN_INDENT_SPACES;
+        write(stream, enxlog_pattern_indent + 1, count);
+        width -= count;
+    }
+}
+
+static void enxlog_pattern_put(struct enxlog_pattern_output *output, const char *ptr, size_t length)
+{
+    size_t available = output->size - output->length;
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&output->buffer[output->length], ptr, length);
+    output->length += length;
+    output->width += length;
+}
+
+static void enxlog_pattern_put_color(struct enxlog_pattern_output *output, enum enxlog_pattern_color color)
+{
+    const char *sequence = enxlog_pattern_colors[color];
+    size_t width = output->width;
+
+    enxlog_pattern_put(output, sequence, strlen(sequence));
+    output->width = width;
+}
+
+static void enxlog_pattern_put_uint(struct enxlog_pattern_output *output, unsigned long value)
+{
+    char digits[24];
+    size_t count = 0;
+
+    do {
+        digits[sizeof(digits) - 1 - count] = '0' + (value % 10);
+        value /= 10;
+        count++;
+    } while (value);
+
+    enxlog_pattern_put(output, &digits[sizeof(digits) - count], count);
+}
+
+static void enxlog_pattern_put_timestamp(struct enxlog_pattern_output *output)
+{
+    static _Thread_local time_t cached_second = -1;
+    static _Thread_local char cached_text[32];
+    static _Thread_local size_t cached_length;
+
+    struct timeval curTime;
+    enxlog_entry_time(&curTime);
+
+    if (curTime.tv_sec != cached_second) {
+        struct tm timeinfo;
+        localtime_r(&curTime.tv_sec, &timeinfo);
+
+        cached_length = strftime(cached_text, sizeof(cached_text), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        cached_second = curTime.tv_sec;
+    }
+
+    int milli = curTime.tv_usec / 1000;
+    char fraction[4] = {
+        '.',
+        '0' + (milli / 100),
+        '0' + ((milli / 10) % 10),
+        '0' + (milli % 10)
+    };
+
+    enxlog_pattern_put(output, cached_text, cached_length);
+    enxlog_pattern_put(output, fraction, sizeof(fraction));
+}
+
+static bool enxlog_pattern_add_literal(struct enxlog_pattern *pattern, const char *ptr, size_t length)
+{
+    // Long literals are split, as an operation holds at most 255 bytes
+    while (length) {
+        size_t count = (length > UINT8_MAX) ? UINT8_MAX : length;
+
+        if ((pattern->count == ENXLOG_PATTERN_MAX_OPS) ||
+            (pattern->literals_length + count > ENXLOG_PATTERN_MAX_LITERALS)) {
+            return false;
+        }
+
+        memcpy(&pattern->literals[pattern->literals_length], ptr, count);
+
+        struct enxlog_pattern_op *op = &pattern->ops[pattern->count++];
+        op->type = ENXLOG_PATTERN_OP_LITERAL;
+        op->length = count;
+        op->offset = pattern->literals_length;
+
+        pattern->literals_length += count;
+        ptr += count;
+        length -= count;
+    }
+
+    return true;
+}
+
+static bool enxlog_pattern_add_op(struct enxlog_pattern *pattern, enum enxlog_pattern_op_type type, uint16_t offset)
+{
+    if (pattern->count == ENXLOG_PATTERN_MAX_OPS) {
+        return false;
+    }
+
+    struct enxlog_pattern_op *op = &pattern->ops[pattern->count++];
+    op->type = type;
+    op->length = 0;
+    op->offset = offset;
+
+    return true;
+}
@@ -0,0 +1,649 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <enx/log/enxlog_pool.h>
+
+#include "enxlog_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+
+/**
+ * Alignment of the block region
+ * @private
+ */
+#define ENXLOG_POOL_ALIGN 64
+
+/**
+ * The smallest block size
+ * @private
+ */
+#define ENXLOG_POOL_UNIT ((size_t)1 << ENXLOG_POOL_MIN_BLOCK_BITS)
+
+/**
+ * The number of block sizes
+ * @private
+ */
+#define ENXLOG_POOL_CLASSES (64 - ENXLOG_POOL_MIN_BLOCK_BITS)
+
+/**
+ * The huge page size that mapped pools are rounded up to
+ * @private
+ */
+#define ENXLOG_POOL_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/**
+ * Block table entries. The entry of the first unit of a block holds its
+ * state and size class; the entries of the other units are zero.
+ * @private
+ */
+#define ENXLOG_POOL_USED 0x40
+#define ENXLOG_POOL_FREE 0x80
+#define ENXLOG_POOL_SMALL (ENXLOG_POOL_USED | ENXLOG_POOL_FREE)
+#define ENXLOG_POOL_CLASS_MASK 0x3f
+
+/**
+ * The largest object that shares a block with other objects of its size,
+ * rather than taking a block of its own
+ * @private
+ */
+#define ENXLOG_POOL_SMALL_MAX (ENXLOG_POOL_UNIT / 4)
+
+/**
+ * The number of small object sizes, from ENXLOG_POOL_ALIGN up to
+ * ENXLOG_POOL_SMALL_MAX
+ * @private
+ */
+#define ENXLOG_POOL_SMALL_CLASSES ((ENXLOG_POOL_MIN_BLOCK_BITS > 7) ? (ENXLOG_POOL_MIN_BLOCK_BITS - 7) : 1)
+
+/**
+ * Free list links, kept in the free block itself
+ * @private
+ */
+struct enxlog_pool_free_block
+{
+    struct enxlog_pool_free_block *next;
+    struct enxlog_pool_free_block *prev;
+};
+
+/**
+ * Header of a block that is shared by small objects of one size. The
+ * objects follow the header; freed objects are linked through their first
+ * word.
+ * @private
+ */
+struct enxlog_pool_small_block
+{
+    struct enxlog_pool_small_block *next;
+    struct enxlog_pool_small_block *prev;
+    void *free;
+    size_t used;
+    size_t carved;
+};
+
+/**
+ * Pool state
+ * @private
+ */
+struct enxlog_pool
+{
+    char *base;
+    size_t capacity;
+    void *mapping;
+    size_t mapped_size;
+    uint8_t *table;
+    struct enxlog_pool_free_block *free[ENXLOG_POOL_CLASSES];
+    // Shared blocks that have room for another object
+    struct enxlog_pool_small_block *small[ENXLOG_POOL_SMALL_CLASSES];
+    struct enxlog_pool_stats stats;
+};
+
+/**
+ * Acquires the pool spinlock. Blocks are only allocated when a thread
+ * creates its buffer, so the lock is rarely contended.
+ * @private
+ */
+static void enxlog_pool_lock(void);
+
+/**
+ * Releases the pool spinlock
+ * @private
+ */
+static void enxlog_pool_unlock(void);
+
+/**
+ * Sets up the block table at the start of the memory and the blocks after
+ * it
+ * @returns false if the memory is too small for one block
+ * @private
+ */
+static bool enxlog_pool_setup(char *memory, size_t size, size_t mapped_size, bool hugepages);
+
+/**
+ * Returns the block at an offset to the free list of its size class. The
+ * caller must hold the lock.
+ * @private
+ */
+static void enxlog_pool_push(size_t offset, unsigned int size_class);
+
+/**
+ * Removes the block at an offset from the free list of its size class. The
+ * caller must hold the lock.
+ * @private
+ */
+static void enxlog_pool_unlink(size_t offset, unsigned int size_class);
+
+/**
+ * Carves a new block from the unused end of the pool, aligned to its size.
+ * The space skipped for the alignment goes to the free lists. The caller
+ * must hold the lock.
+ * @returns The offset of the block, or the capacity if it does not fit
+ * @private
+ */
+static size_t enxlog_pool_carve(unsigned int size_class);
+
+/**
+ * Takes a block of a size class from the free lists, splitting a larger
+ * one, or carves a new one. The caller must hold the lock.
+ * @returns The offset of the block, or the capacity if it does not fit
+ * @private
+ */
+static size_t enxlog_pool_take_block(unsigned int size_class);
+
+/**
+ * Takes a small object from a shared block, starting a new shared block if
+ * none has room. The caller must hold the lock.
+ * @returns NULL if there is no room for a new shared block
+ * @private
+ */
+static void *enxlog_pool_take_small(size_t size);
+
+/**
+ * Returns a block or a small object to the pool. The caller must hold the
+ * lock.
+ * @private
+ */
+static void enxlog_pool_release(void *ptr);
+
+/**
+ * Returns a block to the pool, merging it with its free buddies. The
+ * caller must hold the lock.
+ * @private
+ */
+static void enxlog_pool_release_block(size_t offset, unsigned int size_class);
+
+/**
+ * Returns a small object to its shared block, and the block to the pool
+ * once it holds no objects. The caller must hold the lock.
+ * @private
+ */
+static void enxlog_pool_release_small(size_t offset, unsigned int small_class);
+
+/**
+ * Removes a shared block from the list of shared blocks with room. The
+ * caller must hold the lock.
+ * @private
+ */
+static void enxlog_pool_small_unlink(struct enxlog_pool_small_block *block, unsigned int small_class);
+
+
+static struct enxlog_pool enxlog_pool_state;
+static bool enxlog_pool_locked = false;
+
+
+bool enxlog_pool_init(size_t capacity)
+{
+    size_t size = (capacity + ENXLOG_POOL_HUGEPAGE_SIZE - 1) & ~(size_t)(ENXLOG_POOL_HUGEPAGE_SIZE - 1);
+    bool hugepages = true;
+    void *mapping = MAP_FAILED;
+
+    if (capacity == 0) {
+        return false;
+    }
+
+#ifdef MAP_HUGETLB
+    mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+    // Huge pages are only available if the administrator reserved them
+    if (mapping == MAP_FAILED) {
+        hugepages = false;
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+
+#ifdef MADV_HUGEPAGE
+        madvise(mapping, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    enxlog_pool_lock();
+
+    if (enxlog_pool_state.base || !enxlog_pool_setup(mapping, size, size, hugepages)) {
+        enxlog_pool_unlock();
+        munmap(mapping, size);
+        return false;
+    }
+
+    enxlog_pool_unlock();
+
+    return true;
+}
+
+bool enxlog_pool_init_static(void *storage, size_t size)
+{
+    bool result = false;
+
+    enxlog_pool_lock();
+
+    if (enxlog_pool_state.base == NULL) {
+        result = enxlog_pool_setup(storage, size, 0, false);
+    }
+
+    enxlog_pool_unlock();
+
+    return result;
+}
+
+bool enxlog_pool_shutdown(void)
+{
+    enxlog_pool_lock();
+
+    if ((enxlog_pool_state.base == NULL) || enxlog_pool_state.stats.used) {
+        enxlog_pool_unlock();
+        return false;
+    }
+
+    if (enxlog_pool_state.mapped_size) {
+        munmap(enxlog_pool_state.mapping, enxlog_pool_state.mapped_size);
+    }
+
+    memset(&enxlog_pool_state, 0, sizeof(enxlog_pool_state));
+
+    enxlog_pool_unlock();
+
+    return true;
+}
+
+void enxlog_pool_snapshot(struct enxlog_pool_stats *stats)
+{
+    enxlog_pool_lock();
+    *stats = enxlog_pool_state.stats;
+    enxlog_pool_unlock();
+}
+
+void *enxlog_pool_alloc(size_t size)
+{
+    unsigned int size_class = 0;
+    void *ptr = NULL;
+
+    enxlog_pool_lock();
+
+    if (enxlog_pool_state.base == NULL) {
+        enxlog_pool_unlock();
+
+#ifdef ENXLOG_NO_HEAP
+        return NULL;
+#else
+        // Without a pool the blocks come from the heap, with the same
+        // alignment
+        return aligned_alloc(ENXLOG_POOL_ALIGN, (size + ENXLOG_POOL_ALIGN - 1) & ~(size_t)(ENXLOG_POOL_ALIGN - 1));
+#endif
+    }
+
+    // Small objects, like the async ring headers, would waste most of a
+    // block of their own
+    if ((ENXLOG_POOL_SMALL_MAX >= ENXLOG_POOL_ALIGN) && (size <= ENXLOG_POOL_SMALL_MAX)) {
+        ptr = enxlog_pool_take_small(size);
+
+    } else {
+        // The block table is kept apart from the blocks, so a power of two
+        // request takes a block of exactly its size
+        while ((size_class < ENXLOG_POOL_CLASSES - 1) && ((ENXLOG_POOL_UNIT << size_class) < size)) {
+            size_class++;
+        }
+
+        size_t offset = enxlog_pool_take_block(size_class);
+        if (offset < enxlog_pool_state.capacity) {
+            enxlog_pool_state.table[offset >> ENXLOG_POOL_MIN_BLOCK_BITS] = ENXLOG_POOL_USED | size_class;
+            ptr = enxlog_pool_state.base + offset;
+        }
+    }
+
+    if (ptr) {
+        enxlog_pool_state.stats.allocations++;
+    } else {
+        enxlog_pool_state.stats.failures++;
+    }
+
+    enxlog_pool_unlock();
+
+    return ptr;
+}
+
+void enxlog_pool_free(void *ptr)
+{
+    enxlog_pool_free_batch(&ptr, 1);
+}
+
+void enxlog_pool_free_batch(void *const *blocks, size_t count)
+{
+    enxlog_pool_lock();
+
+    for (size_t i = 0; i < count; ++i) {
+        enxlog_pool_release(blocks[i]);
+    }
+
+    enxlog_pool_unlock();
+}
+
+static void enxlog_pool_lock(void)
+{
+    while (__atomic_test_and_set(&enxlog_pool_locked, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void enxlog_pool_unlock(void)
+{
+    __atomic_clear(&enxlog_pool_locked, __ATOMIC_RELEASE);
+}
+
+static bool enxlog_pool_setup(char *memory, size_t size, size_t mapped_size, bool hugepages)
+{
+    uintptr_t start = ((uintptr_t)memory + ENXLOG_POOL_ALIGN - 1) & ~(uintptr_t)(ENXLOG_POOL_ALIGN - 1);
+    size_t skipped = start - (uintptr_t)memory;
+
+    if (size < skipped) {
+        return false;
+    }
+
+    // One table byte per unit, in front of the units
+    size_t units = (size - skipped) / (ENXLOG_POOL_UNIT + 1);
+    size_t table_size = (units + ENXLOG_POOL_ALIGN - 1) & ~(size_t)(ENXLOG_POOL_ALIGN - 1);
+
+    while (units && (table_size + (units << ENXLOG_POOL_MIN_BLOCK_BITS) > size - skipped)) {
+        units--;
+        table_size = (units + ENXLOG_POOL_ALIGN - 1) & ~(size_t)(ENXLOG_POOL_ALIGN - 1);
+    }
+
+    if (units == 0) {
+        return false;
+    }
+
+    memset(&enxlog_pool_state, 0, sizeof(enxlog_pool_state));
+
+    enxlog_pool_state.table = (uint8_t *)start;
+    enxlog_pool_state.base = (char *)start + table_size;
+    enxlog_pool_state.capacity = units << ENXLOG_POOL_MIN_BLOCK_BITS;
+    enxlog_pool_state.mapping = memory;
+    enxlog_pool_state.mapped_size = mapped_size;
+    enxlog_pool_state.stats.capacity = enxlog_pool_state.capacity;
+    enxlog_pool_state.stats.hugepages = hugepages;
+
+    memset(enxlog_pool_state.table, 0, units);
+
+    return true;
+}
+
+static void enxlog_pool_push(size_t offset, unsigned int size_class)
+{
+    struct enxlog_pool_free_block *block = (struct enxlog_pool_free_block *)(enxlog_pool_state.base + offset);
+
+    block->prev = NULL;
+    block->next = enxlog_pool_state.free[size_class];
+    if (block->next) {
+        block->next->prev = block;
+    }
+
+    enxlog_pool_state.free[size_class] = block;
+    enxlog_pool_state.table[offset >> ENXLOG_POOL_MIN_BLOCK_BITS] = ENXLOG_POOL_FREE | size_class;
+}
+
+static void enxlog_pool_unlink(size_t offset, unsigned int size_class)
+{
+    struct enxlog_pool_free_block *block = (struct enxlog_pool_free_block *)(enxlog_pool_state.base + offset);
+
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        enxlog_pool_state.free[size_class] = block->next;
+    }
+
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+
+    enxlog_pool_state.table[offset >> ENXLOG_POOL_MIN_BLOCK_BITS] = 0;
+}
+
+static size_t enxlog_pool_carve(unsigned int size_class)
+{
+    size_t block_size = ENXLOG_POOL_UNIT << size_class;
+    size_t carved = enxlog_pool_state.stats.carved;
+    size_t offset = (carved + block_size - 1) & ~(block_size - 1);
+
+    if ((offset < carved) || (offset > enxlog_pool_state.capacity) || (enxlog_pool_state.capacity - offset < block_size)) {
+        return enxlog_pool_state.capacity;
+    }
+
+    // The gap is split into the largest aligned blocks that fit
+    while (carved < offset) {
+        unsigned int gap_class = 0;
+
+        while (((carved & ((ENXLOG_POOL_UNIT << (gap_class + 1)) - 1)) == 0) &&
+               (carved + (ENXLOG_POOL_UNIT << (gap_class + 1)) <= offset)) {
+            gap_class++;
+        }
+
+        enxlog_pool_push(carved, gap_class);
+        carved += ENXLOG_POOL_UNIT << gap_class;
+    }
+
+    enxlog_pool_state.stats.carved = offset + block_size;
+
+    return offset;
+}
+
+static size_t enxlog_pool_take_block(unsigned int size_class)
+{
+    unsigned int search;
+    size_t offset;
+
+    // A free block of the size, or a larger one that is split in halves
+    for (search = size_class; (search < ENXLOG_POOL_CLASSES) && (enxlog_pool_state.free[search] == NULL); ++search) {
+    }
+
+    if (search < ENXLOG_POOL_CLASSES) {
+        offset = (size_t)((char *)enxlog_pool_state.free[search] - enxlog_pool_state.base);
+        enxlog_pool_unlink(offset, search);
+
+        while (search > size_class) {
+            search--;
+            enxlog_pool_push(offset + (ENXLOG_POOL_UNIT << search), search);
+        }
+
+    } else {
+        offset = enxlog_pool_carve(size_class);
+        if (offset >= enxlog_pool_state.capacity) {
+            return offset;
+        }
+    }
+
+    enxlog_pool_state.stats.used += ENXLOG_POOL_UNIT << size_class;
+    if (enxlog_pool_state.stats.used > enxlog_pool_state.stats.peak) {
+        enxlog_pool_state.stats.peak = enxlog_pool_state.stats.used;
+    }
+
+    return offset;
+}
+
+static void *enxlog_pool_take_small(size_t size)
+{
+    unsigned int small_class = 0;
+
+    while ((size_t)ENXLOG_POOL_ALIGN << small_class < size) {
+        small_class++;
+    }
+
+    size_t object_size = (size_t)ENXLOG_POOL_ALIGN << small_class;
+    struct enxlog_pool_small_block *block = enxlog_pool_state.small[small_class];
+
+    if (block == NULL) {
+        size_t offset = enxlog_pool_take_block(0);
+        if (offset >= enxlog_pool_state.capacity) {
+            return NULL;
+        }
+
+        block = (struct enxlog_pool_small_block *)(enxlog_pool_state.base + offset);
+        block->next = NULL;
+        block->prev = NULL;
+        block->free = NULL;
+        block->used = 0;
+        // The objects keep the block alignment
+        block->carved = ENXLOG_POOL_ALIGN;
+
+        enxlog_pool_state.small[small_class] = block;
+        enxlog_pool_state.table[offset >> ENXLOG_POOL_MIN_BLOCK_BITS] = ENXLOG_POOL_SMALL | small_class;
+    }
+
+    void *object = block->free;
+    if (object) {
+        block->free = *(void **)object;
+    } else {
+        object = (char *)block + block->carved;
+        block->carved += object_size;
+    }
+
+    block->used++;
+
+    if ((block->free == NULL) && (block->carved + object_size > ENXLOG_POOL_UNIT)) {
+        enxlog_pool_small_unlink(block, small_class);
+    }
+
+    return object;
+}
+
+static void enxlog_pool_release(void *ptr)
+{
+    char *base = enxlog_pool_state.base;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    // Blocks allocated before the pool was initialized are on the heap
+    if ((base == NULL) || ((char *)ptr < base) || ((char *)ptr >= base + enxlog_pool_state.capacity)) {
+#ifndef ENXLOG_NO_HEAP
+        free(ptr);
+#endif
+        return;
+    }
+
+    size_t offset = (size_t)((char *)ptr - base);
+    uint8_t entry = enxlog_pool_state.table[offset >> ENXLOG_POOL_MIN_BLOCK_BITS];
+
+    if ((entry & ENXLOG_POOL_SMALL) == ENXLOG_POOL_SMALL) {
+        enxlog_pool_release_small(offset, entry & ENXLOG_POOL_CLASS_MASK);
+
+    } else if (entry & ENXLOG_POOL_USED) {
+        enxlog_pool_release_block(offset, entry & ENXLOG_POOL_CLASS_MASK);
+    }
+}
+
+static void enxlog_pool_release_block(size_t offset, unsigned int size_class)
+{
+    enxlog_pool_state.stats.used -= ENXLOG_POOL_UNIT << size_class;
+    enxlog_pool_state.table[offset >> ENXLOG_POOL_MIN_BLOCK_BITS] = 0;
+
+    // Merge with the buddy for as long as it is a free block of the same
+    // size
+    while (size_class < ENXLOG_POOL_CLASSES - 1) {
+        size_t buddy = offset ^ (ENXLOG_POOL_UNIT << size_class);
+
+        if ((buddy >= enxlog_pool_state.stats.carved) ||
+            (enxlog_pool_state.table[buddy >> ENXLOG_POOL_MIN_BLOCK_BITS] != (ENXLOG_POOL_FREE | size_class))) {
+            break;
+        }
+
+        enxlog_pool_unlink(buddy, size_class);
+
+        if (buddy < offset) {
+            offset = buddy;
+        }
+        size_class++;
+    }
+
+    enxlog_pool_push(offset, size_class);
+}
+
+static void enxlog_pool_release_small(size_t offset, unsigned int small_class)
+{
+    size_t block_offset = offset & ~(ENXLOG_POOL_UNIT - 1);
+    size_t object_size = (size_t)ENXLOG_POOL_ALIGN << small_class;
+    struct enxlog_pool_small_block *block = (struct enxlog_pool_small_block *)(enxlog_pool_state.base + block_offset);
+    void *object = enxlog_pool_state.base + offset;
+
+    if (offset == block_offset) {
+        return;
+    }
+
+    // A full block is not on the list of blocks with room
+    if ((block->free == NULL) && (block->carved + object_size > ENXLOG_POOL_UNIT)) {
+        block->prev = NULL;
+        block->next = enxlog_pool_state.small[small_class];
+        if (block->next) {
+            block->next->prev = block;
+        }
+
+        enxlog_pool_state.small[small_class] = block;
+    }
+
+    *(void **)object = block->free;
+    block->free = object;
+    block->used--;
+
+    if (block->used == 0) {
+        enxlog_pool_small_unlink(block, small_class);
+        enxlog_pool_release_block(block_offset, 0);
+    }
+}
+
+static void enxlog_pool_small_unlink(struct enxlog_pool_small_block *block, unsigned int small_class)
+{
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        enxlog_pool_state.small[small_class] = block->next;
+    }
+
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+
+    block->next = NULL;
+    block->prev = NULL;
+}
@@ -0,0 +1,314 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog_profiler.h>
+
+#include "enxlog_internal.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+enum enxlog_profiler_entry_state
+{
+    ENXLOG_PROFILER_ENTRY_EMPTY = 0,
+    ENXLOG_PROFILER_ENTRY_BUSY,
+    ENXLOG_PROFILER_ENTRY_READY
+};
+
+/**
+ * Call site table entry
+ * @private
+ */
+struct enxlog_profiler_entry
+{
+    atomic_int state;
+    const struct enxlog_logger *logger;
+    const char *func;
+    unsigned int line;
+    atomic_uint_fast64_t invocations;
+    atomic_uint_fast64_t records;
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t time_ns;
+};
+
+/**
+ * Finds or creates the table entry for a call site
+ * @private
+ */
+static struct enxlog_profiler_entry *enxlog_profiler_find(
+    const struct enxlog_logger *logger,
+    const char *func,
+    unsigned int line);
+
+/**
+ * Returns the value of a site statistic
+ * @private
+ */
+static uint64_t enxlog_profiler_site_value(
+    const struct enxlog_profiler_site *site,
+    enum enxlog_profiler_sort_key sort_key);
+
+static int enxlog_profiler_compare_bytes(const void *lhs, const void *rhs);
+static int enxlog_profiler_compare_records(const void *lhs, const void *rhs);
+static int enxlog_profiler_compare_invocations(const void *lhs, const void *rhs);
+static int enxlog_profiler_compare_time(const void *lhs, const void *rhs);
+
+
+static struct enxlog_profiler_entry enxlog_profiler_table[ENXLOG_PROFILER_MAX_SITES];
+static atomic_uint_fast64_t enxlog_profiler_dropped = 0;
+static FILE *enxlog_profiler_shutdown_file = NULL;
+static enum enxlog_profiler_sort_key enxlog_profiler_shutdown_sort_key = ENXLOG_PROFILER_SORT_BYTES;
+
+
+void enxlog_profiler_record(
+    const struct enxlog_logger *logger,
+    const char *func,
+    unsigned int line,
+    bool emitted,
+    size_t bytes,
+    uint64_t time_ns)
+{
+    struct enxlog_profiler_entry *entry = enxlog_profiler_find(logger, func, line);
+    if (entry == NULL) {
+        return;
+    }
+
+    atomic_fetch_add_explicit(&entry->invocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&entry->time_ns, time_ns, memory_order_relaxed);
+
+    if (emitted) {
+        atomic_fetch_add_explicit(&entry->records, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&entry->bytes, bytes, memory_order_relaxed);
+    }
+}
+
+void enxlog_profiler_shutdown(void)
+{
+    if (enxlog_profiler_shutdown_file) {
+        enxlog_profiler_report(enxlog_profiler_shutdown_file, enxlog_profiler_shutdown_sort_key);
+    }
+}
+
+size_t enxlog_profiler_snapshot(
+    struct enxlog_profiler_site *sites,
+    size_t max_sites,
+    enum enxlog_profiler_sort_key sort_key)
+{
+    struct enxlog_profiler_site *all = malloc(sizeof(struct enxlog_profiler_site) * ENXLOG_PROFILER_MAX_SITES);
+    size_t count = 0;
+    size_t i;
+
+    if (all == NULL) {
+        return 0;
+    }
+
+    for (i=0; i < ENXLOG_PROFILER_MAX_SITES; ++i) {
+        struct enxlog_profiler_entry *entry = &enxlog_profiler_table[i];
+        if (atomic_load_explicit(&entry->state, memory_order_acquire) != ENXLOG_PROFILER_ENTRY_READY) {
+            continue;
+        }
+
+        all[count].logger = entry->logger;
+        all[count].func = entry->func;
+        all[count].line = entry->line;
+        all[count].invocations = atomic_load_explicit(&entry->invocations, memory_order_relaxed);
+        all[count].records = atomic_load_explicit(&entry->records, memory_order_relaxed);
+        all[count].bytes = atomic_load_explicit(&entry->bytes, memory_order_relaxed);
+        all[count].time_ns = atomic_load_explicit(&entry->time_ns, memory_order_relaxed);
+        count++;
+    }
+
+    switch (sort_key) {
+        case ENXLOG_PROFILER_SORT_RECORDS:     qsort(all, count, sizeof(*all), enxlog_profiler_compare_records); break;
+        case ENXLOG_PROFILER_SORT_INVOCATIONS: qsort(all, count, sizeof(*all), enxlog_profiler_compare_invocations); break;
+        case ENXLOG_PROFILER_SORT_TIME:        qsort(all, count, sizeof(*all), enxlog_profiler_compare_time); break;
+        default:                               qsort(all, count, sizeof(*all), enxlog_profiler_compare_bytes); break;
+    }
+
+    if (count > max_sites) {
+        count = max_sites;
+    }
+
+    memcpy(sites, all, sizeof(struct enxlog_profiler_site) * count);
+    free(all);
+
+    return count;
+}
+
+void enxlog_profiler_report(FILE *file, enum enxlog_profiler_sort_key sort_key)
+{
+    struct enxlog_profiler_site *sites = malloc(sizeof(struct enxlog_profiler_site) * ENXLOG_PROFILER_MAX_SITES);
+    size_t count;
+    size_t i;
+
+    if (sites == NULL) {
+        return;
+    }
+
+    count = enxlog_profiler_snapshot(sites, ENXLOG_PROFILER_MAX_SITES, sort_key);
+
+    fprintf(file, "%12s %12s %14s %12s  %s\n", "invocations", "records", "bytes", "time_us", "site");
+
+    for (i=0; i < count; ++i) {
+        const struct enxlog_profiler_site *site = &sites[i];
+
+        fprintf(
+            file,
+            "%12llu %12llu %14llu %12llu  ",
+            (unsigned long long)site->invocations,
+            (unsigned long long)site->records,
+            (unsigned long long)site->bytes,
+            (unsigned long long)(site->time_ns / 1000));
+
+        if (site->logger->path) {
+            fwrite(site->logger->path, 1, site->logger->path_length, file);
+        } else {
+            for (const char **name_part = site->logger->name; *name_part; ++name_part) {
+                fprintf(file, "%s::", *name_part);
+            }
+        }
+        fprintf(file, "%s:%u\n", site->func, site->line);
+    }
+
+    if (atomic_load_explicit(&enxlog_profiler_dropped, memory_order_relaxed)) {
+        fprintf(
+            file,
+            "%llu invocations from untracked call sites\n",
+            (unsigned long long)atomic_load_explicit(&enxlog_profiler_dropped, memory_order_relaxed));
+    }
+
+    fflush(file);
+    free(sites);
+}
+
+void enxlog_profiler_report_on_shutdown(FILE *file, enum enxlog_profiler_sort_key sort_key)
+{
+    enxlog_profiler_shutdown_file = file;
+    enxlog_profiler_shutdown_sort_key = sort_key;
+}
+
+uint64_t enxlog_profiler_dropped_sites(void)
+{
+    return atomic_load_explicit(&enxlog_profiler_dropped, memory_order_relaxed);
+}
+
+void enxlog_profiler_reset(void)
+{
+    size_t i;
+
+    for (i=0; i < ENXLOG_PROFILER_MAX_SITES; ++i) {
+        struct enxlog_profiler_entry *entry = &enxlog_profiler_table[i];
+        atomic_store_explicit(&entry->invocations, 0, memory_order_relaxed);
+        atomic_store_explicit(&entry->records, 0, memory_order_relaxed);
+        atomic_store_explicit(&entry->bytes, 0, memory_order_relaxed);
+        atomic_store_explicit(&entry->time_ns, 0, memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&enxlog_profiler_dropped, 0, memory_order_relaxed);
+}
+
+static struct enxlog_profiler_entry *enxlog_profiler_find(
+    const struct enxlog_logger *logger,
+    const char *func,
+    unsigned int line)
+{
+    uintptr_t hash = ((uintptr_t)func * 31u) ^ ((uintptr_t)logger * 17u) ^ (line * 2654435761u);
+    size_t index = hash % ENXLOG_PROFILER_MAX_SITES;
+    size_t probe;
+
+    for (probe = 0; probe < ENXLOG_PROFILER_MAX_SITES; ++probe) {
+        struct enxlog_profiler_entry *entry = &enxlog_profiler_table[index];
+        int state = atomic_load_explicit(&entry->state, memory_order_acquire);
+
+        // Claim an empty slot
+        if (state == ENXLOG_PROFILER_ENTRY_EMPTY) {
+            int expected = ENXLOG_PROFILER_ENTRY_EMPTY;
+            if (atomic_compare_exchange_strong_explicit(
+                    &entry->state,
+                    &expected,
+                    ENXLOG_PROFILER_ENTRY_BUSY,
+                    memory_order_acquire,
+                    memory_order_acquire)) {
+
+                entry->logger = logger;
+                entry->func = func;
+                entry->line = line;
+                atomic_store_explicit(&entry->state, ENXLOG_PROFILER_ENTRY_READY, memory_order_release);
+                return entry;
+            }
+
+            state = expected;
+        }
+
+        // Another thread is claiming this slot
+        while (state == ENXLOG_PROFILER_ENTRY_BUSY) {
+            state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        }
+
+        if ((entry->func == func) && (entry->line == line) && (entry->logger == logger)) {
+            return entry;
+        }
+
+        index = (index + 1) % ENXLOG_PROFILER_MAX_SITES;
+    }
+
+    atomic_fetch_add_explicit(&enxlog_profiler_dropped, 1, memory_order_relaxed);
+    return NULL;
+}
+
+static uint64_t enxlog_profiler_site_value(
+    const struct enxlog_profiler_site *site,
+    enum enxlog_profiler_sort_key sort_key)
+{
+    switch (sort_key) {
+        case ENXLOG_PROFILER_SORT_RECORDS:     return site->records;
+        case ENXLOG_PROFILER_SORT_INVOCATIONS: return site->invocations;
+        case ENXLOG_PROFILER_SORT_TIME:        return site->time_ns;
+        default:                               return site->bytes;
+    }
+}
+
+#define ENXLOG_PROFILER_COMPARE(_lhs, _rhs, _sort_key)                                                  \
+    ((enxlog_profiler_site_value(_rhs, _sort_key) > enxlog_profiler_site_value(_lhs, _sort_key)) -       \
+     (enxlog_profiler_site_value(_rhs, _sort_key) < enxlog_profiler_site_value(_lhs, _sort_key)))
+
+static int enxlog_profiler_compare_bytes(const void *lhs, const void *rhs)
+{
+    return ENXLOG_PROFILER_COMPARE(lhs, rhs, ENXLOG_PROFILER_SORT_BYTES);
+}
+
+static int enxlog_profiler_compare_records(const void *lhs, const void *rhs)
+{
+    return ENXLOG_PROFILER_COMPARE(lhs, rhs, ENXLOG_PROFILER_SORT_RECORDS);
+}
+
+static int enxlog_profiler_compare_invocations(const void *lhs, const void *rhs)
+{
+    return ENXLOG_PROFILER_COMPARE(lhs, rhs, ENXLOG_PROFILER_SORT_INVOCATIONS);
+}
+
+static int enxlog_profiler_compare_time(const void *lhs, const void *rhs)
+{
+    return ENXLOG_PROFILER_COMPARE(lhs, rhs, ENXLOG_PROFILER_SORT_TIME);
+}
@@ -0,0 +1,151 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include "enxlog_record_buffer.h"
+
+#include <string.h>
+
+
+/**
+ * Alignment of records in the buffer. Must be a power of two.
+ * @private
+ */
+#define ENXLOG_RECORD_ALIGNMENT _Alignof(struct enxlog_record_header)
+
+/**
+ * Returns the space taken by a record, including padding
+ * @private
+ */
+static size_t enxlog_record_buffer_record_size(uint32_t length);
+
+/**
+ * Removes the oldest record
+ * @private
+ */
+static void enxlog_record_buffer_advance(struct enxlog_record_buffer *buffer);
+
+
+void enxlog_record_buffer_init(struct enxlog_record_buffer *buffer, void *storage, size_t size)
+{
+    buffer->data = (char *)storage;
+    buffer->size = size - (size % ENXLOG_RECORD_ALIGNMENT);
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->count = 0;
+    buffer->dropped = 0;
+}
+
+bool enxlog_record_buffer_push(
+    struct enxlog_record_buffer *buffer,
+    const struct enxlog_record_header *header,
+    const char *message)
+{
+    size_t record_size = enxlog_record_buffer_record_size(header->length);
+
+    if (record_size > buffer->size) {
+        buffer->dropped++;
+        return false;
+    }
+
+    for (;;) {
+        // Records never wrap; the space at the end is skipped instead
+        if (buffer->count == 0) {
+            buffer->head = 0;
+            buffer->tail = 0;
+            break;
+
+        } else if (buffer->head > buffer->tail) {
+            if (buffer->size - buffer->head >= record_size) {
+                break;
+            }
+
+            // Wrap, marking the unused space at the end if a header fits
+            if (buffer->tail >= record_size) {
+                if (buffer->size - buffer->head >= sizeof(struct enxlog_record_header)) {
+                    memset(&buffer->data[buffer->head], 0, sizeof(struct enxlog_record_header));
+                }
+                buffer->head = 0;
+                break;
+            }
+
+        } else if (buffer->tail - buffer->head >= record_size) {
+            break;
+        }
+
+        enxlog_record_buffer_advance(buffer);
+        buffer->dropped++;
+    }
+
+    memcpy(&buffer->data[buffer->head], header, sizeof(struct enxlog_record_header));
+    memcpy(&buffer->data[buffer->head + sizeof(struct enxlog_record_header)], message, header->length);
+
+    buffer->head += record_size;
+    if (buffer->head == buffer->size) {
+        buffer->head = 0;
+    }
+
+    buffer->count++;
+
+    return true;
+}
+
+void enxlog_record_buffer_drain(
+    struct enxlog_record_buffer *buffer,
+    enxlog_record_buffer_callback_t callback,
+    void *context)
+{
+    while (buffer->count) {
+        const struct enxlog_record_header *header = (const struct enxlog_record_header *)&buffer->data[buffer->tail];
+
+        callback(context, header, (const char *)(header + 1));
+        enxlog_record_buffer_advance(buffer);
+    }
+}
+
+void enxlog_record_buffer_clear(struct enxlog_record_buffer *buffer)
+{
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->count = 0;
+}
+
+static size_t enxlog_record_buffer_record_size(uint32_t length)
+{
+    size_t size = sizeof(struct enxlog_record_header) + length;
+    return (size + ENXLOG_RECORD_ALIGNMENT - 1) & ~(ENXLOG_RECORD_ALIGNMENT - 1);
+}
+
+static void enxlog_record_buffer_advance(struct enxlog_record_buffer *buffer)
+{
+    const struct enxlog_record_header *header = (const struct enxlog_record_header *)&buffer->data[buffer->tail];
+
+    buffer->tail += enxlog_record_buffer_record_size(header->length);
+    buffer->count--;
+
+    // Skip the unused space at the end
+    if ((buffer->tail == buffer->size) ||
+        ((buffer->count > 0) && (buffer->tail > buffer->head) &&
+         ((buffer->size - buffer->tail < sizeof(struct enxlog_record_header)) ||
+          (((const struct enxlog_record_header *)&buffer->data[buffer->tail])->logger == NULL)))) {
+        buffer->tail = 0;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#ifndef ENXLOG_RECORD_BUFFER_H
+#define ENXLOG_RECORD_BUFFER_H
+
+#include <enx/log/enxlog.h>
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Header of a record stored in a record buffer
+ *
+ * The message follows the header, padded to the header alignment.
+ */
+struct enxlog_record_header
+{
+    const struct enxlog_logger *logger;
+    const char *func;
+    uint64_t timestamp;
+    uint32_t line;
+    uint32_t loglevel;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+/**
+ * @brief Bounded FIFO of formatted records
+ *
+ * When the buffer is full the oldest records are dropped to make room.
+ * The buffer does not lock; the owner must serialize access.
+ */
+struct enxlog_record_buffer
+{
+    char *data;
+    size_t size;
+    size_t head;
+    size_t tail;
+    size_t count;
+    uint64_t dropped;
+};
+
+/**
+ * @brief Callback invoked for each record in the buffer
+ */
+typedef void (*enxlog_record_buffer_callback_t)(
+    void *context,
+    const struct enxlog_record_header *header,
+    const char *message);
+
+/**
+ * @brief Initializes a record buffer on caller supplied storage
+ */
+void enxlog_record_buffer_init(struct enxlog_record_buffer *buffer, void *storage, size_t size);
+
+/**
+ * @brief Appends a record, dropping the oldest records if required
+ * @returns false if the record is larger than the buffer
+ */
+bool enxlog_record_buffer_push(
+    struct enxlog_record_buffer *buffer,
+    const struct enxlog_record_header *header,
+    const char *message);
+
+/**
+ * @brief Invokes the callback for each record, oldest first, and empties the buffer
+ */
+void enxlog_record_buffer_drain(
+    struct enxlog_record_buffer *buffer,
+    enxlog_record_buffer_callback_t callback,
+    void *context);
+
+/**
+ * @brief Discards all records
+ */
+void enxlog_record_buffer_clear(struct enxlog_record_buffer *buffer);
+
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,341 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog_tail_buffer.h>
+#include <enx/log/enxlog_latency.h>
+
+#include "enxlog_internal.h"
+#include "enxlog_record_buffer.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+
+/**
+ * Per thread tail buffer. Only the records are allocated; the rest is
+ * thread local.
+ * @private
+ */
+struct enxlog_tail_buffer
+{
+    struct enxlog_record_buffer records;
+    size_t capacity;
+    size_t message_length;
+    char message[ENXLOG_TAIL_BUFFER_MAX_MESSAGE];
+};
+
+/**
+ * Returns the calling thread's tail buffer, creating it if required
+ * @private
+ */
+static struct enxlog_tail_buffer *enxlog_tail_buffer_get(void);
+
+/**
+ * Frees the records of a thread's tail buffer when the thread exits
+ * @private
+ */
+static void enxlog_tail_buffer_destroy(void *context);
+
+/**
+ * Creates the thread exit key
+ * @private
+ */
+static void enxlog_tail_buffer_create_key(void);
+
+/**
+ * Formatter output function that appends to the message being captured
+ * @private
+ */
+static bool enxlog_tail_buffer_write(void *context, const char *ptr, size_t length);
+
+/**
+ * Replay state, passed as context to the record buffer callback
+ * @private
+ */
+struct enxlog_tail_buffer_replay_state
+{
+    struct enxlog_batch batch;
+    // Converts the monotonic timestamps of the records to wall clock time
+    int64_t wall_offset;
+    uint64_t timestamps[ENXLOG_BATCH_MAX_RECORDS];
+};
+
+/**
+ * Adds a buffered record to the batch, writing the batch first if it is
+ * full or belongs to another instance
+ * @private
+ */
+static void enxlog_tail_buffer_replay_record(
+    void *context,
+    const struct enxlog_record_header *header,
+    const char *message);
+
+/**
+ * Writes the batched records to the sinks
+ * @private
+ */
+static void enxlog_tail_buffer_replay_batch(struct enxlog_tail_buffer_replay_state *state);
+
+
+enum enxlog_loglevel enxlog_tail_buffer_capture_loglevel = LOGLEVEL_NONE;
+enum enxlog_loglevel enxlog_tail_buffer_trigger_loglevel = LOGLEVEL_NONE;
+
+static size_t enxlog_tail_buffer_capacity = 0;
+static pthread_key_t enxlog_tail_buffer_key;
+static pthread_once_t enxlog_tail_buffer_key_once = PTHREAD_ONCE_INIT;
+static _Thread_local struct enxlog_tail_buffer enxlog_tail_buffer_state;
+static _Thread_local struct enxlog_tail_buffer *enxlog_tail_buffer_thread = NULL;
+
+
+bool enxlog_tail_buffer_enable(
+    enum enxlog_loglevel capture_loglevel,
+    enum enxlog_loglevel trigger_loglevel,
+    size_t capacity)
+{
+    if (capacity < sizeof(struct enxlog_record_header)) {
+        return false;
+    }
+
+    pthread_once(&enxlog_tail_buffer_key_once, enxlog_tail_buffer_create_key);
+
+    enxlog_tail_buffer_capacity = capacity;
+    enxlog_tail_buffer_trigger_loglevel = trigger_loglevel;
+    enxlog_tail_buffer_capture_loglevel = capture_loglevel;
+    enxlog_enabled_loglevel_update();
+
+    return true;
+}
+
+void enxlog_tail_buffer_disable(void)
+{
+    enxlog_tail_buffer_capture_loglevel = LOGLEVEL_NONE;
+    enxlog_tail_buffer_trigger_loglevel = LOGLEVEL_NONE;
+    enxlog_enabled_loglevel_update();
+}
+
+void enxlog_tail_buffer_flush(void)
+{
+    if ((enxlog_tail_buffer_thread == NULL) || (enxlog_tail_buffer_thread->records.count == 0)) {
+        return;
+    }
+
+    enxlog_tail_buffer_replay();
+}
+
+void enxlog_tail_buffer_discard(void)
+{
+    if (enxlog_tail_buffer_thread) {
+        enxlog_record_buffer_clear(&enxlog_tail_buffer_thread->records);
+    }
+}
+
+void enxlog_tail_buffer_capture(
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line,
+    struct enxlog_format *cache,
+    const char *format,
+    const struct enxtxt_fstr_arg *args,
+    size_t arg_count)
+{
+    struct enxlog_tail_buffer *buffer = enxlog_tail_buffer_get();
+    if (buffer == NULL) {
+        return;
+    }
+
+    // Fields are kept as text, as the arguments do not outlive the call
+    buffer->message_length = 0;
+    enxlog_format_write(cache, format, enxlog_tail_buffer_write, buffer, args);
+    enxlog_fields_format(enxlog_tail_buffer_write, buffer, args, arg_count);
+
+    struct enxlog_record_header header = {
+        .logger = logger,
+        .func = func,
+        .timestamp = enxlog_clock_now(),
+        .line = line,
+        .loglevel = loglevel,
+        .length = buffer->message_length
+    };
+
+    enxlog_record_buffer_push(&buffer->records, &header, buffer->message);
+}
+
+void enxlog_tail_buffer_replay(void)
+{
+    struct enxlog_tail_buffer *buffer = enxlog_tail_buffer_thread;
+
+    if (buffer) {
+        // The messages stay in place until the next capture, so they can be
+        // batched while the buffer is drained
+        struct enxlog_tail_buffer_replay_state state = { .batch = { .instance = NULL } };
+        struct timeval now;
+
+        gettimeofday(&now, NULL);
+        state.wall_offset =
+            (((int64_t)now.tv_sec * 1000000000ll) + ((int64_t)now.tv_usec * 1000ll)) - (int64_t)enxlog_clock_now();
+
+        enxlog_record_buffer_drain(&buffer->records, enxlog_tail_buffer_replay_record, &state);
+        enxlog_tail_buffer_replay_batch(&state);
+    }
+}
+
+static struct enxlog_tail_buffer *enxlog_tail_buffer_get(void)
+{
+    struct enxlog_tail_buffer *buffer = enxlog_tail_buffer_thread;
+
+    // Capacity changed
+    if (buffer && (buffer->capacity != enxlog_tail_buffer_capacity)) {
+        pthread_setspecific(enxlog_tail_buffer_key, NULL);
+        enxlog_tail_buffer_destroy(buffer);
+        buffer = NULL;
+    }
+
+    if (buffer == NULL) {
+#ifdef ENXLOG_POOL
+        // A power of two capacity takes a block of exactly that size
+        void *storage = enxlog_pool_alloc(enxlog_tail_buffer_capacity);
+#else
+        void *storage = malloc(enxlog_tail_buffer_capacity);
+#endif
+        if (storage == NULL) {
+            return NULL;
+        }
+
+        buffer = &enxlog_tail_buffer_state;
+        buffer->capacity = enxlog_tail_buffer_capacity;
+        enxlog_record_buffer_init(&buffer->records, storage, buffer->capacity);
+
+        pthread_setspecific(enxlog_tail_buffer_key, buffer);
+    }
+
+    enxlog_tail_buffer_thread = buffer;
+
+    return buffer;
+}
+
+static void enxlog_tail_buffer_destroy(void *context)
+{
+    struct enxlog_tail_buffer *buffer = (struct enxlog_tail_buffer *)context;
+
+#ifdef ENXLOG_POOL
+    enxlog_pool_free(buffer->records.data);
+#else
+    free(buffer->records.data);
+#endif
+    buffer->records.data = NULL;
+    enxlog_tail_buffer_thread = NULL;
+}
+
+static void enxlog_tail_buffer_create_key(void)
+{
+    pthread_key_create(&enxlog_tail_buffer_key, enxlog_tail_buffer_destroy);
+}
+
+static bool enxlog_tail_buffer_write(void *context, const char *ptr, size_t length)
+{
+    struct enxlog_tail_buffer *buffer = (struct enxlog_tail_buffer *)context;
+    size_t available = sizeof(buffer->message) - buffer->message_length;
+
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&buffer->message[buffer->message_length], ptr, length);
+    buffer->message_length += length;
+
+    return true;
+}
+
+static void enxlog_tail_buffer_replay_record(
+    void *context,
+    const struct enxlog_record_header *header,
+    const char *message)
+{
+    struct enxlog_tail_buffer_replay_state *state = (struct enxlog_tail_buffer_replay_state *)context;
+    const struct enxlog_instance *instance = enxlog_logger_instance(header->logger);
+
+    if ((state->batch.count == ENXLOG_BATCH_MAX_RECORDS) || (state->batch.instance != instance)) {
+        enxlog_tail_buffer_replay_batch(state);
+        state->batch.instance = instance;
+    }
+
+    // Sinks read the time at which the entry was logged through
+    // enxlog_entry_time()
+    uint64_t wall = header->timestamp + state->wall_offset;
+    struct timeval *time = &state->batch.times[state->batch.count];
+    time->tv_sec = (time_t)(wall / 1000000000ull);
+    time->tv_usec = (suseconds_t)((wall % 1000000000ull) / 1000ull);
+
+    state->batch.records[state->batch.count] = (struct enxlog_record) {
+        .logger = header->logger,
+        .loglevel = (enum enxlog_loglevel)header->loglevel,
+        .func = header->func,
+        .line = header->line,
+        .time = time,
+        .message = message,
+        .length = header->length
+    };
+
+    state->timestamps[state->batch.count] = header->timestamp;
+    state->batch.count++;
+}
+
+static void enxlog_tail_buffer_replay_batch(struct enxlog_tail_buffer_replay_state *state)
+{
+    const struct enxlog_instance *instance = state->batch.instance;
+
+    if (state->batch.count == 0) {
+        return;
+    }
+
+#ifdef ENXLOG_ASYNC
+    // While the async mode runs only the consumer thread writes to the sinks
+    if (enxlog_async_active()) {
+        size_t queued = enxlog_async_write_batch(state->batch.records, state->timestamps, state->batch.count);
+
+        state->batch.count -= queued;
+        memmove(state->batch.records, &state->batch.records[queued], state->batch.count * sizeof(struct enxlog_record));
+        memmove(state->timestamps, &state->timestamps[queued], state->batch.count * sizeof(uint64_t));
+
+        if (state->batch.count == 0) {
+            return;
+        }
+    }
+#endif
+
+    // Only one lock is held at a time
+    enxlog_lock_acquire(instance);
+    enxlog_sinks_write_batch(instance, state->batch.records, state->batch.count);
+    enxlog_lock_release(instance);
+
+#ifdef ENXLOG_LATENCY
+    uint64_t now = enxlog_clock_now();
+    for (size_t i = 0; i < state->batch.count; ++i) {
+        enxlog_latency_record(ENXLOG_LATENCY_END_TO_END, now - state->timestamps[i]);
+    }
+#endif
+
+    state->batch.count = 0;
+}
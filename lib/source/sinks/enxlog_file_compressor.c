@@ -0,0 +1,339 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include "enxlog_file_compressor.h"
+
+#include <lz4frame.h>
+#include <zstd.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/**
+ * Number of blocks that can be filled or waiting for compression
+ * @private
+ */
+#define ENXLOG_FILE_COMPRESSOR_BLOCKS 4
+
+/**
+ * @private
+ */
+struct enxlog_file_compressor_block
+{
+    char data[ENXLOG_FILE_COMPRESSION_BLOCK_SIZE];
+    size_t length;
+    bool ready;
+};
+
+/**
+ * @private
+ */
+struct enxlog_file_compressor
+{
+    int fd;
+    enum enxlog_sink_file_compression compression;
+
+    struct enxlog_file_compressor_block blocks[ENXLOG_FILE_COMPRESSOR_BLOCKS];
+    unsigned int fill;
+    unsigned int compress;
+
+    char *frame;
+    size_t frame_size;
+    ZSTD_CCtx *zstd;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t block_ready;
+    pthread_cond_t block_free;
+    pthread_t thread;
+    bool running;
+};
+
+
+/**
+ * Stream write function
+ * @private
+ */
+static ssize_t enxlog_file_compressor_write(void *cookie, const char *buf, size_t size);
+
+/**
+ * Stream close function
+ * @private
+ */
+static int enxlog_file_compressor_close(void *cookie);
+
+/**
+ * Hands the block being filled to the compressor thread. Called with the
+ * mutex held.
+ * @private
+ */
+static void enxlog_file_compressor_release_block(struct enxlog_file_compressor *compressor);
+
+/**
+ * Compresses a block into a frame and appends it to the file
+ * @private
+ */
+static void enxlog_file_compressor_write_frame(
+    struct enxlog_file_compressor *compressor,
+    const struct enxlog_file_compressor_block *block);
+
+/**
+ * Compressor thread
+ * @private
+ */
+static void *enxlog_file_compressor_thread(void *arg);
+
+
+FILE *enxlog_file_compressor_open(const char *path, enum enxlog_sink_file_compression compression)
+{
+    cookie_io_functions_t functions = {
+        .read = NULL,
+        .write = enxlog_file_compressor_write,
+        .seek = NULL,
+        .close = enxlog_file_compressor_close
+    };
+
+    struct enxlog_file_compressor *compressor = malloc(sizeof(struct enxlog_file_compressor));
+    if (compressor == NULL) {
+        return NULL;
+    }
+
+    memset(compressor, 0, sizeof(struct enxlog_file_compressor));
+    compressor->compression = compression;
+
+    if (compression == ENXLOG_SINK_FILE_COMPRESSION_LZ4) {
+        compressor->frame_size = LZ4F_compressFrameBound(ENXLOG_FILE_COMPRESSION_BLOCK_SIZE, NULL);
+
+    } else {
+        compressor->frame_size = ZSTD_compressBound(ENXLOG_FILE_COMPRESSION_BLOCK_SIZE);
+        compressor->zstd = ZSTD_createCCtx();
+        if (compressor->zstd == NULL) {
+            goto error_context;
+        }
+    }
+
+    compressor->frame = malloc(compressor->frame_size);
+    if (compressor->frame == NULL) {
+        goto error_frame;
+    }
+
+    compressor->fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (compressor->fd < 0) {
+        goto error_open;
+    }
+
+    pthread_mutex_init(&compressor->mutex, NULL);
+    pthread_cond_init(&compressor->block_ready, NULL);
+    pthread_cond_init(&compressor->block_free, NULL);
+    compressor->running = true;
+
+    if (pthread_create(&compressor->thread, NULL, enxlog_file_compressor_thread, compressor) != 0) {
+        goto error_thread;
+    }
+
+    FILE *file = fopencookie(compressor, "w", functions);
+    if (file == NULL) {
+        enxlog_file_compressor_close(compressor);
+    }
+
+    return file;
+
+error_thread:
+    pthread_cond_destroy(&compressor->block_free);
+    pthread_cond_destroy(&compressor->block_ready);
+    pthread_mutex_destroy(&compressor->mutex);
+    close(compressor->fd);
+
+error_open:
+    free(compressor->frame);
+
+error_frame:
+    ZSTD_freeCCtx(compressor->zstd);
+
+error_context:
+    free(compressor);
+
+    return NULL;
+}
+
+static ssize_t enxlog_file_compressor_write(void *cookie, const char *buf, size_t size)
+{
+    struct enxlog_file_compressor *compressor = (struct enxlog_file_compressor *)cookie;
+    size_t remaining = size;
+
+    pthread_mutex_lock(&compressor->mutex);
+
+    while (remaining) {
+        struct enxlog_file_compressor_block *block = &compressor->blocks[compressor->fill];
+        size_t available = ENXLOG_FILE_COMPRESSION_BLOCK_SIZE - block->length;
+        size_t count = (remaining < available) ? remaining : available;
+
+        memcpy(&block->data[block->length], buf, count);
+        block->length += count;
+        buf += count;
+        remaining -= count;
+
+        if (block->length == ENXLOG_FILE_COMPRESSION_BLOCK_SIZE) {
+            enxlog_file_compressor_release_block(compressor);
+        }
+    }
+
+    pthread_mutex_unlock(&compressor->mutex);
+
+    return size;
+}
+
+static int enxlog_file_compressor_close(void *cookie)
+{
+    struct enxlog_file_compressor *compressor = (struct enxlog_file_compressor *)cookie;
+
+    pthread_mutex_lock(&compressor->mutex);
+    if (compressor->blocks[compressor->fill].length) {
+        enxlog_file_compressor_release_block(compressor);
+    }
+    compressor->running = false;
+    pthread_cond_signal(&compressor->block_ready);
+    pthread_mutex_unlock(&compressor->mutex);
+
+    // The thread drains the remaining blocks before it exits
+    pthread_join(compressor->thread, NULL);
+
+    pthread_cond_destroy(&compressor->block_free);
+    pthread_cond_destroy(&compressor->block_ready);
+    pthread_mutex_destroy(&compressor->mutex);
+
+    int result = close(compressor->fd);
+
+    free(compressor->frame);
+    ZSTD_freeCCtx(compressor->zstd);
+    free(compressor);
+
+    return result;
+}
+
+static void enxlog_file_compressor_release_block(struct enxlog_file_compressor *compressor)
+{
+    compressor->blocks[compressor->fill].ready = true;
+    compressor->fill = (compressor->fill + 1) % ENXLOG_FILE_COMPRESSOR_BLOCKS;
+    pthread_cond_signal(&compressor->block_ready);
+
+    // Only wait when the compressor has fallen a full set of blocks behind
+    while (compressor->blocks[compressor->fill].ready) {
+        pthread_cond_wait(&compressor->block_free, &compressor->mutex);
+    }
+}
+
+static void enxlog_file_compressor_write_frame(
+    struct enxlog_file_compressor *compressor,
+    const struct enxlog_file_compressor_block *block)
+{
+    size_t length;
+
+    if (compressor->compression == ENXLOG_SINK_FILE_COMPRESSION_LZ4) {
+        length = LZ4F_compressFrame(compressor->frame, compressor->frame_size, block->data, block->length, NULL);
+        if (LZ4F_isError(length)) {
+            return;
+        }
+
+    } else {
+        length = ZSTD_compressCCtx(compressor->zstd, compressor->frame, compressor->frame_size, block->data, block->length, 1);
+        if (ZSTD_isError(length)) {
+            return;
+        }
+    }
+
+    const char *ptr = compressor->frame;
+    while (length) {
+        ssize_t result = write(compressor->fd, ptr, length);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        ptr += result;
+        length -= result;
+    }
+}
+
+static void *enxlog_file_compressor_thread(void *arg)
+{
+    struct enxlog_file_compressor *compressor = (struct enxlog_file_compressor *)arg;
+    struct timespec deadline;
+
+    pthread_mutex_lock(&compressor->mutex);
+
+    for (;;) {
+        struct enxlog_file_compressor_block *block = &compressor->blocks[compressor->compress];
+
+        if (!block->ready) {
+            if (!compressor->running) {
+                break;
+            }
+
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += ENXLOG_FILE_COMPRESSION_FLUSH_INTERVAL_MS / 1000;
+            deadline.tv_nsec += (ENXLOG_FILE_COMPRESSION_FLUSH_INTERVAL_MS % 1000) * 1000000l;
+            if (deadline.tv_nsec >= 1000000000l) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000l;
+            }
+
+            int result = pthread_cond_timedwait(&compressor->block_ready, &compressor->mutex, &deadline);
+
+            // Take a partially filled block once it has waited long enough
+            if ((result == ETIMEDOUT) && !block->ready && block->length &&
+                (compressor->fill == compressor->compress)) {
+
+                block->ready = true;
+                compressor->fill = (compressor->fill + 1) % ENXLOG_FILE_COMPRESSOR_BLOCKS;
+            }
+
+            continue;
+        }
+
+        // The producer does not touch a ready block, so it can be
+        // compressed without holding the mutex
+        pthread_mutex_unlock(&compressor->mutex);
+        enxlog_file_compressor_write_frame(compressor, block);
+        pthread_mutex_lock(&compressor->mutex);
+
+        block->length = 0;
+        block->ready = false;
+        compressor->compress = (compressor->compress + 1) % ENXLOG_FILE_COMPRESSOR_BLOCKS;
+        pthread_cond_signal(&compressor->block_free);
+    }
+
+    pthread_mutex_unlock(&compressor->mutex);
+
+    return NULL;
+}
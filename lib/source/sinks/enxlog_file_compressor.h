@@ -0,0 +1,52 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#ifndef ENXLOG_FILE_COMPRESSOR_H
+#define ENXLOG_FILE_COMPRESSOR_H
+
+#include <enx/log/sinks/enxlog_sink_file.h>
+
+#include <stdio.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Opens a write only stream that compresses into a file
+ *
+ * Data written to the stream is collected into blocks of
+ * ENXLOG_FILE_COMPRESSION_BLOCK_SIZE bytes. A background thread compresses
+ * each block into an independent frame and appends it to the file, so the
+ * result can be read with the standard lz4 and zstd tools. Partially
+ * filled blocks are written once they have waited
+ * ENXLOG_FILE_COMPRESSION_FLUSH_INTERVAL_MS. Closing the stream writes out
+ * all remaining data.
+ *
+ * @returns NULL if the file could not be opened
+ */
+FILE *enxlog_file_compressor_open(const char *path, enum enxlog_sink_file_compression compression);
+
+
+__END_DECLS
+
+#endif
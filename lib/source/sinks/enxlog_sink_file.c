@@ -22,15 +22,27 @@
 
 #include <enx/log/sinks/enxlog_sink_file.h>
 
+#ifdef ENXLOG_COMPRESSION
+#include "enxlog_file_compressor.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
 
 
+#ifndef ENXLOG_NO_HEAP
+
 struct enxlog_sink_file_context *enxlog_sink_file_create()
 {
-    return malloc(sizeof(struct enxlog_sink_file_context));
+    struct enxlog_sink_file_context *ctx = malloc(sizeof(struct enxlog_sink_file_context));
+    if (ctx) {
+        ctx->path = NULL;
+        ctx->file = NULL;
+        ctx->compression = ENXLOG_SINK_FILE_COMPRESSION_NONE;
+        ctx->pattern = NULL;
+    }
+
+    return ctx;
 }
 
 void enxlog_sink_file_destroy(void *context)
@@ -38,15 +50,28 @@ void enxlog_sink_file_destroy(void *context)
     struct enxlog_sink_file_context *ctx = (struct enxlog_sink_file_context *)context;
 
     enxlog_sink_file_shutdown(ctx);
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
     free(ctx);
 }
 
+#endif
+
 
 bool enxlog_sink_file_init(void *context)
 {
     struct enxlog_sink_file_context *ctx = (struct enxlog_sink_file_context *)context;
 
-    ctx->file = fopen(ctx->path, "a");
+    if (ctx->compression != ENXLOG_SINK_FILE_COMPRESSION_NONE) {
+#ifdef ENXLOG_COMPRESSION
+        ctx->file = enxlog_file_compressor_open(ctx->path, ctx->compression);
+#else
+        ctx->file = NULL;
+#endif
+
+    } else {
+        ctx->file = fopen(ctx->path, "a");
+    }
+
     return (ctx->file != NULL);
 }
 
@@ -54,7 +79,10 @@ void enxlog_sink_file_shutdown(void *context)
 {
     struct enxlog_sink_file_context *ctx = (struct enxlog_sink_file_context *)context;
 
-    fclose(ctx->file);
+    if (ctx->file) {
+        fclose(ctx->file);
+        ctx->file = NULL;
+    }
 }
 
 void enxlog_sink_file_log_entry_open(
@@ -65,42 +93,14 @@ void enxlog_sink_file_log_entry_open(
     unsigned int line)
 {
     struct enxlog_sink_file_context *ctx = (struct enxlog_sink_file_context *)context;
-    ctx->tag_length = 0;
-
-    // Timestamp
-    struct timeval curTime;
-    gettimeofday(&curTime, NULL);
-    int milli = curTime.tv_usec / 1000;
-
-    struct tm* timeinfo;
-    timeinfo = localtime(&curTime.tv_sec);
-
-    char tag[64];
-    strftime(tag, sizeof(tag), "%Y-%m-%d %H:%M:%S", timeinfo);
-    ctx->tag_length += fprintf(ctx->file, "%s.%03d ", tag, milli);
-
-    // Severity
-    switch (loglevel) {
-        case LOGLEVEL_ERROR: ctx->tag_length += fprintf(ctx->file, "-- ERROR -- "); break;
-        case LOGLEVEL_WARN:  ctx->tag_length += fprintf(ctx->file, "-- WARN  -- "); break;
-        case LOGLEVEL_INFO:  ctx->tag_length += fprintf(ctx->file, "-- INFO  -- "); break;
-        case LOGLEVEL_DEBUG: ctx->tag_length += fprintf(ctx->file, "-- DEBUG -- "); break;
-        case LOGLEVEL_TRACE: ctx->tag_length += fprintf(ctx->file, "-- TRACE -- "); break;
-        default : break;
-    }
-
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
 
-    // Path
-    const char **name_part = logger->name;
-    while (*name_part) {
-        ctx->tag_length += fprintf(ctx->file, "%s::", *name_part);
-        name_part++;
-    }
-
-    // Function and line
-    ctx->tag_length += fprintf(ctx->file, "%s:%u: ", func, line);
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &ctx->tag_length, logger, loglevel, func, line);
+    fwrite(header, 1, length, ctx->file);
 }
 
+
 void enxlog_sink_file_log_entry_write(
     void *context,
     const char *ptr,
@@ -108,15 +108,7 @@ void enxlog_sink_file_log_entry_write(
 {
     struct enxlog_sink_file_context *ctx = (struct enxlog_sink_file_context *)context;
 
-    if ((length == 1) && *ptr == '\n') {
-        putc('\n', stdout);
-        for (size_t i=0; i < ctx->tag_length; ++i) {
-            putc(' ', ctx->file);
-        }
-
-    } else {
-        fwrite(ptr, 1, length, ctx->file);
-    }
+    enxlog_pattern_write_message(ctx->pattern, ctx->tag_length, ptr, length, enxlog_pattern_write_file, ctx->file);
 }
 
 void enxlog_sink_file_log_entry_close(
@@ -127,3 +119,31 @@ void enxlog_sink_file_log_entry_close(
     fprintf(ctx->file, "\n");
     fflush(ctx->file);
 }
+
+void enxlog_sink_file_log_batch(
+    void *context,
+    const struct enxlog_record *records,
+    size_t count)
+{
+    struct enxlog_sink_file_context *ctx = (struct enxlog_sink_file_context *)context;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
+
+    for (size_t i = 0; i < count; ++i) {
+        const struct enxlog_record *record = &records[i];
+
+        enxlog_record_select(record);
+
+        size_t length = enxlog_pattern_format(
+            pattern, header, sizeof(header), &ctx->tag_length,
+            record->logger, record->loglevel, record->func, record->line);
+        fwrite(header, 1, length, ctx->file);
+
+        enxlog_pattern_write_message(ctx->pattern, ctx->tag_length, record->message, record->length, enxlog_pattern_write_file, ctx->file);
+        fputc('\n', ctx->file);
+    }
+
+    // One flush, so the batch reaches the file, or the compressor, in as
+    // few writes as the stdio buffer allows
+    fflush(ctx->file);
+}
@@ -0,0 +1,283 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/sinks/enxlog_sink_flight_recorder.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+/**
+ * Appends data to the ring buffer
+ * @private
+ */
+static void enxlog_sink_flight_recorder_append(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+/**
+ * Writes a buffer to a file descriptor, retrying on partial writes
+ * @private
+ */
+static bool enxlog_sink_flight_recorder_write_all(int fd, const char *ptr, size_t length);
+
+/**
+ * Crash signal handler
+ * @private
+ */
+static void enxlog_sink_flight_recorder_signal_handler(int signo);
+
+
+static const int enxlog_sink_flight_recorder_signals[ENXLOG_FLIGHT_RECORDER_SIGNAL_COUNT] = {
+    SIGSEGV, SIGABRT, SIGBUS, SIGILL, SIGFPE
+};
+
+static struct enxlog_sink_flight_recorder_context *enxlog_sink_flight_recorder_active = NULL;
+
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_sink_flight_recorder_context *enxlog_sink_flight_recorder_create(size_t size)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = malloc(sizeof(struct enxlog_sink_flight_recorder_context));
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    memset(ctx, 0, sizeof(struct enxlog_sink_flight_recorder_context));
+    ctx->buffer = malloc(size);
+    ctx->size = size;
+    ctx->crash_fd = -1;
+
+    if (ctx->buffer == NULL) {
+        free(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_flight_recorder_destroy(void *context)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = (struct enxlog_sink_flight_recorder_context *)context;
+
+    enxlog_sink_flight_recorder_shutdown(ctx);
+    free(ctx->buffer);
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
+    free(ctx);
+}
+
+#endif
+
+bool enxlog_sink_flight_recorder_init(void *context)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = (struct enxlog_sink_flight_recorder_context *)context;
+    size_t i;
+
+    ctx->head = 0;
+    ctx->wrapped = false;
+    ctx->crash_fd = -1;
+
+    if ((ctx->buffer == NULL) || (ctx->size == 0)) {
+        return false;
+    }
+
+    enxlog_sink_flight_recorder_active = ctx;
+
+    // Crash dump
+    if (ctx->crash_dump == NULL) {
+        return true;
+
+    } else if (strcmp(ctx->crash_dump, "stderr") == 0) {
+        ctx->crash_fd = STDERR_FILENO;
+
+    } else {
+        ctx->crash_fd = open(ctx->crash_dump, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (ctx->crash_fd < 0) {
+            return false;
+        }
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = enxlog_sink_flight_recorder_signal_handler;
+    action.sa_flags = SA_RESETHAND | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+
+    for (i=0; i < ENXLOG_FLIGHT_RECORDER_SIGNAL_COUNT; ++i) {
+        sigaction(enxlog_sink_flight_recorder_signals[i], &action, &ctx->previous_actions[i]);
+    }
+
+    return true;
+}
+
+void enxlog_sink_flight_recorder_shutdown(void *context)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = (struct enxlog_sink_flight_recorder_context *)context;
+    size_t i;
+
+    if (ctx->crash_fd >= 0) {
+        for (i=0; i < ENXLOG_FLIGHT_RECORDER_SIGNAL_COUNT; ++i) {
+            sigaction(enxlog_sink_flight_recorder_signals[i], &ctx->previous_actions[i], NULL);
+        }
+
+        if (ctx->crash_fd != STDERR_FILENO) {
+            close(ctx->crash_fd);
+        }
+
+        ctx->crash_fd = -1;
+    }
+
+    if (enxlog_sink_flight_recorder_active == ctx) {
+        enxlog_sink_flight_recorder_active = NULL;
+    }
+}
+
+void enxlog_sink_flight_recorder_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = (struct enxlog_sink_flight_recorder_context *)context;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
+
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &ctx->tag_length, logger, loglevel, func, line);
+    enxlog_sink_flight_recorder_append(ctx, header, length);
+}
+
+
+void enxlog_sink_flight_recorder_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = (struct enxlog_sink_flight_recorder_context *)context;
+
+    enxlog_pattern_write_message(ctx->pattern, ctx->tag_length, ptr, length, enxlog_sink_flight_recorder_append, ctx);
+}
+
+void enxlog_sink_flight_recorder_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = (struct enxlog_sink_flight_recorder_context *)context;
+    enxlog_sink_flight_recorder_append(ctx, "\n", 1);
+}
+
+bool enxlog_flight_recorder_dump(int fd)
+{
+    const struct enxlog_sink_flight_recorder_context *ctx = enxlog_sink_flight_recorder_active;
+    if (ctx == NULL) {
+        return false;
+    }
+
+    size_t head = ctx->head;
+
+    if (!ctx->wrapped) {
+        return enxlog_sink_flight_recorder_write_all(fd, ctx->buffer, head);
+    }
+
+    // Skip the oldest line, which has been partially overwritten
+    const char *start = memchr(&ctx->buffer[head], '\n', ctx->size - head);
+    if (start) {
+        start++;
+        return enxlog_sink_flight_recorder_write_all(fd, start, &ctx->buffer[ctx->size] - start) &&
+               enxlog_sink_flight_recorder_write_all(fd, ctx->buffer, head);
+    }
+
+    start = memchr(ctx->buffer, '\n', head);
+    if (start) {
+        start++;
+        return enxlog_sink_flight_recorder_write_all(fd, start, &ctx->buffer[head] - start);
+    }
+
+    return true;
+}
+
+static void enxlog_sink_flight_recorder_append(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_flight_recorder_context *ctx = (struct enxlog_sink_flight_recorder_context *)context;
+
+    // Only the tail of an oversized write fits
+    if (length > ctx->size) {
+        ptr += length - ctx->size;
+        length = ctx->size;
+    }
+
+    size_t first = ctx->size - ctx->head;
+    if (first > length) {
+        first = length;
+    }
+
+    memcpy(&ctx->buffer[ctx->head], ptr, first);
+    memcpy(ctx->buffer, ptr + first, length - first);
+
+    ctx->head += length;
+    if (ctx->head >= ctx->size) {
+        ctx->head -= ctx->size;
+        ctx->wrapped = true;
+    }
+}
+
+static bool enxlog_sink_flight_recorder_write_all(int fd, const char *ptr, size_t length)
+{
+    while (length) {
+        ssize_t written = write(fd, ptr, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        ptr += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+static void enxlog_sink_flight_recorder_signal_handler(int signo)
+{
+    static const char banner[] = "\n---- enxlog flight recorder ----\n";
+    const struct enxlog_sink_flight_recorder_context *ctx = enxlog_sink_flight_recorder_active;
+    int saved_errno = errno;
+
+    if (ctx && (ctx->crash_fd >= 0)) {
+        enxlog_sink_flight_recorder_write_all(ctx->crash_fd, banner, sizeof(banner) - 1);
+        enxlog_flight_recorder_dump(ctx->crash_fd);
+    }
+
+    // SA_RESETHAND has restored the default action
+    errno = saved_errno;
+    raise(signo);
+}
@@ -0,0 +1,429 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include <enx/log/sinks/enxlog_sink_journald.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+/**
+ * Appends data to the record if it fits, keeping the last byte free for
+ * the newline that ends a field
+ * @private
+ */
+static bool enxlog_sink_journald_append(
+    struct enxlog_sink_journald_context *ctx,
+    const char *ptr,
+    size_t length);
+
+/**
+ * Starts a field in the binary form: the name, a newline and a 64 bit
+ * little endian length that is filled in by enxlog_sink_journald_end_field
+ * @returns false if the field does not fit
+ * @private
+ */
+static bool enxlog_sink_journald_begin_field(
+    struct enxlog_sink_journald_context *ctx,
+    const char *name,
+    size_t length,
+    size_t *start);
+
+/**
+ * Fills in the length of a field and ends it
+ * @private
+ */
+static void enxlog_sink_journald_end_field(
+    struct enxlog_sink_journald_context *ctx,
+    size_t start);
+
+/**
+ * Appends a NAME=value field, or nothing if it does not fit
+ * @private
+ */
+static void enxlog_sink_journald_text_field(
+    struct enxlog_sink_journald_context *ctx,
+    const char *name,
+    const char *value);
+
+/**
+ * Formatter output function for field values
+ * @private
+ */
+static bool enxlog_sink_journald_field_write(void *context, const char *ptr, size_t length);
+
+/**
+ * Passes the record to the journal in a sealed memfd
+ * @private
+ */
+static void enxlog_sink_journald_send_memfd(
+    struct enxlog_sink_journald_context *ctx,
+    const struct sockaddr_un *address);
+
+
+struct enxlog_sink_journald_context *enxlog_sink_journald_create()
+{
+    struct enxlog_sink_journald_context *ctx = malloc(sizeof(struct enxlog_sink_journald_context));
+    if (ctx) {
+        memset(ctx, 0, sizeof(struct enxlog_sink_journald_context));
+        ctx->fd = -1;
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_journald_destroy(void *context)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+
+    enxlog_sink_journald_shutdown(ctx);
+    free(ctx);
+}
+
+bool enxlog_sink_journald_init(void *context)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+    const char *path = ctx->path ? ctx->path : ENXLOG_JOURNALD_PATH;
+
+    if (strlen(path) >= sizeof(((struct sockaddr_un *)NULL)->sun_path)) {
+        return false;
+    }
+
+    ctx->record = malloc(ENXLOG_JOURNALD_RECORD_SIZE);
+    if (ctx->record == NULL) {
+        return false;
+    }
+
+    ctx->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (ctx->fd < 0) {
+        free(ctx->record);
+        ctx->record = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void enxlog_sink_journald_shutdown(void *context)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+
+    if (ctx->fd >= 0) {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+
+    free(ctx->record);
+    ctx->record = NULL;
+}
+
+void enxlog_sink_journald_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+    char text[ENXLOG_JOURNALD_MAX_FIELD_NAME + 32];
+    size_t start;
+
+    ctx->length = 0;
+    ctx->message_open = false;
+
+    if (ctx->record == NULL) {
+        return;
+    }
+
+    switch (loglevel) {
+        case LOGLEVEL_ERROR: enxlog_sink_journald_text_field(ctx, "PRIORITY", "3"); break;
+        case LOGLEVEL_WARN: enxlog_sink_journald_text_field(ctx, "PRIORITY", "4"); break;
+        case LOGLEVEL_INFO: enxlog_sink_journald_text_field(ctx, "PRIORITY", "6"); break;
+        default: enxlog_sink_journald_text_field(ctx, "PRIORITY", "7"); break;
+    }
+
+    enxlog_sink_journald_text_field(ctx, "SYSLOG_IDENTIFIER", ctx->identifier ? ctx->identifier : program_invocation_short_name);
+    enxlog_sink_journald_text_field(ctx, "CODE_FUNC", func);
+
+    snprintf(text, sizeof(text), "%u", line);
+    enxlog_sink_journald_text_field(ctx, "CODE_LINE", text);
+
+    // Logger path, with the parts separated by dots
+    if (enxlog_sink_journald_begin_field(ctx, "ENXLOG_LOGGER", 13, &start)) {
+        const char **name_part = logger->name;
+        while (*name_part) {
+            if (name_part != logger->name) {
+                enxlog_sink_journald_append(ctx, ".", 1);
+            }
+            enxlog_sink_journald_append(ctx, *name_part, strlen(*name_part));
+            name_part++;
+        }
+        enxlog_sink_journald_end_field(ctx, start);
+    }
+
+    // The message is written as it arrives, and its length filled in once
+    // it is complete
+    ctx->message_open = enxlog_sink_journald_begin_field(ctx, "MESSAGE", 7, &ctx->message_start);
+}
+
+void enxlog_sink_journald_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+
+    if (ctx->message_open) {
+        // Truncates the message if it does not fit
+        size_t available = ENXLOG_JOURNALD_RECORD_SIZE - 1 - ctx->length;
+        enxlog_sink_journald_append(ctx, ptr, (length < available) ? length : available);
+    }
+}
+
+void enxlog_sink_journald_log_entry_field(
+    void *context,
+    const char *key,
+    const struct enxtxt_fstr_arg *value)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+    char name[ENXLOG_JOURNALD_MAX_FIELD_NAME];
+    size_t length = 0;
+    size_t start;
+
+    if (ctx->record == NULL) {
+        return;
+    }
+
+    if (ctx->message_open) {
+        enxlog_sink_journald_end_field(ctx, ctx->message_start);
+        ctx->message_open = false;
+    }
+
+    // Journal field names are upper case, and may not start with a digit
+    // or an underscore, which marks fields set by the journal itself
+    if ((key[0] == '_') || ((key[0] >= '0') && (key[0] <= '9'))) {
+        name[length++] = 'F';
+    }
+
+    for (; *key && (length < sizeof(name)); ++key) {
+        char c = *key;
+        if ((c >= 'a') && (c <= 'z')) {
+            c = c - 'a' + 'A';
+        } else if (!(((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')))) {
+            c = '_';
+        }
+        name[length++] = c;
+    }
+
+    if ((length == 0) || !enxlog_sink_journald_begin_field(ctx, name, length, &start)) {
+        return;
+    }
+
+    value->fn_fmt(value, enxlog_sink_journald_field_write, ctx);
+    enxlog_sink_journald_end_field(ctx, start);
+}
+
+void enxlog_sink_journald_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+    struct sockaddr_un address;
+    struct msghdr message;
+    struct iovec iov;
+
+    if (ctx->record == NULL) {
+        return;
+    }
+
+    if (ctx->message_open) {
+        enxlog_sink_journald_end_field(ctx, ctx->message_start);
+        ctx->message_open = false;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, ctx->path ? ctx->path : ENXLOG_JOURNALD_PATH);
+
+    if ((ctx->max_datagram == 0) || (ctx->length <= ctx->max_datagram)) {
+        iov.iov_base = ctx->record;
+        iov.iov_len = ctx->length;
+
+        memset(&message, 0, sizeof(message));
+        message.msg_name = &address;
+        message.msg_namelen = sizeof(address);
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+
+        if (sendmsg(ctx->fd, &message, MSG_NOSIGNAL) >= 0) {
+            return;
+        }
+
+        // Anything other than a record that is too large is dropped
+        if ((errno != EMSGSIZE) && (errno != ENOBUFS)) {
+            return;
+        }
+    }
+
+    enxlog_sink_journald_send_memfd(ctx, &address);
+}
+
+static bool enxlog_sink_journald_append(
+    struct enxlog_sink_journald_context *ctx,
+    const char *ptr,
+    size_t length)
+{
+    if (ctx->length + length > ENXLOG_JOURNALD_RECORD_SIZE - 1) {
+        return false;
+    }
+
+    memcpy(&ctx->record[ctx->length], ptr, length);
+    ctx->length += length;
+
+    return true;
+}
+
+static bool enxlog_sink_journald_begin_field(
+    struct enxlog_sink_journald_context *ctx,
+    const char *name,
+    size_t length,
+    size_t *start)
+{
+    static const char zero[8] = { 0 };
+    size_t rollback = ctx->length;
+
+    if (!enxlog_sink_journald_append(ctx, name, length) ||
+        !enxlog_sink_journald_append(ctx, "\n", 1) ||
+        !enxlog_sink_journald_append(ctx, zero, sizeof(zero))) {
+        ctx->length = rollback;
+        return false;
+    }
+
+    *start = ctx->length;
+
+    return true;
+}
+
+static void enxlog_sink_journald_end_field(
+    struct enxlog_sink_journald_context *ctx,
+    size_t start)
+{
+    uint64_t length = ctx->length - start;
+
+    for (size_t i = 0; i < 8; ++i) {
+        ctx->record[start - 8 + i] = (char)(length >> (i * 8));
+    }
+
+    // Always fits, as appends keep the last byte free
+    ctx->record[ctx->length++] = '\n';
+}
+
+static void enxlog_sink_journald_text_field(
+    struct enxlog_sink_journald_context *ctx,
+    const char *name,
+    const char *value)
+{
+    size_t rollback = ctx->length;
+
+    if (!enxlog_sink_journald_append(ctx, name, strlen(name)) ||
+        !enxlog_sink_journald_append(ctx, "=", 1) ||
+        !enxlog_sink_journald_append(ctx, value, strlen(value))) {
+        ctx->length = rollback;
+        return;
+    }
+
+    ctx->record[ctx->length++] = '\n';
+}
+
+static bool enxlog_sink_journald_field_write(void *context, const char *ptr, size_t length)
+{
+    struct enxlog_sink_journald_context *ctx = (struct enxlog_sink_journald_context *)context;
+    size_t available = ENXLOG_JOURNALD_RECORD_SIZE - 1 - ctx->length;
+
+    if (length > available) {
+        enxlog_sink_journald_append(ctx, ptr, available);
+        return false;
+    }
+
+    return enxlog_sink_journald_append(ctx, ptr, length);
+}
+
+static void enxlog_sink_journald_send_memfd(
+    struct enxlog_sink_journald_context *ctx,
+    const struct sockaddr_un *address)
+{
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr message;
+    size_t written = 0;
+
+    int fd = memfd_create("enxlog-journald", MFD_ALLOW_SEALING | MFD_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    while (written < ctx->length) {
+        ssize_t result = write(fd, &ctx->record[written], ctx->length - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            goto done;
+        }
+        written += result;
+    }
+
+    // The journal only accepts sealed memfds
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+        goto done;
+    }
+
+    memset(&control, 0, sizeof(control));
+    memset(&message, 0, sizeof(message));
+    message.msg_name = (void *)address;
+    message.msg_namelen = sizeof(struct sockaddr_un);
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    sendmsg(ctx->fd, &message, MSG_NOSIGNAL);
+
+done:
+    close(fd);
+}
@@ -0,0 +1,441 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#include <enx/log/sinks/enxlog_sink_json.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * Space kept free for closing the record when escaped content is truncated
+ * @private
+ */
+#define ENXLOG_SINK_JSON_RESERVE 64
+
+/**
+ * Output state while a field value is formatted
+ * @private
+ */
+struct enxlog_sink_json_field
+{
+    struct enxlog_sink_json_context *ctx;
+    bool truncated;
+};
+
+
+/**
+ * Appends data to the line buffer if it fits below the limit
+ * @private
+ */
+static bool enxlog_sink_json_append(
+    struct enxlog_sink_json_context *ctx,
+    const char *ptr,
+    size_t length,
+    size_t limit);
+
+/**
+ * Appends data as the contents of a JSON string, truncating it at the limit
+ * @returns false if the data was truncated
+ * @private
+ */
+static bool enxlog_sink_json_escape(
+    struct enxlog_sink_json_context *ctx,
+    const char *ptr,
+    size_t length,
+    size_t limit);
+
+/**
+ * Returns the number of leading bytes that can be copied without escaping
+ * @private
+ */
+static size_t enxlog_sink_json_scan(const char *ptr, size_t length);
+
+/**
+ * Formatter output function for field values
+ * @private
+ */
+static bool enxlog_sink_json_field_write(void *context, const char *ptr, size_t length);
+
+/**
+ * Returns true if the text is a JSON number
+ * @private
+ */
+static bool enxlog_sink_json_is_number(const char *ptr, size_t length);
+
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_sink_json_context *enxlog_sink_json_create()
+{
+    struct enxlog_sink_json_context *ctx = malloc(sizeof(struct enxlog_sink_json_context));
+    if (ctx) {
+        ctx->path = NULL;
+        ctx->file = NULL;
+        ctx->length = 0;
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_json_destroy(void *context)
+{
+    struct enxlog_sink_json_context *ctx = (struct enxlog_sink_json_context *)context;
+
+    enxlog_sink_json_shutdown(ctx);
+    free(ctx);
+}
+
+#endif
+
+bool enxlog_sink_json_init(void *context)
+{
+    struct enxlog_sink_json_context *ctx = (struct enxlog_sink_json_context *)context;
+
+    if (ctx->path) {
+        ctx->file = fopen(ctx->path, "a");
+    } else {
+        ctx->file = stdout;
+    }
+
+    return (ctx->file != NULL);
+}
+
+void enxlog_sink_json_shutdown(void *context)
+{
+    struct enxlog_sink_json_context *ctx = (struct enxlog_sink_json_context *)context;
+
+    if (ctx->file && (ctx->file != stdout)) {
+        fclose(ctx->file);
+    }
+    ctx->file = NULL;
+}
+
+void enxlog_sink_json_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_json_context *ctx = (struct enxlog_sink_json_context *)context;
+    const size_t limit = ENXLOG_SINK_JSON_LINE_SIZE - ENXLOG_SINK_JSON_RESERVE;
+    char text[64];
+    int length;
+
+    ctx->length = 0;
+    ctx->message_open = false;
+    ctx->fields_open = false;
+
+    // Timestamp
+    struct timeval curTime;
+    enxlog_entry_time(&curTime);
+    int milli = curTime.tv_usec / 1000;
+
+    struct tm timeinfo;
+    gmtime_r(&curTime.tv_sec, &timeinfo);
+
+    char timestamp[32];
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+    length = snprintf(text, sizeof(text), "{\"timestamp\":\"%s.%03dZ\",\"level\":", timestamp, milli);
+    enxlog_sink_json_append(ctx, text, length, ENXLOG_SINK_JSON_LINE_SIZE);
+
+    // Severity
+    switch (loglevel) {
+        case LOGLEVEL_ERROR: enxlog_sink_json_append(ctx, "\"error\"", 7, ENXLOG_SINK_JSON_LINE_SIZE); break;
+        case LOGLEVEL_WARN:  enxlog_sink_json_append(ctx, "\"warn\"", 6, ENXLOG_SINK_JSON_LINE_SIZE); break;
+        case LOGLEVEL_INFO:  enxlog_sink_json_append(ctx, "\"info\"", 6, ENXLOG_SINK_JSON_LINE_SIZE); break;
+        case LOGLEVEL_DEBUG: enxlog_sink_json_append(ctx, "\"debug\"", 7, ENXLOG_SINK_JSON_LINE_SIZE); break;
+        case LOGLEVEL_TRACE: enxlog_sink_json_append(ctx, "\"trace\"", 7, ENXLOG_SINK_JSON_LINE_SIZE); break;
+        default : enxlog_sink_json_append(ctx, "null", 4, ENXLOG_SINK_JSON_LINE_SIZE); break;
+    }
+
+    // Path
+    enxlog_sink_json_append(ctx, ",\"logger\":\"", 11, ENXLOG_SINK_JSON_LINE_SIZE);
+    const char **name_part = logger->name;
+    while (*name_part) {
+        if (name_part != logger->name) {
+            enxlog_sink_json_append(ctx, ".", 1, limit);
+        }
+        enxlog_sink_json_escape(ctx, *name_part, strlen(*name_part), limit);
+        name_part++;
+    }
+
+    length = snprintf(text, sizeof(text), "\",\"logger_id\":%u", (unsigned int)enxlog_logger_id(logger));
+    enxlog_sink_json_append(ctx, text, length, ENXLOG_SINK_JSON_LINE_SIZE);
+
+    // Function and line
+    enxlog_sink_json_append(ctx, ",\"func\":\"", 9, ENXLOG_SINK_JSON_LINE_SIZE);
+    enxlog_sink_json_escape(ctx, func, strlen(func), limit);
+    length = snprintf(text, sizeof(text), "\",\"line\":%u,\"message\":\"", line);
+    enxlog_sink_json_append(ctx, text, length, ENXLOG_SINK_JSON_LINE_SIZE);
+
+    ctx->message_open = true;
+}
+
+void enxlog_sink_json_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_json_context *ctx = (struct enxlog_sink_json_context *)context;
+
+    if (ctx->message_open) {
+        enxlog_sink_json_escape(ctx, ptr, length, ENXLOG_SINK_JSON_LINE_SIZE - ENXLOG_SINK_JSON_RESERVE);
+    }
+}
+
+void enxlog_sink_json_log_entry_field(
+    void *context,
+    const char *key,
+    const struct enxtxt_fstr_arg *value)
+{
+    struct enxlog_sink_json_context *ctx = (struct enxlog_sink_json_context *)context;
+    const size_t limit = ENXLOG_SINK_JSON_LINE_SIZE - ENXLOG_SINK_JSON_RESERVE;
+    struct enxlog_sink_json_field field = { .ctx = ctx, .truncated = false };
+
+    if (ctx->message_open) {
+        enxlog_sink_json_append(ctx, "\"", 1, ENXLOG_SINK_JSON_LINE_SIZE);
+        ctx->message_open = false;
+    }
+
+    // A field that does not fit is left out entirely
+    size_t start = ctx->length;
+
+    if (ctx->fields_open) {
+        field.truncated |= !enxlog_sink_json_append(ctx, ",\"", 2, limit);
+    } else {
+        field.truncated |= !enxlog_sink_json_append(ctx, ",\"fields\":{\"", 12, limit);
+    }
+
+    field.truncated |= !enxlog_sink_json_escape(ctx, key, strlen(key), limit);
+    field.truncated |= !enxlog_sink_json_append(ctx, "\":\"", 3, limit);
+
+    size_t value_start = ctx->length;
+    if (!field.truncated) {
+        value->fn_fmt(value, enxlog_sink_json_field_write, &field);
+    }
+
+    if (field.truncated) {
+        ctx->length = start;
+        return;
+    }
+
+    // Integers are written without quotes
+    if (enxlog_sink_json_is_number(&ctx->line[value_start], ctx->length - value_start)) {
+        memmove(&ctx->line[value_start - 1], &ctx->line[value_start], ctx->length - value_start);
+        ctx->length--;
+
+    } else {
+        enxlog_sink_json_append(ctx, "\"", 1, ENXLOG_SINK_JSON_LINE_SIZE);
+    }
+
+    ctx->fields_open = true;
+}
+
+void enxlog_sink_json_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_json_context *ctx = (struct enxlog_sink_json_context *)context;
+
+    if (ctx->message_open) {
+        enxlog_sink_json_append(ctx, "\"", 1, ENXLOG_SINK_JSON_LINE_SIZE);
+        ctx->message_open = false;
+    }
+
+    if (ctx->fields_open) {
+        enxlog_sink_json_append(ctx, "}", 1, ENXLOG_SINK_JSON_LINE_SIZE);
+    }
+
+    enxlog_sink_json_append(ctx, "}\n", 2, ENXLOG_SINK_JSON_LINE_SIZE);
+
+    fwrite(ctx->line, 1, ctx->length, ctx->file);
+    fflush(ctx->file);
+}
+
+static bool enxlog_sink_json_append(
+    struct enxlog_sink_json_context *ctx,
+    const char *ptr,
+    size_t length,
+    size_t limit)
+{
+    if (ctx->length + length > limit) {
+        return false;
+    }
+
+    memcpy(&ctx->line[ctx->length], ptr, length);
+    ctx->length += length;
+
+    return true;
+}
+
+static bool enxlog_sink_json_escape(
+    struct enxlog_sink_json_context *ctx,
+    const char *ptr,
+    size_t length,
+    size_t limit)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char *end = ptr + length;
+
+    while (ptr < end) {
+        if (ctx->length >= limit) {
+            return false;
+        }
+
+        size_t count = enxlog_sink_json_scan(ptr, end - ptr);
+        size_t available = limit - ctx->length;
+
+        if (count > available) {
+            // Do not split a UTF-8 sequence
+            count = available;
+            while ((count > 0) && ((ptr[count] & 0xc0) == 0x80)) {
+                count--;
+            }
+
+            memcpy(&ctx->line[ctx->length], ptr, count);
+            ctx->length += count;
+            return false;
+        }
+
+        memcpy(&ctx->line[ctx->length], ptr, count);
+        ctx->length += count;
+        ptr += count;
+
+        if (ptr == end) {
+            break;
+        }
+
+        char escape[6] = { '\\', 0, '0', '0', 0, 0 };
+        size_t escape_length = 2;
+
+        switch (*ptr) {
+            case '"':  escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            default:
+                escape[1] = 'u';
+                escape[4] = hex[(*ptr >> 4) & 0x0f];
+                escape[5] = hex[*ptr & 0x0f];
+                escape_length = 6;
+                break;
+        }
+
+        if (!enxlog_sink_json_append(ctx, escape, escape_length, limit)) {
+            return false;
+        }
+
+        ptr++;
+    }
+
+    return true;
+}
+
+static size_t enxlog_sink_json_scan(const char *ptr, size_t length)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+
+    while (i + 16 <= length) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)&ptr[i]);
+
+        // Bytes below 0x20 are unchanged by an unsigned min with 0x1f
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+
+        int mask = _mm_movemask_epi8(special);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+
+        i += 16;
+    }
+#endif
+
+    while (i < length) {
+        unsigned char c = ptr[i];
+        if ((c < 0x20) || (c == '"') || (c == '\\')) {
+            break;
+        }
+        i++;
+    }
+
+    return i;
+}
+
+static bool enxlog_sink_json_field_write(void *context, const char *ptr, size_t length)
+{
+    struct enxlog_sink_json_field *field = (struct enxlog_sink_json_field *)context;
+
+    if (!field->truncated) {
+        field->truncated = !enxlog_sink_json_escape(
+            field->ctx,
+            ptr,
+            length,
+            ENXLOG_SINK_JSON_LINE_SIZE - ENXLOG_SINK_JSON_RESERVE);
+    }
+
+    return !field->truncated;
+}
+
+static bool enxlog_sink_json_is_number(const char *ptr, size_t length)
+{
+    size_t i = 0;
+
+    if ((length > 0) && (ptr[0] == '-')) {
+        i++;
+    }
+
+    if (i == length) {
+        return false;
+    }
+
+    // No leading zeros, as JSON does not allow them
+    if ((ptr[i] == '0') && (length - i > 1)) {
+        return false;
+    }
+
+    for (; i < length; ++i) {
+        if ((ptr[i] < '0') || (ptr[i] > '9')) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,315 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/sinks/enxlog_sink_mmap_ring.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/**
+ * Appends data to the record being assembled
+ * @private
+ */
+static void enxlog_sink_mmap_ring_append(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+/**
+ * Returns true when the mapped header describes a valid ring
+ * @private
+ */
+static bool enxlog_sink_mmap_ring_valid(
+    const struct enxlog_sink_mmap_ring_context *ctx,
+    uint64_t capacity);
+
+/**
+ * Removes the oldest record from the ring
+ * @private
+ */
+static void enxlog_sink_mmap_ring_drop(struct enxlog_sink_mmap_ring_context *ctx);
+
+/**
+ * Copies a record into the ring
+ * @private
+ */
+static void enxlog_sink_mmap_ring_commit(struct enxlog_sink_mmap_ring_context *ctx);
+
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_sink_mmap_ring_context *enxlog_sink_mmap_ring_create()
+{
+    struct enxlog_sink_mmap_ring_context *ctx = malloc(sizeof(struct enxlog_sink_mmap_ring_context));
+    if (ctx) {
+        memset(ctx, 0, sizeof(struct enxlog_sink_mmap_ring_context));
+        ctx->fd = -1;
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_mmap_ring_destroy(void *context)
+{
+    struct enxlog_sink_mmap_ring_context *ctx = (struct enxlog_sink_mmap_ring_context *)context;
+
+    enxlog_sink_mmap_ring_shutdown(ctx);
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
+    free(ctx);
+}
+
+#endif
+
+
+bool enxlog_sink_mmap_ring_init(void *context)
+{
+    struct enxlog_sink_mmap_ring_context *ctx = (struct enxlog_sink_mmap_ring_context *)context;
+    size_t header_size = sizeof(struct enxlog_mmap_ring_header);
+    size_t size = ctx->size - (ctx->size % ENXLOG_MMAP_RING_ALIGNMENT);
+    struct stat st;
+
+    if (size < header_size + ENXLOG_MMAP_RING_ALIGNMENT * 4) {
+        return false;
+    }
+
+    ctx->record = malloc(ENXLOG_MMAP_RING_MAX_RECORD);
+    if (ctx->record == NULL) {
+        return false;
+    }
+
+    ctx->fd = open(ctx->path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (ctx->fd < 0) {
+        goto error_open;
+    }
+
+    if (fstat(ctx->fd, &st) < 0) {
+        goto error_resize;
+    }
+
+    // Only resize when required, so that existing records are kept
+    if (((size_t)st.st_size != size) && (ftruncate(ctx->fd, size) < 0)) {
+        goto error_resize;
+    }
+
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, ctx->fd, 0);
+    if (mapping == MAP_FAILED) {
+        goto error_resize;
+    }
+
+    ctx->header = (struct enxlog_mmap_ring_header *)mapping;
+    ctx->data = (char *)mapping + header_size;
+
+    if (((size_t)st.st_size != size) || !enxlog_sink_mmap_ring_valid(ctx, size - header_size)) {
+        ctx->header->magic = ENXLOG_MMAP_RING_MAGIC;
+        ctx->header->version = ENXLOG_MMAP_RING_VERSION;
+        ctx->header->header_size = header_size;
+        ctx->header->capacity = size - header_size;
+        ctx->header->head = 0;
+        ctx->header->tail = 0;
+        ctx->header->dropped = 0;
+    }
+
+    return true;
+
+error_resize:
+    close(ctx->fd);
+    ctx->fd = -1;
+
+error_open:
+    free(ctx->record);
+    ctx->record = NULL;
+
+    return false;
+}
+
+void enxlog_sink_mmap_ring_shutdown(void *context)
+{
+    struct enxlog_sink_mmap_ring_context *ctx = (struct enxlog_sink_mmap_ring_context *)context;
+
+    if (ctx->header) {
+        munmap(ctx->header, ctx->header->header_size + ctx->header->capacity);
+        ctx->header = NULL;
+        ctx->data = NULL;
+    }
+
+    if (ctx->fd >= 0) {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+
+    free(ctx->record);
+    ctx->record = NULL;
+}
+
+void enxlog_sink_mmap_ring_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_mmap_ring_context *ctx = (struct enxlog_sink_mmap_ring_context *)context;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
+
+    ctx->record_length = 0;
+
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &ctx->tag_length, logger, loglevel, func, line);
+    enxlog_sink_mmap_ring_append(ctx, header, length);
+}
+
+
+void enxlog_sink_mmap_ring_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_mmap_ring_context *ctx = (struct enxlog_sink_mmap_ring_context *)context;
+
+    enxlog_pattern_write_message(ctx->pattern, ctx->tag_length, ptr, length, enxlog_sink_mmap_ring_append, ctx);
+}
+
+void enxlog_sink_mmap_ring_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_mmap_ring_context *ctx = (struct enxlog_sink_mmap_ring_context *)context;
+
+    if (ctx->header) {
+        enxlog_sink_mmap_ring_commit(ctx);
+    }
+}
+
+static void enxlog_sink_mmap_ring_append(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_mmap_ring_context *ctx = (struct enxlog_sink_mmap_ring_context *)context;
+
+    size_t available = ENXLOG_MMAP_RING_MAX_RECORD - ctx->record_length;
+
+    if (ctx->record == NULL) {
+        return;
+    }
+
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&ctx->record[ctx->record_length], ptr, length);
+    ctx->record_length += length;
+}
+
+static bool enxlog_sink_mmap_ring_valid(
+    const struct enxlog_sink_mmap_ring_context *ctx,
+    uint64_t capacity)
+{
+    const struct enxlog_mmap_ring_header *header = ctx->header;
+
+    return (header->magic == ENXLOG_MMAP_RING_MAGIC) &&
+           (header->version == ENXLOG_MMAP_RING_VERSION) &&
+           (header->header_size == sizeof(struct enxlog_mmap_ring_header)) &&
+           (header->capacity == capacity) &&
+           (header->head < capacity) && (header->head % ENXLOG_MMAP_RING_ALIGNMENT == 0) &&
+           (header->tail < capacity) && (header->tail % ENXLOG_MMAP_RING_ALIGNMENT == 0);
+}
+
+static void enxlog_sink_mmap_ring_drop(struct enxlog_sink_mmap_ring_context *ctx)
+{
+    struct enxlog_mmap_ring_header *header = ctx->header;
+    const struct enxlog_mmap_ring_record *record = (const struct enxlog_mmap_ring_record *)&ctx->data[header->tail];
+    uint64_t tail;
+
+    if (record->length == ENXLOG_MMAP_RING_WRAP) {
+        tail = 0;
+    } else {
+        tail = header->tail + sizeof(struct enxlog_mmap_ring_record) + record->length;
+        tail = (tail + ENXLOG_MMAP_RING_ALIGNMENT - 1) & ~(uint64_t)(ENXLOG_MMAP_RING_ALIGNMENT - 1);
+        if (tail >= header->capacity) {
+            tail = 0;
+        }
+    }
+
+    __atomic_store_n(&header->tail, tail, __ATOMIC_RELEASE);
+}
+
+static void enxlog_sink_mmap_ring_commit(struct enxlog_sink_mmap_ring_context *ctx)
+{
+    struct enxlog_mmap_ring_header *header = ctx->header;
+    uint64_t capacity = header->capacity;
+    uint64_t size = sizeof(struct enxlog_mmap_ring_record) + ctx->record_length;
+    size = (size + ENXLOG_MMAP_RING_ALIGNMENT - 1) & ~(uint64_t)(ENXLOG_MMAP_RING_ALIGNMENT - 1);
+
+    // The ring must never become completely full, as head == tail means empty
+    if (size + ENXLOG_MMAP_RING_ALIGNMENT > capacity) {
+        header->dropped++;
+        return;
+    }
+
+    for (;;) {
+        uint64_t head = header->head;
+        uint64_t tail = header->tail;
+
+        if (head >= tail) {
+            // Fits at the end
+            if ((capacity - head > size) || ((capacity - head == size) && (tail > 0))) {
+                break;
+            }
+
+            // Wrap to the start. The marker is written before head moves so
+            // that a reader never follows stale data.
+            if ((size < tail) || (head == tail)) {
+                struct enxlog_mmap_ring_record *marker = (struct enxlog_mmap_ring_record *)&ctx->data[head];
+                marker->length = ENXLOG_MMAP_RING_WRAP;
+                marker->reserved = 0;
+                __atomic_store_n(&header->head, 0, __ATOMIC_RELEASE);
+
+                if (head == tail) {
+                    __atomic_store_n(&header->tail, 0, __ATOMIC_RELEASE);
+                }
+                continue;
+            }
+
+        } else if (tail - head > size) {
+            break;
+        }
+
+        enxlog_sink_mmap_ring_drop(ctx);
+    }
+
+    struct enxlog_mmap_ring_record *record = (struct enxlog_mmap_ring_record *)&ctx->data[header->head];
+    record->length = ctx->record_length;
+    record->reserved = 0;
+    memcpy(record + 1, ctx->record, ctx->record_length);
+
+    uint64_t head = header->head + size;
+    if (head == capacity) {
+        head = 0;
+    }
+
+    __atomic_store_n(&header->head, head, __ATOMIC_RELEASE);
+}
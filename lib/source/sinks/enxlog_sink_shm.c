@@ -0,0 +1,335 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/sinks/enxlog_sink_shm.h>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+
+/**
+ * Expands %p in a shared memory name
+ * @private
+ */
+static bool enxlog_sink_shm_expand_name(char *buffer, size_t size, const char *name);
+
+/**
+ * Appends data to the record being assembled
+ * @private
+ */
+static void enxlog_sink_shm_append(
+    void *context,
+    const char *ptr,
+    size_t length);
+
+/**
+ * Returns true when the mapped header describes a valid ring
+ * @private
+ */
+static bool enxlog_sink_shm_valid(
+    const struct enxlog_sink_shm_context *ctx,
+    uint64_t capacity);
+
+/**
+ * Copies a record into the ring and wakes the collector
+ * @private
+ */
+static void enxlog_sink_shm_commit(struct enxlog_sink_shm_context *ctx);
+
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_sink_shm_context *enxlog_sink_shm_create()
+{
+    struct enxlog_sink_shm_context *ctx = malloc(sizeof(struct enxlog_sink_shm_context));
+    if (ctx) {
+        memset(ctx, 0, sizeof(struct enxlog_sink_shm_context));
+        ctx->fd = -1;
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_shm_destroy(void *context)
+{
+    struct enxlog_sink_shm_context *ctx = (struct enxlog_sink_shm_context *)context;
+
+    enxlog_sink_shm_shutdown(ctx);
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
+    free(ctx);
+}
+
+#endif
+
+
+bool enxlog_sink_shm_init(void *context)
+{
+    struct enxlog_sink_shm_context *ctx = (struct enxlog_sink_shm_context *)context;
+    size_t header_size = sizeof(struct enxlog_shm_ring_header);
+    size_t size = ctx->size - (ctx->size % ENXLOG_MMAP_RING_ALIGNMENT);
+    char name[ENXLOG_SHM_MAX_NAME + 1];
+    struct stat st;
+
+    if ((size < header_size + ENXLOG_MMAP_RING_ALIGNMENT * 4) ||
+        !enxlog_sink_shm_expand_name(name, sizeof(name), ctx->name)) {
+        return false;
+    }
+
+    ctx->record = malloc(ENXLOG_SHM_MAX_RECORD);
+    if (ctx->record == NULL) {
+        return false;
+    }
+
+    ctx->fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (ctx->fd < 0) {
+        goto error_open;
+    }
+
+    if (fstat(ctx->fd, &st) < 0) {
+        goto error_resize;
+    }
+
+    // Only resize when required, so that records the collector has not
+    // drained yet are kept
+    if (((size_t)st.st_size != size) && (ftruncate(ctx->fd, size) < 0)) {
+        goto error_resize;
+    }
+
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, ctx->fd, 0);
+    if (mapping == MAP_FAILED) {
+        goto error_resize;
+    }
+
+    ctx->header = (struct enxlog_shm_ring_header *)mapping;
+    ctx->data = (char *)mapping + header_size;
+
+    if (((size_t)st.st_size != size) || !enxlog_sink_shm_valid(ctx, size - header_size)) {
+        ctx->header->version = ENXLOG_SHM_RING_VERSION;
+        ctx->header->header_size = header_size;
+        ctx->header->capacity = size - header_size;
+        ctx->header->head = 0;
+        ctx->header->tail = 0;
+        ctx->header->dropped = 0;
+        ctx->header->sequence = 0;
+        ctx->header->waiters = 0;
+
+        // The collector ignores the ring until the magic is set
+        __atomic_store_n(&ctx->header->magic, ENXLOG_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&ctx->header->pid, (uint32_t)getpid(), __ATOMIC_RELEASE);
+
+    return true;
+
+error_resize:
+    close(ctx->fd);
+    ctx->fd = -1;
+
+error_open:
+    free(ctx->record);
+    ctx->record = NULL;
+
+    return false;
+}
+
+void enxlog_sink_shm_shutdown(void *context)
+{
+    struct enxlog_sink_shm_context *ctx = (struct enxlog_sink_shm_context *)context;
+
+    if (ctx->header) {
+        munmap(ctx->header, ctx->header->header_size + ctx->header->capacity);
+        ctx->header = NULL;
+        ctx->data = NULL;
+    }
+
+    if (ctx->fd >= 0) {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+
+    free(ctx->record);
+    ctx->record = NULL;
+}
+
+void enxlog_sink_shm_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_shm_context *ctx = (struct enxlog_sink_shm_context *)context;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
+
+    ctx->record_length = 0;
+
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &ctx->tag_length, logger, loglevel, func, line);
+    enxlog_sink_shm_append(ctx, header, length);
+}
+
+void enxlog_sink_shm_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_shm_context *ctx = (struct enxlog_sink_shm_context *)context;
+
+    enxlog_pattern_write_message(ctx->pattern, ctx->tag_length, ptr, length, enxlog_sink_shm_append, ctx);
+}
+
+void enxlog_sink_shm_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_shm_context *ctx = (struct enxlog_sink_shm_context *)context;
+
+    if (ctx->header) {
+        enxlog_sink_shm_commit(ctx);
+    }
+}
+
+static bool enxlog_sink_shm_expand_name(char *buffer, size_t size, const char *name)
+{
+    size_t length = 0;
+    int count;
+
+    if (name == NULL) {
+        return false;
+    }
+
+    while (*name) {
+        if ((name[0] == '%') && (name[1] == 'p')) {
+            count = snprintf(&buffer[length], size - length, "%d", (int)getpid());
+            if ((count < 0) || ((size_t)count >= size - length)) {
+                return false;
+            }
+
+            length += count;
+            name += 2;
+
+        } else {
+            if (length + 1 >= size) {
+                return false;
+            }
+
+            buffer[length++] = *name++;
+        }
+    }
+
+    buffer[length] = '\0';
+
+    return true;
+}
+
+static void enxlog_sink_shm_append(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_shm_context *ctx = (struct enxlog_sink_shm_context *)context;
+
+    size_t available = ENXLOG_SHM_MAX_RECORD - ctx->record_length;
+
+    if (ctx->record == NULL) {
+        return;
+    }
+
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&ctx->record[ctx->record_length], ptr, length);
+    ctx->record_length += length;
+}
+
+static bool enxlog_sink_shm_valid(
+    const struct enxlog_sink_shm_context *ctx,
+    uint64_t capacity)
+{
+    const struct enxlog_shm_ring_header *header = ctx->header;
+
+    return (header->magic == ENXLOG_SHM_RING_MAGIC) &&
+           (header->version == ENXLOG_SHM_RING_VERSION) &&
+           (header->header_size == sizeof(struct enxlog_shm_ring_header)) &&
+           (header->capacity == capacity) &&
+           (header->head < capacity) && (header->head % ENXLOG_MMAP_RING_ALIGNMENT == 0) &&
+           (header->tail < capacity) && (header->tail % ENXLOG_MMAP_RING_ALIGNMENT == 0);
+}
+
+static void enxlog_sink_shm_commit(struct enxlog_sink_shm_context *ctx)
+{
+    struct enxlog_shm_ring_header *header = ctx->header;
+    uint64_t capacity = header->capacity;
+    uint64_t head = header->head;
+    uint64_t tail = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+    uint64_t size = sizeof(struct enxlog_mmap_ring_record) + ctx->record_length;
+    size = (size + ENXLOG_MMAP_RING_ALIGNMENT - 1) & ~(uint64_t)(ENXLOG_MMAP_RING_ALIGNMENT - 1);
+
+    // The ring must never become completely full, as head == tail means
+    // empty. Records that do not fit are dropped rather than waiting for
+    // the collector.
+    if (head >= tail) {
+        if ((capacity - head < size) || ((capacity - head == size) && (tail == 0))) {
+            if (size >= tail) {
+                __atomic_add_fetch(&header->dropped, 1, __ATOMIC_RELAXED);
+                return;
+            }
+
+            // Wrap to the start. The marker is written before head moves.
+            struct enxlog_mmap_ring_record *marker = (struct enxlog_mmap_ring_record *)&ctx->data[head];
+            marker->length = ENXLOG_MMAP_RING_WRAP;
+            marker->reserved = 0;
+            head = 0;
+        }
+
+    } else if (tail - head <= size) {
+        __atomic_add_fetch(&header->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    struct enxlog_mmap_ring_record *record = (struct enxlog_mmap_ring_record *)&ctx->data[head];
+    record->length = ctx->record_length;
+    record->reserved = 0;
+    memcpy(record + 1, ctx->record, ctx->record_length);
+
+    head += size;
+    if (head == capacity) {
+        head = 0;
+    }
+
+    __atomic_store_n(&header->head, head, __ATOMIC_RELEASE);
+
+    // The collector sets waiters before it checks the ring, so either it
+    // sees the new head or this sees waiters
+    __atomic_add_fetch(&header->sequence, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&header->waiters, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &header->sequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
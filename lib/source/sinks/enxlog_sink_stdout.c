@@ -24,20 +24,28 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
+
+#ifndef ENXLOG_NO_HEAP
 
 struct enxlog_sink_stdout_context *enxlog_sink_stdout_create()
 {
-    return malloc(sizeof(struct enxlog_sink_stdout_context));
+    struct enxlog_sink_stdout_context *ctx = malloc(sizeof(struct enxlog_sink_stdout_context));
+    if (ctx) {
+        ctx->pattern = NULL;
+    }
+
+    return ctx;
 }
 
 void enxlog_sink_stdout_destroy(void *context)
 {
     struct enxlog_sink_stdout_context *ctx = (struct enxlog_sink_stdout_context *)context;
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
     free(ctx);
 }
 
+#endif
+
 bool enxlog_sink_stdout_init(void *context)
 {
     return true;
@@ -56,42 +64,14 @@ void enxlog_sink_stdout_log_entry_open(
     unsigned int line)
 {
     struct enxlog_sink_stdout_context *ctx = (struct enxlog_sink_stdout_context *)context;
-    ctx->tag_length = 0;
-
-    // Timestamp
-    struct timeval curTime;
-    gettimeofday(&curTime, NULL);
-    int milli = curTime.tv_usec / 1000;
-
-    struct tm *timeinfo;
-    timeinfo = localtime(&curTime.tv_sec);
-
-    char tag[64];
-    strftime(tag, sizeof(tag), "%Y-%m-%d %H:%M:%S", timeinfo);
-    ctx->tag_length += printf("%s.%03d ", tag, milli);
-
-    // Severity
-    switch (loglevel) {
-        case LOGLEVEL_ERROR: ctx->tag_length += printf("-- ERROR -- "); break;
-        case LOGLEVEL_WARN:  ctx->tag_length += printf("-- WARN  -- "); break;
-        case LOGLEVEL_INFO:  ctx->tag_length += printf("-- INFO  -- "); break;
-        case LOGLEVEL_DEBUG: ctx->tag_length += printf("-- DEBUG -- "); break;
-        case LOGLEVEL_TRACE: ctx->tag_length += printf("-- TRACE -- "); break;
-        default : break;
-    }
-
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
 
-    // Path
-    const char **name_part = logger->name;
-    while (*name_part) {
-        ctx->tag_length += printf("%s::", *name_part);
-        name_part++;
-    }
-
-    // Function and line
-    ctx->tag_length += printf("%s:%u: ", func, line);
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &ctx->tag_length, logger, loglevel, func, line);
+    fwrite(header, 1, length, stdout);
 }
 
+
 void enxlog_sink_stdout_log_entry_write(
     void *context,
     const char *ptr,
@@ -99,15 +79,7 @@ void enxlog_sink_stdout_log_entry_write(
 {
     struct enxlog_sink_stdout_context *ctx = (struct enxlog_sink_stdout_context *)context;
 
-    if ((length == 1) && *ptr == '\n') {
-        putc('\n', stdout);
-        for (size_t i=0; i < ctx->tag_length; ++i) {
-            putc(' ', stdout);
-        }
-
-    } else {
-        fwrite(ptr, 1, length, stdout);
-    }
+    enxlog_pattern_write_message(ctx->pattern, ctx->tag_length, ptr, length, enxlog_pattern_write_file, stdout);
 }
 
 void enxlog_sink_stdout_log_entry_close(
@@ -24,29 +24,29 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
 
 
-#define LOG_COLOR_BROWN "\x1b[33m"
-#define LOG_COLOR_WHITE "\x1b[97m"
-#define LOG_COLOR_RED "\x1b[31m"
-#define LOG_COLOR_GREEN "\x1b[32m"
-#define LOG_COLOR_DARK_GRAY "\x1b[90m"
-#define LOG_COLOR_YELLOW "\x1b[93m"
-#define LOG_COLOR_RESET "\x1b[0m"
+#ifndef ENXLOG_NO_HEAP
 
 struct enxlog_sink_stdout_color_context *enxlog_sink_stdout_color_create()
 {
-    return malloc(sizeof(struct enxlog_sink_stdout_color_context));
+    struct enxlog_sink_stdout_color_context *ctx = malloc(sizeof(struct enxlog_sink_stdout_color_context));
+    if (ctx) {
+        ctx->pattern = NULL;
+    }
+
+    return ctx;
 }
 
 void enxlog_sink_stdout_color_destroy(void *context)
 {
     struct enxlog_sink_stdout_color_context *ctx = (struct enxlog_sink_stdout_color_context *)context;
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
     free(ctx);
 }
 
+#endif
+
 bool enxlog_sink_stdout_color_init(void *context)
 {
     return true;
@@ -65,48 +65,14 @@ void enxlog_sink_stdout_color_log_entry_open(
     unsigned int line)
 {
     struct enxlog_sink_stdout_color_context *ctx = (struct enxlog_sink_stdout_color_context *)context;
-    ctx->tag_length = 0;
-
-    // Timestamp
-    struct timeval curTime;
-    gettimeofday(&curTime, NULL);
-    int milli = curTime.tv_usec / 1000;
-
-    struct tm* timeinfo;
-    timeinfo = localtime(&curTime.tv_sec);
-
-    char tag[64];
-    strftime(tag, sizeof(tag), "%Y-%m-%d %H:%M:%S", timeinfo);
-    fputs(LOG_COLOR_DARK_GRAY, stdout);
-    ctx->tag_length += printf("%s.%03d", tag, milli);
-    fputs(LOG_COLOR_RESET, stdout);
-    ctx->tag_length += printf(" ");
-
-    // Severity
-    switch (loglevel) {
-        case LOGLEVEL_ERROR:  fputs(LOG_COLOR_RED, stdout);      ctx->tag_length += printf("-- ERROR -- "); fputs(LOG_COLOR_RESET, stdout); break;
-        case LOGLEVEL_WARN:   fputs(LOG_COLOR_YELLOW, stdout);   ctx->tag_length += printf("-- WARN  -- "); fputs(LOG_COLOR_RESET, stdout); break;
-        case LOGLEVEL_INFO:   fputs(LOG_COLOR_RESET, stdout);    ctx->tag_length += printf("-- INFO  -- "); fputs(LOG_COLOR_RESET, stdout); break;
-        case LOGLEVEL_DEBUG:  fputs(LOG_COLOR_RESET, stdout);    ctx->tag_length += printf("-- DEBUG -- "); fputs(LOG_COLOR_RESET, stdout); break;
-        case LOGLEVEL_TRACE:  fputs(LOG_COLOR_RESET, stdout);    ctx->tag_length += printf("-- TRACE -- "); fputs(LOG_COLOR_RESET, stdout); break;
-        default : break;
-    }
-
-    fputs(LOG_COLOR_BROWN, stdout);
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default_color;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
 
-    // Path
-    const char **name_part = logger->name;
-    while (*name_part) {
-        ctx->tag_length += printf("%s::", *name_part);
-        name_part++;
-    }
-
-    // Function and line
-    ctx->tag_length += printf("%s:%u", func, line);
-    fputs(LOG_COLOR_RESET, stdout);
-    ctx->tag_length += printf(": ");
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &ctx->tag_length, logger, loglevel, func, line);
+    fwrite(header, 1, length, stdout);
 }
 
+
 void enxlog_sink_stdout_color_log_entry_write(
     void *context,
     const char *ptr,
@@ -114,15 +80,7 @@ void enxlog_sink_stdout_color_log_entry_write(
 {
     struct enxlog_sink_stdout_color_context *ctx = (struct enxlog_sink_stdout_color_context *)context;
 
-    if ((length == 1) && *ptr == '\n') {
-        putc('\n', stdout);
-        for (size_t i=0; i < ctx->tag_length; ++i) {
-            putc(' ', stdout);
-        }
-
-    } else {
-        fwrite(ptr, 1, length, stdout);
-    }
+    enxlog_pattern_write_message(ctx->pattern, ctx->tag_length, ptr, length, enxlog_pattern_write_file, stdout);
 }
 
 void enxlog_sink_stdout_color_log_entry_close(
@@ -0,0 +1,604 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include <enx/log/sinks/enxlog_sink_syslog.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+
+/**
+ * The maximum length of the constant part of the syslog header
+ */
+#define ENXLOG_SYSLOG_MAX_PREFIX 384
+
+/**
+ * The number of times shutdown waits for the receiver before dropping
+ * whatever is still queued
+ */
+#define ENXLOG_SYSLOG_SHUTDOWN_ATTEMPTS 10
+
+struct enxlog_syslog_state
+{
+    int fd;
+    struct sockaddr_storage address;
+    socklen_t address_length;
+
+    char *records;
+    size_t *lengths;
+    unsigned int queue_length;
+    unsigned int head;
+    unsigned int count;
+
+    struct mmsghdr *messages;
+    struct iovec *iov;
+    unsigned int batch_size;
+
+    // Hostname, app name and process id, which are the same for every record
+    char prefix[ENXLOG_SYSLOG_MAX_PREFIX];
+    size_t prefix_length;
+    unsigned int facility;
+
+    // The record being assembled, or NULL when it is being dropped
+    char *record;
+    size_t record_length;
+    size_t tag_length;
+
+    uint64_t dropped;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    pthread_t thread;
+    bool running;
+    unsigned int flush_interval_ms;
+};
+
+/**
+ * The compiled #ENXLOG_PATTERN_DEFAULT_SYSLOG pattern. Newlines are escaped
+ * so that every record stays on one line.
+ */
+static const struct enxlog_pattern enxlog_sink_syslog_pattern_default = {
+    .ops = {
+        { .type = ENXLOG_PATTERN_OP_LOGGER },
+        { .type = ENXLOG_PATTERN_OP_FUNC },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 1, .offset = 0 },
+        { .type = ENXLOG_PATTERN_OP_LINE },
+        { .type = ENXLOG_PATTERN_OP_LITERAL, .length = 2, .offset = 0 }
+    },
+    .count = 5,
+    .literals = ": ",
+    .literals_length = 2,
+    .newline = ENXLOG_PATTERN_NEWLINE_ESCAPE
+};
+
+
+/**
+ * Creates the socket and fills in the receiver address
+ * @private
+ */
+static bool enxlog_syslog_open_socket(
+    struct enxlog_sink_syslog_context *ctx,
+    struct enxlog_syslog_state *state);
+
+/**
+ * Formats the hostname, app name and process id part of the header
+ * @private
+ */
+static void enxlog_syslog_format_prefix(
+    struct enxlog_sink_syslog_context *ctx,
+    struct enxlog_syslog_state *state);
+
+/**
+ * Sends queued records in batches until the queue is empty or the
+ * receiver stops accepting them
+ * @private
+ */
+static void enxlog_syslog_send(struct enxlog_syslog_state *state);
+
+/**
+ * Starts assembling a record in the queue. The caller must hold the mutex.
+ * @private
+ */
+static void enxlog_syslog_record_begin(
+    struct enxlog_sink_syslog_context *ctx,
+    struct enxlog_syslog_state *state,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line);
+
+/**
+ * Queues the record being assembled, sending a batch once enough records
+ * are queued. The caller must hold the mutex.
+ * @private
+ */
+static void enxlog_syslog_record_end(struct enxlog_syslog_state *state);
+
+/**
+ * Appends data to the record being assembled
+ * @private
+ */
+static void enxlog_syslog_append(
+    void *arg,
+    const char *ptr,
+    size_t length);
+
+/**
+ * Sends partial batches and retries once the flush interval expires
+ * @private
+ */
+static void *enxlog_syslog_thread(void *arg);
+
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_sink_syslog_context *enxlog_sink_syslog_create()
+{
+    struct enxlog_sink_syslog_context *ctx = malloc(sizeof(struct enxlog_sink_syslog_context));
+    if (ctx) {
+        memset(ctx, 0, sizeof(struct enxlog_sink_syslog_context));
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_syslog_destroy(void *context)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+
+    enxlog_sink_syslog_shutdown(ctx);
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
+    free(ctx);
+}
+
+#endif
+
+
+bool enxlog_sink_syslog_init(void *context)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+
+    struct enxlog_syslog_state *state = malloc(sizeof(struct enxlog_syslog_state));
+    if (state == NULL) {
+        return false;
+    }
+
+    memset(state, 0, sizeof(struct enxlog_syslog_state));
+    state->queue_length = ctx->queue_length ? ctx->queue_length : ENXLOG_SYSLOG_QUEUE_LENGTH;
+    state->batch_size = ctx->batch_size ? ctx->batch_size : ENXLOG_SYSLOG_BATCH_SIZE;
+    state->flush_interval_ms = ctx->flush_interval_ms ? ctx->flush_interval_ms : ENXLOG_SYSLOG_FLUSH_INTERVAL_MS;
+    state->facility = ctx->facility ? ctx->facility : ENXLOG_SYSLOG_FACILITY_USER;
+
+    if (state->batch_size > state->queue_length) {
+        state->batch_size = state->queue_length;
+    }
+
+    if (!enxlog_syslog_open_socket(ctx, state)) {
+        goto error_socket;
+    }
+
+    state->records = malloc((size_t)state->queue_length * ENXLOG_SYSLOG_MAX_RECORD);
+    state->lengths = calloc(state->queue_length, sizeof(size_t));
+    state->messages = calloc(state->batch_size, sizeof(struct mmsghdr));
+    state->iov = calloc(state->batch_size, sizeof(struct iovec));
+    if (!state->records || !state->lengths || !state->messages || !state->iov) {
+        goto error_buffers;
+    }
+
+    enxlog_syslog_format_prefix(ctx, state);
+
+    pthread_mutex_init(&state->mutex, NULL);
+    pthread_cond_init(&state->condition, NULL);
+    state->running = true;
+    if (pthread_create(&state->thread, NULL, enxlog_syslog_thread, state) != 0) {
+        goto error_thread;
+    }
+
+    ctx->state = state;
+    return true;
+
+error_thread:
+    pthread_cond_destroy(&state->condition);
+    pthread_mutex_destroy(&state->mutex);
+
+error_buffers:
+    free(state->iov);
+    free(state->messages);
+    free(state->lengths);
+    free(state->records);
+    close(state->fd);
+
+error_socket:
+    free(state);
+
+    return false;
+}
+
+void enxlog_sink_syslog_shutdown(void *context)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+    struct enxlog_syslog_state *state = ctx->state;
+    struct pollfd pfd;
+
+    if (state == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+    state->running = false;
+    pthread_cond_signal(&state->condition);
+    pthread_mutex_unlock(&state->mutex);
+    pthread_join(state->thread, NULL);
+
+    // Give the receiver a little time to take what is left
+    for (unsigned int i = 0; state->count && (i < ENXLOG_SYSLOG_SHUTDOWN_ATTEMPTS); ++i) {
+        enxlog_syslog_send(state);
+        if (state->count) {
+            pfd.fd = state->fd;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, state->flush_interval_ms);
+        }
+    }
+    state->dropped += state->count;
+
+    pthread_cond_destroy(&state->condition);
+    pthread_mutex_destroy(&state->mutex);
+
+    free(state->iov);
+    free(state->messages);
+    free(state->lengths);
+    free(state->records);
+    close(state->fd);
+    free(state);
+    ctx->state = NULL;
+}
+
+void enxlog_sink_syslog_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+    struct enxlog_syslog_state *state = ctx->state;
+
+    // Held until the entry is closed so that the flush thread never sends
+    // half a record
+    pthread_mutex_lock(&state->mutex);
+
+    enxlog_syslog_record_begin(ctx, state, logger, loglevel, func, line);
+}
+
+void enxlog_sink_syslog_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+    struct enxlog_syslog_state *state = ctx->state;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_sink_syslog_pattern_default;
+
+    if (state->record) {
+        enxlog_pattern_write_message(pattern, state->tag_length, ptr, length, enxlog_syslog_append, state);
+    }
+}
+
+void enxlog_sink_syslog_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+    struct enxlog_syslog_state *state = ctx->state;
+
+    enxlog_syslog_record_end(state);
+
+    pthread_mutex_unlock(&state->mutex);
+}
+
+void enxlog_sink_syslog_log_batch(
+    void *context,
+    const struct enxlog_record *records,
+    size_t count)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+    struct enxlog_syslog_state *state = ctx->state;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_sink_syslog_pattern_default;
+
+    pthread_mutex_lock(&state->mutex);
+
+    for (size_t i = 0; i < count; ++i) {
+        const struct enxlog_record *record = &records[i];
+
+        enxlog_record_select(record);
+        enxlog_syslog_record_begin(ctx, state, record->logger, record->loglevel, record->func, record->line);
+
+        if (state->record) {
+            enxlog_pattern_write_message(pattern, state->tag_length, record->message, record->length, enxlog_syslog_append, state);
+        }
+
+        enxlog_syslog_record_end(state);
+    }
+
+    // Whatever is left of the batch goes out now rather than on the next
+    // flush interval
+    enxlog_syslog_send(state);
+
+    pthread_mutex_unlock(&state->mutex);
+}
+
+uint64_t enxlog_sink_syslog_dropped(void *context)
+{
+    struct enxlog_sink_syslog_context *ctx = (struct enxlog_sink_syslog_context *)context;
+    struct enxlog_syslog_state *state = ctx->state;
+    uint64_t dropped;
+
+    if (state == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+    dropped = state->dropped;
+    pthread_mutex_unlock(&state->mutex);
+
+    return dropped;
+}
+
+static bool enxlog_syslog_open_socket(
+    struct enxlog_sink_syslog_context *ctx,
+    struct enxlog_syslog_state *state)
+{
+    memset(&state->address, 0, sizeof(state->address));
+
+    if (ctx->port) {
+        struct sockaddr_in *address = (struct sockaddr_in *)&state->address;
+
+        if (ctx->port > 65535) {
+            return false;
+        }
+
+        address->sin_family = AF_INET;
+        address->sin_port = htons(ctx->port);
+        address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        state->address_length = sizeof(struct sockaddr_in);
+
+    } else {
+        struct sockaddr_un *address = (struct sockaddr_un *)&state->address;
+        const char *path = ctx->path ? ctx->path : ENXLOG_SYSLOG_PATH;
+
+        if (strlen(path) >= sizeof(address->sun_path)) {
+            return false;
+        }
+
+        address->sun_family = AF_UNIX;
+        strcpy(address->sun_path, path);
+        state->address_length = sizeof(struct sockaddr_un);
+    }
+
+    // Left unconnected, so that a restarted receiver is picked up without
+    // reconnecting
+    state->fd = socket(state->address.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    return state->fd >= 0;
+}
+
+static void enxlog_syslog_format_prefix(
+    struct enxlog_sink_syslog_context *ctx,
+    struct enxlog_syslog_state *state)
+{
+    char hostname[256];
+    char app_name[49];
+    size_t i;
+
+    if ((gethostname(hostname, sizeof(hostname)) != 0) || (hostname[0] == '\0')) {
+        strcpy(hostname, "-");
+    }
+    hostname[sizeof(hostname) - 1] = '\0';
+
+    // APP-NAME is at most 48 printable characters without spaces
+    snprintf(app_name, sizeof(app_name), "%s", ctx->app_name ? ctx->app_name : program_invocation_short_name);
+    for (i = 0; app_name[i]; ++i) {
+        if ((app_name[i] <= ' ') || (app_name[i] > '~')) {
+            app_name[i] = '_';
+        }
+    }
+    if (app_name[0] == '\0') {
+        strcpy(app_name, "-");
+    }
+
+    // HOSTNAME APP-NAME PROCID MSGID STRUCTURED-DATA
+    int length = snprintf(state->prefix, sizeof(state->prefix), "%s %s %d - - ", hostname, app_name, (int)getpid());
+    if (length < 0) {
+        length = 0;
+    } else if ((size_t)length >= sizeof(state->prefix)) {
+        length = sizeof(state->prefix) - 1;
+    }
+
+    state->prefix_length = length;
+}
+
+static void enxlog_syslog_send(struct enxlog_syslog_state *state)
+{
+    while (state->count) {
+        unsigned int count = (state->count < state->batch_size) ? state->count : state->batch_size;
+
+        for (unsigned int i = 0; i < count; ++i) {
+            unsigned int index = (state->head + i) % state->queue_length;
+
+            state->iov[i].iov_base = &state->records[(size_t)index * ENXLOG_SYSLOG_MAX_RECORD];
+            state->iov[i].iov_len = state->lengths[index];
+
+            memset(&state->messages[i].msg_hdr, 0, sizeof(struct msghdr));
+            state->messages[i].msg_hdr.msg_name = &state->address;
+            state->messages[i].msg_hdr.msg_namelen = state->address_length;
+            state->messages[i].msg_hdr.msg_iov = &state->iov[i];
+            state->messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent = sendmmsg(state->fd, state->messages, count, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // Keep the records for the next attempt while the receiver is
+            // busy
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS)) {
+                return;
+            }
+
+            // The receiver is missing or rejected the record
+            sent = 1;
+            state->dropped++;
+        }
+
+        state->head = (state->head + sent) % state->queue_length;
+        state->count -= sent;
+    }
+}
+
+static void enxlog_syslog_record_begin(
+    struct enxlog_sink_syslog_context *ctx,
+    struct enxlog_syslog_state *state,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_sink_syslog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
+    struct timeval tv;
+    struct tm tm;
+    unsigned int severity;
+
+    if (state->count == state->queue_length) {
+        enxlog_syslog_send(state);
+    }
+
+    if (state->count == state->queue_length) {
+        state->record = NULL;
+        state->dropped++;
+        return;
+    }
+
+    state->record = &state->records[(size_t)((state->head + state->count) % state->queue_length) * ENXLOG_SYSLOG_MAX_RECORD];
+    state->record_length = 0;
+
+    // RFC 5424 severities: error, warning, informational and debug
+    switch (loglevel) {
+        case LOGLEVEL_ERROR: severity = 3; break;
+        case LOGLEVEL_WARN: severity = 4; break;
+        case LOGLEVEL_INFO: severity = 6; break;
+        default: severity = 7; break;
+    }
+
+    enxlog_entry_time(&tv);
+    gmtime_r(&tv.tv_sec, &tm);
+
+    // <PRI>VERSION TIMESTAMP, followed by the constant part of the header
+    int length = snprintf(
+        state->record,
+        ENXLOG_SYSLOG_MAX_RECORD,
+        "<%u>1 %04d-%02d-%02dT%02d:%02d:%02d.%06ldZ ",
+        state->facility * 8 + severity,
+        tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+        tm.tm_hour, tm.tm_min, tm.tm_sec, (long)tv.tv_usec);
+    if ((length > 0) && (length < ENXLOG_SYSLOG_MAX_RECORD)) {
+        state->record_length = length;
+    }
+
+    enxlog_syslog_append(state, state->prefix, state->prefix_length);
+
+    size_t header_length = enxlog_pattern_format(pattern, header, sizeof(header), &state->tag_length, logger, loglevel, func, line);
+    enxlog_syslog_append(state, header, header_length);
+}
+
+static void enxlog_syslog_record_end(struct enxlog_syslog_state *state)
+{
+    if (state->record) {
+        state->lengths[(state->head + state->count) % state->queue_length] = state->record_length;
+        state->count++;
+        state->record = NULL;
+
+        if (state->count >= state->batch_size) {
+            enxlog_syslog_send(state);
+        }
+    }
+}
+
+static void enxlog_syslog_append(
+    void *arg,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_syslog_state *state = (struct enxlog_syslog_state *)arg;
+    size_t available = ENXLOG_SYSLOG_MAX_RECORD - state->record_length;
+
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&state->record[state->record_length], ptr, length);
+    state->record_length += length;
+}
+
+static void *enxlog_syslog_thread(void *arg)
+{
+    struct enxlog_syslog_state *state = (struct enxlog_syslog_state *)arg;
+    struct timespec deadline;
+
+    pthread_mutex_lock(&state->mutex);
+
+    while (state->running) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += state->flush_interval_ms / 1000;
+        deadline.tv_nsec += (state->flush_interval_ms % 1000) * 1000000l;
+        if (deadline.tv_nsec >= 1000000000l) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000l;
+        }
+
+        pthread_cond_timedwait(&state->condition, &state->mutex, &deadline);
+        if (!state->running) {
+            break;
+        }
+
+        enxlog_syslog_send(state);
+    }
+
+    pthread_mutex_unlock(&state->mutex);
+
+    return NULL;
+}
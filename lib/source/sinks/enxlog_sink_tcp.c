@@ -0,0 +1,917 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include <enx/log/sinks/enxlog_sink_tcp.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+
+/**
+ * Records in the memory buffer are aligned to this, so that their length
+ * never straddles the end of the buffer
+ */
+#define ENXLOG_TCP_ALIGNMENT 4
+
+/**
+ * Length that marks the rest of the memory buffer as unused
+ */
+#define ENXLOG_TCP_WRAP 0xffffffffu
+
+/**
+ * The maximum number of records sent in one call
+ */
+#define ENXLOG_TCP_MAX_IOV 64
+
+/**
+ * The size of the reads from the spill file. Holds at least one record.
+ */
+#define ENXLOG_TCP_SPILL_CHUNK (64 * 1024)
+
+struct enxlog_tcp_state
+{
+    const char *host;
+    unsigned int port;
+    enum enxlog_sink_tcp_framing framing;
+    int fd;
+
+    // Records as a 32 bit big endian length followed by the record, the
+    // same layout as length framing on the wire
+    char *buffer;
+    size_t capacity;
+    size_t head;
+    size_t tail;
+
+    // Records in the same layout, without padding
+    int spill_fd;
+    uint64_t spill_size;
+    uint64_t spill_length;
+    uint64_t spill_sent;
+    char *spill_chunk;
+
+    char record[4 + ENXLOG_TCP_MAX_RECORD];
+    size_t record_length;
+    size_t tag_length;
+
+    uint64_t dropped;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    pthread_t thread;
+    bool running;
+    unsigned int flush_interval_ms;
+};
+
+
+/**
+ * Opens the spill file and drops a partly written record at its end
+ * @private
+ */
+static bool enxlog_tcp_open_spill(struct enxlog_tcp_state *state, const char *path);
+
+/**
+ * Connects to the collector
+ * @returns The connected socket, or -1
+ * @private
+ */
+static int enxlog_tcp_connect(const char *host, unsigned int port);
+
+/**
+ * Sends the contents of the memory buffer. Called with the mutex held,
+ * which is released while sending.
+ * @returns false if the connection failed
+ * @private
+ */
+static bool enxlog_tcp_send_buffer(struct enxlog_tcp_state *state);
+
+/**
+ * Sends the contents of the spill file. Called with the mutex held, which
+ * is released while sending.
+ * @returns false if the connection failed
+ * @private
+ */
+static bool enxlog_tcp_send_spill(struct enxlog_tcp_state *state);
+
+/**
+ * Sends a batch of records, continuing after short writes
+ * @param completed Receives the number of records that were sent in full
+ * @private
+ */
+static bool enxlog_tcp_send(int fd, struct iovec *iov, size_t count, size_t *completed);
+
+/**
+ * Describes a stored record as it is framed on the wire
+ * @private
+ */
+static void enxlog_tcp_frame(
+    const struct enxlog_tcp_state *state,
+    struct iovec *iov,
+    char *record,
+    uint32_t length);
+
+/**
+ * Stores the assembled record in the memory buffer, the spill file, or
+ * drops it
+ * @private
+ */
+static void enxlog_tcp_commit(struct enxlog_tcp_state *state);
+
+/**
+ * Copies a record into the memory buffer
+ * @returns false if it does not fit
+ * @private
+ */
+static bool enxlog_tcp_buffer_push(struct enxlog_tcp_state *state, const char *record, size_t length);
+
+/**
+ * Appends a record to the spill file
+ * @returns false if it does not fit
+ * @private
+ */
+static bool enxlog_tcp_spill_push(struct enxlog_tcp_state *state, const char *record, size_t length);
+
+/**
+ * Writes the records that are still in memory to the spill file at
+ * shutdown, or counts them as dropped without one
+ * @private
+ */
+static void enxlog_tcp_save(struct enxlog_tcp_state *state, const char *path);
+
+/**
+ * Appends data to the record being assembled
+ * @private
+ */
+static void enxlog_tcp_append(
+    void *arg,
+    const char *ptr,
+    size_t length);
+
+/**
+ * Waits on the condition for up to the given time
+ * @private
+ */
+static void enxlog_tcp_wait(struct enxlog_tcp_state *state, unsigned int ms);
+
+/**
+ * Connects and sends buffered records
+ * @private
+ */
+static void *enxlog_tcp_thread(void *arg);
+
+/** @private */
+static uint32_t enxlog_tcp_read32(const char *ptr);
+
+/** @private */
+static void enxlog_tcp_write32(char *ptr, uint32_t value);
+
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_sink_tcp_context *enxlog_sink_tcp_create()
+{
+    struct enxlog_sink_tcp_context *ctx = malloc(sizeof(struct enxlog_sink_tcp_context));
+    if (ctx) {
+        memset(ctx, 0, sizeof(struct enxlog_sink_tcp_context));
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_tcp_destroy(void *context)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+
+    enxlog_sink_tcp_shutdown(ctx);
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
+    free(ctx);
+}
+
+#endif
+
+
+bool enxlog_sink_tcp_init(void *context)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+
+    if ((ctx->host == NULL) || (ctx->port == 0) || (ctx->port > 65535)) {
+        return false;
+    }
+
+    struct enxlog_tcp_state *state = malloc(sizeof(struct enxlog_tcp_state));
+    if (state == NULL) {
+        return false;
+    }
+
+    memset(state, 0, sizeof(struct enxlog_tcp_state));
+    state->host = ctx->host;
+    state->port = ctx->port;
+    state->framing = ctx->framing;
+    state->fd = -1;
+    state->spill_fd = -1;
+    state->capacity = ctx->buffer_size ? ctx->buffer_size : ENXLOG_TCP_BUFFER_SIZE;
+    state->capacity -= state->capacity % ENXLOG_TCP_ALIGNMENT;
+    state->spill_size = ctx->spill_size ? ctx->spill_size : ENXLOG_TCP_SPILL_SIZE;
+    state->flush_interval_ms = ctx->flush_interval_ms ? ctx->flush_interval_ms : ENXLOG_TCP_FLUSH_INTERVAL_MS;
+
+    if (state->capacity < ENXLOG_TCP_ALIGNMENT * 4) {
+        goto error_buffer;
+    }
+
+    state->buffer = malloc(state->capacity);
+    if (state->buffer == NULL) {
+        goto error_buffer;
+    }
+
+    if (ctx->spill_path && !enxlog_tcp_open_spill(state, ctx->spill_path)) {
+        goto error_spill;
+    }
+
+    pthread_mutex_init(&state->mutex, NULL);
+    pthread_cond_init(&state->condition, NULL);
+    state->running = true;
+    if (pthread_create(&state->thread, NULL, enxlog_tcp_thread, state) != 0) {
+        goto error_thread;
+    }
+
+    ctx->state = state;
+    return true;
+
+error_thread:
+    pthread_cond_destroy(&state->condition);
+    pthread_mutex_destroy(&state->mutex);
+    if (state->spill_fd >= 0) {
+        close(state->spill_fd);
+    }
+    free(state->spill_chunk);
+
+error_spill:
+    free(state->buffer);
+
+error_buffer:
+    free(state);
+
+    return false;
+}
+
+void enxlog_sink_tcp_shutdown(void *context)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+    struct enxlog_tcp_state *state = ctx->state;
+
+    if (state == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+    state->running = false;
+    pthread_cond_signal(&state->condition);
+    pthread_mutex_unlock(&state->mutex);
+    pthread_join(state->thread, NULL);
+
+    // Keep what could not be sent for the next process
+    enxlog_tcp_save(state, ctx->spill_path);
+
+    if (state->fd >= 0) {
+        close(state->fd);
+    }
+
+    if (state->spill_fd >= 0) {
+        close(state->spill_fd);
+    }
+
+    pthread_cond_destroy(&state->condition);
+    pthread_mutex_destroy(&state->mutex);
+
+    free(state->spill_chunk);
+    free(state->buffer);
+    free(state);
+    ctx->state = NULL;
+}
+
+void enxlog_sink_tcp_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+    struct enxlog_tcp_state *state = ctx->state;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
+
+    // Held until the entry is closed. The sender thread only takes it to
+    // move the buffer positions, never while it is on the network.
+    pthread_mutex_lock(&state->mutex);
+
+    state->record_length = 4;
+
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &state->tag_length, logger, loglevel, func, line);
+    enxlog_tcp_append(state, header, length);
+}
+
+void enxlog_sink_tcp_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+    struct enxlog_tcp_state *state = ctx->state;
+
+    enxlog_pattern_write_message(ctx->pattern, state->tag_length, ptr, length, enxlog_tcp_append, state);
+}
+
+void enxlog_sink_tcp_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+    struct enxlog_tcp_state *state = ctx->state;
+
+    // There is always room for the newline, see enxlog_tcp_append
+    if (state->framing == ENXLOG_SINK_TCP_FRAMING_NEWLINE) {
+        state->record[state->record_length++] = '\n';
+    }
+
+    enxlog_tcp_write32(state->record, state->record_length - 4);
+    enxlog_tcp_commit(state);
+
+    pthread_mutex_unlock(&state->mutex);
+}
+
+uint64_t enxlog_sink_tcp_dropped(void *context)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+    struct enxlog_tcp_state *state = ctx->state;
+    uint64_t dropped;
+
+    if (state == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+    dropped = state->dropped;
+    pthread_mutex_unlock(&state->mutex);
+
+    return dropped;
+}
+
+bool enxlog_sink_tcp_connected(void *context)
+{
+    struct enxlog_sink_tcp_context *ctx = (struct enxlog_sink_tcp_context *)context;
+    struct enxlog_tcp_state *state = ctx->state;
+    bool connected;
+
+    if (state == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+    connected = (state->fd >= 0);
+    pthread_mutex_unlock(&state->mutex);
+
+    return connected;
+}
+
+static bool enxlog_tcp_open_spill(struct enxlog_tcp_state *state, const char *path)
+{
+    uint64_t offset = 0;
+
+    state->spill_chunk = malloc(ENXLOG_TCP_SPILL_CHUNK);
+    if (state->spill_chunk == NULL) {
+        return false;
+    }
+
+    state->spill_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (state->spill_fd < 0) {
+        free(state->spill_chunk);
+        state->spill_chunk = NULL;
+        return false;
+    }
+
+    // Records left by an earlier process are sent first. A record that was
+    // only partly written before a crash ends the file.
+    for (;;) {
+        ssize_t result = pread(state->spill_fd, state->spill_chunk, ENXLOG_TCP_SPILL_CHUNK, offset);
+        size_t position = 0;
+
+        while ((result > 0) && (position + 4 <= (size_t)result)) {
+            uint32_t length = enxlog_tcp_read32(&state->spill_chunk[position]);
+            if ((length > ENXLOG_TCP_MAX_RECORD) || (position + 4 + length > (size_t)result)) {
+                break;
+            }
+            position += 4 + length;
+        }
+
+        if (position == 0) {
+            break;
+        }
+
+        offset += position;
+    }
+
+    if (ftruncate(state->spill_fd, offset) < 0) {
+        close(state->spill_fd);
+        state->spill_fd = -1;
+        free(state->spill_chunk);
+        state->spill_chunk = NULL;
+        return false;
+    }
+
+    state->spill_length = offset;
+    state->spill_sent = 0;
+
+    return true;
+}
+
+static int enxlog_tcp_connect(const char *host, unsigned int port)
+{
+    struct addrinfo hints;
+    struct addrinfo *result;
+    struct addrinfo *ai;
+    char service[8];
+    int fd = -1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(service, sizeof(service), "%u", port);
+
+    if (getaddrinfo(host, service, &hints, &result) != 0) {
+        return -1;
+    }
+
+    for (ai = result; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+
+        if (errno == EINPROGRESS) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            int error = 0;
+            socklen_t error_length = sizeof(error);
+
+            if ((poll(&pfd, 1, ENXLOG_TCP_TIMEOUT_MS) == 1) &&
+                (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_length) == 0) &&
+                (error == 0)) {
+                break;
+            }
+        }
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(result);
+
+    if (fd >= 0) {
+        // Sends block in the sender thread, up to the timeout
+        struct timeval timeout = {
+            .tv_sec = ENXLOG_TCP_TIMEOUT_MS / 1000,
+            .tv_usec = (ENXLOG_TCP_TIMEOUT_MS % 1000) * 1000
+        };
+        int enable = 1;
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // Records are already batched, so the last batch should not wait
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+
+    return fd;
+}
+
+static bool enxlog_tcp_send_buffer(struct enxlog_tcp_state *state)
+{
+    struct iovec iov[ENXLOG_TCP_MAX_IOV];
+    size_t ends[ENXLOG_TCP_MAX_IOV];
+    size_t completed;
+
+    while (state->tail != state->head) {
+        size_t position = state->tail;
+        size_t count = 0;
+
+        while ((position != state->head) && (count < ENXLOG_TCP_MAX_IOV)) {
+            uint32_t length = enxlog_tcp_read32(&state->buffer[position]);
+            if (length == ENXLOG_TCP_WRAP) {
+                position = 0;
+                continue;
+            }
+
+            enxlog_tcp_frame(state, &iov[count], &state->buffer[position], length);
+
+            position += (4 + length + ENXLOG_TCP_ALIGNMENT - 1) & ~(size_t)(ENXLOG_TCP_ALIGNMENT - 1);
+            if (position == state->capacity) {
+                position = 0;
+            }
+            ends[count++] = position;
+        }
+
+        // Only a wrap marker was left
+        if (count == 0) {
+            state->tail = position;
+            continue;
+        }
+
+        // The records between tail and head are not touched by the writers
+        int fd = state->fd;
+        pthread_mutex_unlock(&state->mutex);
+        bool result = enxlog_tcp_send(fd, iov, count, &completed);
+        pthread_mutex_lock(&state->mutex);
+
+        if (completed) {
+            state->tail = ends[completed - 1];
+        }
+
+        if (!result) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool enxlog_tcp_send_spill(struct enxlog_tcp_state *state)
+{
+    struct iovec iov[ENXLOG_TCP_MAX_IOV];
+    size_t ends[ENXLOG_TCP_MAX_IOV];
+    size_t completed;
+
+    while (state->spill_sent < state->spill_length) {
+        uint64_t offset = state->spill_sent;
+        uint64_t remaining = state->spill_length - offset;
+        size_t available = (remaining < ENXLOG_TCP_SPILL_CHUNK) ? remaining : ENXLOG_TCP_SPILL_CHUNK;
+        int fd = state->fd;
+
+        // Writers only append beyond spill_length
+        pthread_mutex_unlock(&state->mutex);
+
+        ssize_t result = pread(state->spill_fd, state->spill_chunk, available, offset);
+        size_t position = 0;
+        size_t count = 0;
+
+        while ((result > 0) && (position + 4 <= (size_t)result) && (count < ENXLOG_TCP_MAX_IOV)) {
+            uint32_t length = enxlog_tcp_read32(&state->spill_chunk[position]);
+            if (position + 4 + length > (size_t)result) {
+                break;
+            }
+
+            enxlog_tcp_frame(state, &iov[count], &state->spill_chunk[position], length);
+            position += 4 + length;
+            ends[count++] = position;
+        }
+
+        bool sent = (count > 0) && enxlog_tcp_send(fd, iov, count, &completed);
+
+        pthread_mutex_lock(&state->mutex);
+
+        if (count == 0) {
+            // The file could not be read back, so its contents are lost
+            state->spill_sent = state->spill_length;
+            break;
+        }
+
+        if (completed) {
+            state->spill_sent = offset + ends[completed - 1];
+        }
+
+        if (!sent) {
+            return false;
+        }
+    }
+
+    // Writers go back to the memory buffer once the spill file is empty
+    if (state->spill_length && (state->spill_sent == state->spill_length)) {
+        if (ftruncate(state->spill_fd, 0) == 0) {
+            state->spill_length = 0;
+            state->spill_sent = 0;
+        }
+    }
+
+    return true;
+}
+
+static bool enxlog_tcp_send(int fd, struct iovec *iov, size_t count, size_t *completed)
+{
+    struct msghdr message;
+    size_t index = 0;
+
+    *completed = 0;
+
+    while (index < count) {
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov[index];
+        message.msg_iovlen = count - index;
+
+        ssize_t result = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        while ((index < count) && ((size_t)result >= iov[index].iov_len)) {
+            result -= iov[index].iov_len;
+            index++;
+        }
+
+        if (index < count) {
+            iov[index].iov_base = (char *)iov[index].iov_base + result;
+            iov[index].iov_len -= result;
+        }
+
+        *completed = index;
+    }
+
+    return true;
+}
+
+static void enxlog_tcp_frame(
+    const struct enxlog_tcp_state *state,
+    struct iovec *iov,
+    char *record,
+    uint32_t length)
+{
+    if (state->framing == ENXLOG_SINK_TCP_FRAMING_LENGTH) {
+        iov->iov_base = record;
+        iov->iov_len = 4 + length;
+    } else {
+        iov->iov_base = record + 4;
+        iov->iov_len = length;
+    }
+}
+
+static void enxlog_tcp_commit(struct enxlog_tcp_state *state)
+{
+    // While the spill file holds records, new ones are appended to it so
+    // that they are sent in order
+    if ((state->spill_length == 0) && enxlog_tcp_buffer_push(state, state->record, state->record_length)) {
+        return;
+    }
+
+    if (!enxlog_tcp_spill_push(state, state->record, state->record_length)) {
+        state->dropped++;
+    }
+}
+
+static bool enxlog_tcp_buffer_push(struct enxlog_tcp_state *state, const char *record, size_t length)
+{
+    size_t capacity = state->capacity;
+    size_t head = state->head;
+    size_t tail = state->tail;
+    size_t size = (length + ENXLOG_TCP_ALIGNMENT - 1) & ~(size_t)(ENXLOG_TCP_ALIGNMENT - 1);
+
+    // The buffer never becomes completely full, as head == tail means empty
+    if (head >= tail) {
+        if ((capacity - head < size) || ((capacity - head == size) && (tail == 0))) {
+            if (size >= tail) {
+                return false;
+            }
+
+            enxlog_tcp_write32(&state->buffer[head], ENXLOG_TCP_WRAP);
+            head = 0;
+        }
+
+    } else if (tail - head <= size) {
+        return false;
+    }
+
+    memcpy(&state->buffer[head], record, length);
+
+    head += size;
+    if (head == capacity) {
+        head = 0;
+    }
+    state->head = head;
+
+    // Wake the sender early once a large batch is waiting, unless it is
+    // backing off between connection attempts
+    size_t used = (head >= tail) ? head - tail : capacity - tail + head;
+    if ((used >= capacity / 4) && (state->fd >= 0)) {
+        pthread_cond_signal(&state->condition);
+    }
+
+    return true;
+}
+
+static bool enxlog_tcp_spill_push(struct enxlog_tcp_state *state, const char *record, size_t length)
+{
+    if ((state->spill_fd < 0) || (state->spill_length + length > state->spill_size)) {
+        return false;
+    }
+
+    if (pwrite(state->spill_fd, record, length, state->spill_length) != (ssize_t)length) {
+        return false;
+    }
+
+    state->spill_length += length;
+
+    return true;
+}
+
+static void enxlog_tcp_save(struct enxlog_tcp_state *state, const char *path)
+{
+    char *temporary = NULL;
+    int fd = state->spill_fd;
+    uint64_t length = 0;
+
+    // Records in memory are older than the ones in the spill file, and the
+    // part of the spill file that was sent must not be sent again, so a
+    // spill file that is in use is rewritten
+    if ((fd >= 0) && state->spill_length) {
+        temporary = malloc(strlen(path) + 5);
+        if (temporary) {
+            sprintf(temporary, "%s.tmp", path);
+            fd = open(temporary, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        }
+
+        if ((temporary == NULL) || (fd < 0)) {
+            free(temporary);
+            temporary = NULL;
+            fd = -1;
+        }
+    }
+
+    while (state->tail != state->head) {
+        uint32_t record_length = enxlog_tcp_read32(&state->buffer[state->tail]);
+        if (record_length == ENXLOG_TCP_WRAP) {
+            state->tail = 0;
+            continue;
+        }
+
+        if ((fd >= 0) && (length + 4 + record_length <= state->spill_size) &&
+            (pwrite(fd, &state->buffer[state->tail], 4 + record_length, length) == (ssize_t)(4 + record_length))) {
+            length += 4 + record_length;
+        } else {
+            state->dropped++;
+        }
+
+        state->tail += (4 + record_length + ENXLOG_TCP_ALIGNMENT - 1) & ~(size_t)(ENXLOG_TCP_ALIGNMENT - 1);
+        if (state->tail == state->capacity) {
+            state->tail = 0;
+        }
+    }
+
+    if (temporary) {
+        uint64_t offset = state->spill_sent;
+
+        while (offset < state->spill_length) {
+            uint64_t remaining = state->spill_length - offset;
+            ssize_t result = pread(
+                state->spill_fd,
+                state->spill_chunk,
+                (remaining < ENXLOG_TCP_SPILL_CHUNK) ? remaining : ENXLOG_TCP_SPILL_CHUNK,
+                offset);
+            if ((result <= 0) || (pwrite(fd, state->spill_chunk, result, length) != result)) {
+                break;
+            }
+
+            offset += result;
+            length += result;
+        }
+
+        if (rename(temporary, path) == 0) {
+            close(state->spill_fd);
+            state->spill_fd = fd;
+        } else {
+            close(fd);
+            unlink(temporary);
+        }
+
+        free(temporary);
+    }
+}
+
+static void enxlog_tcp_append(
+    void *arg,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_tcp_state *state = (struct enxlog_tcp_state *)arg;
+
+    // One byte is kept for the newline that ends the record
+    size_t available = sizeof(state->record) - 1 - state->record_length;
+    if (length > available) {
+        length = available;
+    }
+
+    memcpy(&state->record[state->record_length], ptr, length);
+    state->record_length += length;
+}
+
+static void enxlog_tcp_wait(struct enxlog_tcp_state *state, unsigned int ms)
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (ms % 1000) * 1000000l;
+    if (deadline.tv_nsec >= 1000000000l) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000l;
+    }
+
+    pthread_cond_timedwait(&state->condition, &state->mutex, &deadline);
+}
+
+static void *enxlog_tcp_thread(void *arg)
+{
+    struct enxlog_tcp_state *state = (struct enxlog_tcp_state *)arg;
+    unsigned int backoff = ENXLOG_TCP_RECONNECT_MIN_MS;
+
+    pthread_mutex_lock(&state->mutex);
+
+    while (state->running) {
+        if (state->fd < 0) {
+            pthread_mutex_unlock(&state->mutex);
+            int fd = enxlog_tcp_connect(state->host, state->port);
+            pthread_mutex_lock(&state->mutex);
+
+            state->fd = fd;
+            if (fd < 0) {
+                enxlog_tcp_wait(state, backoff);
+                backoff = (backoff * 2 < ENXLOG_TCP_RECONNECT_MAX_MS) ? backoff * 2 : ENXLOG_TCP_RECONNECT_MAX_MS;
+                continue;
+            }
+
+            backoff = ENXLOG_TCP_RECONNECT_MIN_MS;
+        }
+
+        // The memory buffer holds the oldest records
+        if (!enxlog_tcp_send_buffer(state) || !enxlog_tcp_send_spill(state)) {
+            close(state->fd);
+            state->fd = -1;
+            continue;
+        }
+
+        if (state->running) {
+            enxlog_tcp_wait(state, state->flush_interval_ms);
+        }
+    }
+
+    // Send what is left in memory. The spill file is kept for the next
+    // process instead.
+    if ((state->fd >= 0) && !enxlog_tcp_send_buffer(state)) {
+        close(state->fd);
+        state->fd = -1;
+    }
+
+    pthread_mutex_unlock(&state->mutex);
+
+    return NULL;
+}
+
+static uint32_t enxlog_tcp_read32(const char *ptr)
+{
+    const unsigned char *p = (const unsigned char *)ptr;
+
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void enxlog_tcp_write32(char *ptr, uint32_t value)
+{
+    ptr[0] = (char)(value >> 24);
+    ptr[1] = (char)(value >> 16);
+    ptr[2] = (char)(value >> 8);
+    ptr[3] = (char)value;
+}
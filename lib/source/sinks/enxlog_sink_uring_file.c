@@ -0,0 +1,556 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+
+#include <enx/log/sinks/enxlog_sink_uring_file.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+
+struct enxlog_uring_file_buffer
+{
+    char *data;
+    size_t length;
+    uint64_t offset;
+    bool in_flight;
+};
+
+struct enxlog_uring
+{
+    int fd;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    void *cq_ring;
+    size_t cq_ring_size;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+struct enxlog_uring_file_state
+{
+    int fd;
+    uint64_t offset;
+
+    struct enxlog_uring_file_buffer *buffers;
+    unsigned int buffer_count;
+    size_t buffer_size;
+    unsigned int current;
+    unsigned int in_flight;
+
+    struct enxlog_uring uring;
+    bool using_uring;
+
+    size_t tag_length;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    pthread_t thread;
+    bool running;
+    unsigned int flush_interval_ms;
+};
+
+
+/**
+ * Sets up an io_uring instance with room for the given number of writes
+ * @private
+ */
+static bool enxlog_uring_setup(struct enxlog_uring *uring, unsigned int entries);
+
+/**
+ * Releases an io_uring instance
+ * @private
+ */
+static void enxlog_uring_teardown(struct enxlog_uring *uring);
+
+/**
+ * Writes a buffer synchronously, retrying short writes
+ * @private
+ */
+static void enxlog_uring_file_pwrite(int fd, const char *data, size_t length, uint64_t offset);
+
+/**
+ * Hands the current buffer to the kernel and moves on to the next one
+ * @private
+ */
+static void enxlog_uring_file_submit(struct enxlog_uring_file_state *state);
+
+/**
+ * Processes completed writes, optionally waiting for at least one
+ * @private
+ */
+static void enxlog_uring_file_reap(struct enxlog_uring_file_state *state, bool wait);
+
+/**
+ * Appends data to the current buffer, submitting it as it fills up
+ * @private
+ */
+static void enxlog_uring_file_append(
+    void *arg,
+    const char *ptr,
+    size_t length);
+
+/**
+ * Submits partially filled buffers once the flush interval expires
+ * @private
+ */
+static void *enxlog_uring_file_thread(void *arg);
+
+
+#ifndef ENXLOG_NO_HEAP
+
+struct enxlog_sink_uring_file_context *enxlog_sink_uring_file_create()
+{
+    struct enxlog_sink_uring_file_context *ctx = malloc(sizeof(struct enxlog_sink_uring_file_context));
+    if (ctx) {
+        memset(ctx, 0, sizeof(struct enxlog_sink_uring_file_context));
+    }
+
+    return ctx;
+}
+
+void enxlog_sink_uring_file_destroy(void *context)
+{
+    struct enxlog_sink_uring_file_context *ctx = (struct enxlog_sink_uring_file_context *)context;
+
+    enxlog_sink_uring_file_shutdown(ctx);
+    enxlog_pattern_destroy((struct enxlog_pattern *)ctx->pattern);
+    free(ctx);
+}
+
+#endif
+
+
+bool enxlog_sink_uring_file_init(void *context)
+{
+    struct enxlog_sink_uring_file_context *ctx = (struct enxlog_sink_uring_file_context *)context;
+
+    struct enxlog_uring_file_state *state = malloc(sizeof(struct enxlog_uring_file_state));
+    if (state == NULL) {
+        return false;
+    }
+
+    memset(state, 0, sizeof(struct enxlog_uring_file_state));
+    state->buffer_size = ctx->buffer_size ? ctx->buffer_size : ENXLOG_URING_FILE_BUFFER_SIZE;
+    state->buffer_count = ctx->buffer_count ? ctx->buffer_count : ENXLOG_URING_FILE_BUFFER_COUNT;
+    state->flush_interval_ms = ctx->flush_interval_ms ? ctx->flush_interval_ms : ENXLOG_URING_FILE_FLUSH_INTERVAL_MS;
+
+    state->fd = open(ctx->path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (state->fd < 0) {
+        goto error_open;
+    }
+
+    // Writes carry explicit offsets, as completions may arrive out of order
+    off_t end = lseek(state->fd, 0, SEEK_END);
+    if (end < 0) {
+        goto error_buffers;
+    }
+    state->offset = end;
+
+    state->buffers = calloc(state->buffer_count, sizeof(struct enxlog_uring_file_buffer));
+    if (state->buffers == NULL) {
+        goto error_buffers;
+    }
+
+    for (unsigned int i = 0; i < state->buffer_count; ++i) {
+        if (posix_memalign((void **)&state->buffers[i].data, 4096, state->buffer_size) != 0) {
+            goto error_buffer_data;
+        }
+    }
+
+    state->using_uring = enxlog_uring_setup(&state->uring, state->buffer_count);
+
+    pthread_mutex_init(&state->mutex, NULL);
+    pthread_cond_init(&state->condition, NULL);
+    state->running = true;
+    if (pthread_create(&state->thread, NULL, enxlog_uring_file_thread, state) != 0) {
+        goto error_thread;
+    }
+
+    ctx->state = state;
+    return true;
+
+error_thread:
+    pthread_cond_destroy(&state->condition);
+    pthread_mutex_destroy(&state->mutex);
+    if (state->uring.fd >= 0) {
+        enxlog_uring_teardown(&state->uring);
+    }
+
+error_buffer_data:
+    for (unsigned int i = 0; i < state->buffer_count; ++i) {
+        free(state->buffers[i].data);
+    }
+    free(state->buffers);
+
+error_buffers:
+    close(state->fd);
+
+error_open:
+    free(state);
+
+    return false;
+}
+
+void enxlog_sink_uring_file_shutdown(void *context)
+{
+    struct enxlog_sink_uring_file_context *ctx = (struct enxlog_sink_uring_file_context *)context;
+    struct enxlog_uring_file_state *state = ctx->state;
+
+    if (state == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+    state->running = false;
+    pthread_cond_signal(&state->condition);
+    pthread_mutex_unlock(&state->mutex);
+    pthread_join(state->thread, NULL);
+
+    // Write out whatever is left and wait for everything to land
+    if (state->buffers[state->current].length) {
+        enxlog_uring_file_submit(state);
+    }
+
+    while (state->in_flight) {
+        enxlog_uring_file_reap(state, true);
+    }
+
+    if (state->uring.fd >= 0) {
+        enxlog_uring_teardown(&state->uring);
+    }
+
+    pthread_cond_destroy(&state->condition);
+    pthread_mutex_destroy(&state->mutex);
+
+    for (unsigned int i = 0; i < state->buffer_count; ++i) {
+        free(state->buffers[i].data);
+    }
+    free(state->buffers);
+
+    close(state->fd);
+    free(state);
+    ctx->state = NULL;
+}
+
+void enxlog_sink_uring_file_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct enxlog_sink_uring_file_context *ctx = (struct enxlog_sink_uring_file_context *)context;
+    struct enxlog_uring_file_state *state = ctx->state;
+    const struct enxlog_pattern *pattern = ctx->pattern ? ctx->pattern : &enxlog_pattern_default;
+    char header[ENXLOG_PATTERN_MAX_HEADER];
+
+    // Held until the entry is closed so that the flush thread never writes
+    // out half a record
+    pthread_mutex_lock(&state->mutex);
+
+    size_t length = enxlog_pattern_format(pattern, header, sizeof(header), &state->tag_length, logger, loglevel, func, line);
+    enxlog_uring_file_append(state, header, length);
+}
+
+
+void enxlog_sink_uring_file_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_sink_uring_file_context *ctx = (struct enxlog_sink_uring_file_context *)context;
+    struct enxlog_uring_file_state *state = ctx->state;
+
+    enxlog_pattern_write_message(ctx->pattern, state->tag_length, ptr, length, enxlog_uring_file_append, state);
+}
+
+void enxlog_sink_uring_file_log_entry_close(
+    void *context)
+{
+    struct enxlog_sink_uring_file_context *ctx = (struct enxlog_sink_uring_file_context *)context;
+    struct enxlog_uring_file_state *state = ctx->state;
+
+    enxlog_uring_file_append(state, "\n", 1);
+    pthread_mutex_unlock(&state->mutex);
+}
+
+bool enxlog_sink_uring_file_using_uring(void *context)
+{
+    struct enxlog_sink_uring_file_context *ctx = (struct enxlog_sink_uring_file_context *)context;
+
+    return ctx->state && ctx->state->using_uring;
+}
+
+static bool enxlog_uring_setup(struct enxlog_uring *uring, unsigned int entries)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    uring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (uring->fd < 0) {
+        uring->fd = -1;
+        return false;
+    }
+
+    uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+    if (uring->sq_ring == MAP_FAILED) {
+        goto error_sq_ring;
+    }
+
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        goto error_sqes;
+    }
+
+    uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+    if (uring->cq_ring == MAP_FAILED) {
+        goto error_cq_ring;
+    }
+
+    uring->sq_head = (unsigned int *)((char *)uring->sq_ring + params.sq_off.head);
+    uring->sq_tail = (unsigned int *)((char *)uring->sq_ring + params.sq_off.tail);
+    uring->sq_mask = (unsigned int *)((char *)uring->sq_ring + params.sq_off.ring_mask);
+    uring->sq_array = (unsigned int *)((char *)uring->sq_ring + params.sq_off.array);
+
+    uring->cq_head = (unsigned int *)((char *)uring->cq_ring + params.cq_off.head);
+    uring->cq_tail = (unsigned int *)((char *)uring->cq_ring + params.cq_off.tail);
+    uring->cq_mask = (unsigned int *)((char *)uring->cq_ring + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe *)((char *)uring->cq_ring + params.cq_off.cqes);
+
+    return true;
+
+error_cq_ring:
+    munmap(uring->sqes, uring->sqes_size);
+
+error_sqes:
+    munmap(uring->sq_ring, uring->sq_ring_size);
+
+error_sq_ring:
+    close(uring->fd);
+    uring->fd = -1;
+
+    return false;
+}
+
+static void enxlog_uring_teardown(struct enxlog_uring *uring)
+{
+    munmap(uring->cq_ring, uring->cq_ring_size);
+    munmap(uring->sqes, uring->sqes_size);
+    munmap(uring->sq_ring, uring->sq_ring_size);
+    close(uring->fd);
+}
+
+static void enxlog_uring_file_pwrite(int fd, const char *data, size_t length, uint64_t offset)
+{
+    while (length) {
+        ssize_t result = pwrite(fd, data, length, offset);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        data += result;
+        length -= result;
+        offset += result;
+    }
+}
+
+static void enxlog_uring_file_submit(struct enxlog_uring_file_state *state)
+{
+    struct enxlog_uring_file_buffer *buffer = &state->buffers[state->current];
+    bool submitted = false;
+
+    buffer->offset = state->offset;
+    state->offset += buffer->length;
+
+    if (state->using_uring) {
+        struct enxlog_uring *uring = &state->uring;
+
+        // There is never more than one entry per buffer, so the queue
+        // cannot overflow
+        unsigned int tail = *uring->sq_tail;
+        unsigned int index = tail & *uring->sq_mask;
+
+        struct io_uring_sqe *sqe = &uring->sqes[index];
+        memset(sqe, 0, sizeof(struct io_uring_sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = state->fd;
+        sqe->addr = (uint64_t)(uintptr_t)buffer->data;
+        sqe->len = buffer->length;
+        sqe->off = buffer->offset;
+        sqe->user_data = state->current;
+
+        uring->sq_array[index] = index;
+        __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        if (syscall(__NR_io_uring_enter, uring->fd, 1, 0, 0, NULL, 0) == 1) {
+            buffer->in_flight = true;
+            state->in_flight++;
+            submitted = true;
+
+        } else {
+            // Take the entry back and stop using io_uring
+            __atomic_store_n(uring->sq_tail, tail, __ATOMIC_RELEASE);
+            state->using_uring = false;
+        }
+    }
+
+    if (!submitted) {
+        enxlog_uring_file_pwrite(state->fd, buffer->data, buffer->length, buffer->offset);
+        buffer->length = 0;
+    }
+
+    state->current = (state->current + 1) % state->buffer_count;
+
+    // Wait for the next buffer if it is still being written
+    while (state->buffers[state->current].in_flight) {
+        enxlog_uring_file_reap(state, true);
+    }
+}
+
+static void enxlog_uring_file_reap(struct enxlog_uring_file_state *state, bool wait)
+{
+    struct enxlog_uring *uring = &state->uring;
+
+    if (state->in_flight == 0) {
+        return;
+    }
+
+    if (wait) {
+        syscall(__NR_io_uring_enter, uring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    }
+
+    unsigned int head = *uring->cq_head;
+    unsigned int tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        const struct io_uring_cqe *cqe = &uring->cqes[head & *uring->cq_mask];
+        struct enxlog_uring_file_buffer *buffer = &state->buffers[cqe->user_data];
+
+        // Finish short or failed writes synchronously. The kernel may not
+        // support IORING_OP_WRITE, in which case io_uring is abandoned.
+        if (cqe->res < 0) {
+            if ((cqe->res == -EINVAL) || (cqe->res == -EOPNOTSUPP)) {
+                state->using_uring = false;
+            }
+            enxlog_uring_file_pwrite(state->fd, buffer->data, buffer->length, buffer->offset);
+
+        } else if ((size_t)cqe->res < buffer->length) {
+            enxlog_uring_file_pwrite(
+                state->fd,
+                buffer->data + cqe->res,
+                buffer->length - cqe->res,
+                buffer->offset + cqe->res);
+        }
+
+        buffer->length = 0;
+        buffer->in_flight = false;
+        state->in_flight--;
+        head++;
+    }
+
+    __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void enxlog_uring_file_append(
+    void *arg,
+    const char *ptr,
+    size_t length)
+{
+    struct enxlog_uring_file_state *state = (struct enxlog_uring_file_state *)arg;
+
+    while (length) {
+        struct enxlog_uring_file_buffer *buffer = &state->buffers[state->current];
+        size_t available = state->buffer_size - buffer->length;
+        size_t count = (length < available) ? length : available;
+
+        memcpy(&buffer->data[buffer->length], ptr, count);
+        buffer->length += count;
+        ptr += count;
+        length -= count;
+
+        if (buffer->length == state->buffer_size) {
+            enxlog_uring_file_submit(state);
+        }
+    }
+}
+
+static void *enxlog_uring_file_thread(void *arg)
+{
+    struct enxlog_uring_file_state *state = (struct enxlog_uring_file_state *)arg;
+    struct timespec deadline;
+
+    pthread_mutex_lock(&state->mutex);
+
+    while (state->running) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += state->flush_interval_ms / 1000;
+        deadline.tv_nsec += (state->flush_interval_ms % 1000) * 1000000l;
+        if (deadline.tv_nsec >= 1000000000l) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000l;
+        }
+
+        pthread_cond_timedwait(&state->condition, &state->mutex, &deadline);
+        if (!state->running) {
+            break;
+        }
+
+        if (state->buffers[state->current].length) {
+            enxlog_uring_file_submit(state);
+        }
+
+        enxlog_uring_file_reap(state, false);
+    }
+
+    pthread_mutex_unlock(&state->mutex);
+
+    return NULL;
+}
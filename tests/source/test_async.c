@@ -0,0 +1,197 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_async.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "test_utils.h"
+
+
+#define THREAD_COUNT 8
+#define ENTRY_COUNT 20000
+
+
+LOGGER(logger, "async");
+LOGGER(worker_logger, "async", "worker");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("async", LOGLEVEL_INFO)
+        enxlog_filter_entry("worker", LOGLEVEL_DEBUG)
+        enxlog_end_filter_entry()
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+
+/**
+ * Counts the worker entries and checks that their time never goes back
+ */
+struct order_context
+{
+    unsigned long count;
+    unsigned long out_of_order;
+    struct timeval last;
+    pthread_t thread;
+    bool other_thread;
+};
+
+static struct order_context order_context;
+
+static void order_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    struct order_context *ctx = (struct order_context *)context;
+    struct timeval time;
+
+    if (logger != worker_logger) {
+        return;
+    }
+
+    enxlog_entry_time(&time);
+    if (timercmp(&time, &ctx->last, <)) {
+        ctx->out_of_order++;
+    }
+
+    if (ctx->count && !pthread_equal(ctx->thread, pthread_self())) {
+        ctx->other_thread = true;
+    }
+
+    ctx->last = time;
+    ctx->thread = pthread_self();
+    ctx->count++;
+}
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+// The worker entries are only counted
+static bool stdout_skip;
+
+static void stdout_log_entry_open(
+    void *context,
+    const struct enxlog_logger *logger,
+    enum enxlog_loglevel loglevel,
+    const char *func,
+    unsigned int line)
+{
+    stdout_skip = (logger == worker_logger);
+    if (!stdout_skip) {
+        enxlog_sink_stdout_log_entry_open(context, logger, loglevel, func, line);
+    }
+}
+
+static void stdout_log_entry_write(
+    void *context,
+    const char *ptr,
+    size_t length)
+{
+    if (!stdout_skip) {
+        enxlog_sink_stdout_log_entry_write(context, ptr, length);
+    }
+}
+
+static void stdout_log_entry_close(void *context)
+{
+    if (!stdout_skip) {
+        enxlog_sink_stdout_log_entry_close(context);
+    }
+}
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &order_context,
+        NULL,
+        NULL,
+        order_log_entry_open,
+        NULL,
+        NULL
+    )
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        stdout_log_entry_open,
+        stdout_log_entry_write,
+        stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+static void *worker(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        LOG_DEBUG(worker_logger, "Worker {} entry {}", f_int(id), f_int(i));
+    }
+
+    LOG_INFO(logger, "Worker {} done", f_int(id));
+
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t threads[THREAD_COUNT];
+
+    print_filter_tree(filter_tree);
+
+    enxlog_init(LOGLEVEL_NONE, sink_list, NULL, filter_tree);
+
+    if (!enxlog_async_start(0)) {
+        printf("Could not start the async mode\n");
+        return 1;
+    }
+
+    LOG_INFO(logger, "Started {} workers", f_int(THREAD_COUNT));
+
+    // Each worker's ring is retired when the worker exits
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        pthread_create(&threads[i], NULL, worker, (void *)(intptr_t)i);
+    }
+
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    enxlog_async_flush();
+
+    printf("Worker entries: %lu, out of order: %lu, written by one thread: %s\n",
+        order_context.count,
+        order_context.out_of_order,
+        order_context.other_thread ? "no" : "yes");
+
+    LOG_INFO(logger, "Written after the flush");
+
+    enxlog_shutdown();
+
+    LOG_INFO(logger, "Written directly after the async mode stopped");
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_tail_buffer.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger, "batch");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("batch", LOGLEVEL_INFO)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+
+static void batch_sink_log_batch(
+    void *context,
+    const struct enxlog_record *records,
+    size_t count)
+{
+    struct timeval time;
+
+    printf("Batch of %zu records\n", count);
+
+    for (size_t i = 0; i < count; ++i) {
+        enxlog_record_select(&records[i]);
+        enxlog_entry_time(&time);
+
+        printf("  %ld.%06ld %s:%u: %.*s\n",
+            (long)time.tv_sec,
+            (long)time.tv_usec,
+            records[i].func,
+            records[i].line,
+            (int)records[i].length,
+            records[i].message);
+    }
+}
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_batch_sink(
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        batch_sink_log_batch
+    )
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+int main(void)
+{
+    int i;
+
+    print_filter_tree(filter_tree);
+
+    enxlog_init(LOGLEVEL_NONE, sink_list, NULL, filter_tree);
+
+    enxlog_tail_buffer_enable(LOGLEVEL_DEBUG, LOGLEVEL_ERROR, 64 * 1024);
+
+    // Live entries only reach the sink with entry callbacks
+    LOG_INFO(logger, "Live entry");
+
+    // Buffered entries are replayed in batches of up to 64 records. The
+    // stdout sink receives them one by one.
+    for (i = 0; i < 100; ++i) {
+        LOG_DEBUG(logger, "Buffered entry {}", f_int(i));
+    }
+
+    LOG_ERROR(logger, "Trigger");
+
+    enxlog_tail_buffer_disable();
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.hpp>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+
+LOGGER(logger, "app", "cxx");
+
+
+// The sink list and filter macros rely on compound literals, which C++
+// does not have, so the tables are written out
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+static const struct enxlog_sink sink_list[] = {
+    {
+        true,
+        &sink_stdout_context,
+        nullptr,
+        nullptr,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close,
+        nullptr
+    },
+    { false, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+static struct enxlog_filter_entry filter_entries[] = {
+    { nullptr, LOGLEVEL_NONE, nullptr }
+};
+
+static const struct enxlog_filter filter_tree = { filter_entries };
+
+
+enum class color : uint8_t
+{
+    red = 1,
+    green = 2
+};
+
+static int evaluations = 0;
+
+static int evaluate()
+{
+    return ++evaluations;
+}
+
+int main()
+{
+    enxlog_init(LOGLEVEL_INFO, sink_list, nullptr, &filter_tree);
+
+    std::string name = "uart0";
+    const char *null_string = nullptr;
+    int8_t small = -128;
+    uint64_t large = UINT64_MAX;
+    unsigned char frame[] = { 0xde, 0xad, 0xbe, 0xef, 0x00, 0x41 };
+
+    ENXLOG_INFO(logger, "No arguments");
+    ENXLOG_INFO(logger, "int={} unsigned={} int8={} uint64={}", -42, 42u, small, large);
+    ENXLOG_INFO(logger, "bool={} char={} double={} enum={}", true, 'x', 3.25, color::green);
+    ENXLOG_INFO(logger, "string={} literal={} null={}", name, "text", null_string);
+    ENXLOG_WARN(logger, "pointer={}", static_cast<const void *>(nullptr));
+    ENXLOG_ERROR(logger, "frame={}", enxlog::hex(frame, sizeof(frame)));
+    ENXLOG_INFO(logger, "Opened {}", name, enxlog::kv("port", 8080), enxlog::kv("mode", "raw"));
+
+    // Disabled statements do not evaluate their arguments, unless the
+    // profiler is built in, as it counts them
+    ENXLOG_DEBUG(logger, "Not evaluated {}", evaluate());
+    ENXLOG_INFO(logger, "Evaluated {}", evaluate());
+    std::printf("Evaluations: %d\n", evaluations);
+
+    // Does not compile: one placeholder, two arguments
+    // ENXLOG_INFO(logger, "Mismatch {}", 1, 2);
+
+    enxlog_shutdown();
+
+    return 0;
+}
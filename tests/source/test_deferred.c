@@ -0,0 +1,156 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_deferred.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "test_utils.h"
+
+
+#define TICK_COUNT 200
+
+
+LOGGER(main_loop, "main");
+LOGGER(interrupt, "interrupt");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("main", LOGLEVEL_INFO)
+    enxlog_end_filter_entry()
+    enxlog_filter_entry("interrupt", LOGLEVEL_DEBUG)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+// A lock that is not reentrant. Taking it from the signal handler while the
+// main loop holds it would hang. It is slow to take, like a sink on a slow
+// UART, so that the timer fires while it is held.
+static volatile sig_atomic_t lock_held = 0;
+static volatile sig_atomic_t lock_reentered = 0;
+
+static void lock(void *context)
+{
+    struct timeval start;
+    struct timeval now;
+
+    if (lock_held) {
+        lock_reentered = 1;
+    }
+    lock_held = 1;
+
+    gettimeofday(&start, NULL);
+    do {
+        gettimeofday(&now, NULL);
+    } while (((now.tv_sec - start.tv_sec) * 1000000 + (now.tv_usec - start.tv_usec)) < 500);
+}
+
+static void unlock(void *context)
+{
+    lock_held = 0;
+}
+
+enxlog_lock(sink_lock, NULL, lock, unlock);
+
+static volatile sig_atomic_t ticks = 0;
+static volatile sig_atomic_t ticks_during_lock = 0;
+
+
+// Stands in for an interrupt handler
+static void timer_handler(int signal)
+{
+    if (ticks >= TICK_COUNT) {
+        return;
+    }
+
+    if (lock_held) {
+        ticks_during_lock++;
+    }
+
+    ticks++;
+    LOG_DEBUG(interrupt, "tick={}", f_int(ticks));
+}
+
+int main(int argc, char* argv[])
+{
+    int loops = 0;
+
+    enxlog_init(LOGLEVEL_NONE, sink_list, sink_lock, filter_tree);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = timer_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+
+    struct itimerval timer = { .it_interval = { 0, 200 }, .it_value = { 0, 200 } };
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    LOG_INFO(main_loop, "Main loop started");
+
+    // Overflow the ring. The newest entries are dropped and counted.
+    if ((argc > 1) && (strcmp(argv[1], "overflow") == 0)) {
+        for (int i=0; i < 100; ++i) {
+            LOG_INFO(main_loop, "Startup step {}", f_int(i));
+        }
+    }
+
+    // The main loop writes the entries while the timer keeps logging
+    while (ticks < TICK_COUNT) {
+        enxlog_deferred_drain();
+        loops++;
+    }
+
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    LOG_INFO(main_loop, "Main loop stopped after {} drains", f_int(loops));
+
+    while (enxlog_deferred_drain()) {
+    }
+
+    printf("ticks=%d ticks_during_lock=%d dropped=%u lock_reentered=%d pending=%d\n",
+        (int)ticks,
+        (int)ticks_during_lock,
+        enxlog_deferred_dropped(),
+        (int)lock_reentered,
+        enxlog_deferred_pending());
+
+    enxlog_shutdown();
+
+    return 0;
+}
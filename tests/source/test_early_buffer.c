@@ -0,0 +1,89 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_early_buffer.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_utils.h"
+
+
+LOGGER(startup, "startup");
+LOGGER(driver, "startup", "driver");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("startup", LOGLEVEL_INFO)
+        enxlog_filter_entry("driver", LOGLEVEL_DEBUG)
+        enxlog_end_filter_entry()
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+__attribute__((constructor))
+static void early_constructor(void)
+{
+    LOG_INFO(startup, "Logged from a static constructor");
+    LOG_DEBUG(startup, "This should not display");
+    LOG_DEBUG(driver, "This should display, key={}", f_int(42));
+}
+
+int main(int argc, char* argv[])
+{
+    int i;
+
+    // The replayed entries keep the time at which they were logged
+    usleep(200000);
+
+    LOG_INFO(startup, "Logged from main, before enxlog_init");
+
+    // Overflow the buffer. The oldest entries are dropped and counted.
+    if ((argc > 1) && (strcmp(argv[1], "overflow") == 0)) {
+        for (i=0; i < 1000; ++i) {
+            LOG_INFO(startup, "Startup step {}", f_int(i));
+        }
+    }
+
+    printf("Dropped before init: %llu\n", (unsigned long long)enxlog_early_buffer_dropped());
+
+    enxlog_init(LOGLEVEL_NONE, sink_list, NULL, filter_tree);
+    LOG_INFO(startup, "Logged after enxlog_init");
+
+    enxlog_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_flight_recorder.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger, "test");
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+static char flight_recorder_buffer[512];
+
+static struct enxlog_sink_flight_recorder_context sink_flight_recorder_context = {
+    .buffer = flight_recorder_buffer,
+    .size = sizeof(flight_recorder_buffer),
+    .crash_dump = "stderr"
+};
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_flight_recorder_context,
+        enxlog_sink_flight_recorder_init,
+        enxlog_sink_flight_recorder_shutdown,
+        enxlog_sink_flight_recorder_log_entry_open,
+        enxlog_sink_flight_recorder_log_entry_write,
+        enxlog_sink_flight_recorder_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+
+int main(int argc, char* argv[])
+{
+    int i;
+
+    if (!enxlog_init(LOGLEVEL_TRACE, sink_list, NULL, filter_tree)) {
+        printf("Could not initialize the flight recorder\n");
+        return 1;
+    }
+
+    for (i=0; i < 100; ++i) {
+        LOG_TRACE(logger, "Trace record {}", f_int(i));
+    }
+
+    LOG_ERROR(logger, "Multi\nline\nrecord");
+
+    printf("Dump, only the last few records should be listed:\n");
+    fflush(stdout);
+    enxlog_flight_recorder_dump(STDOUT_FILENO);
+
+    if ((argc > 1) && (strcmp(argv[1], "crash") == 0)) {
+        printf("Crashing, the records should be dumped to stderr:\n");
+        fflush(stdout);
+        abort();
+    }
+
+    enxlog_shutdown();
+
+    return 0;
+}
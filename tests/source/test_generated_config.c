@@ -0,0 +1,67 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+
+#include <stdio.h>
+
+#include "test_generated_config.h"
+#include "test_utils.h"
+
+
+LOGGER(a, "a");
+LOGGER(b, "a", "b");
+LOGGER(c, "a", "b", "c");
+
+LOGGER(one, "one");
+LOGGER(two, "one", "two");
+LOGGER(three, "one", "two", "three");
+LOGGER(four, "one", "four");
+
+
+int main(int argc, char* argv[])
+{
+    // Generated from configs/test_generated_config.conf at build time, so
+    // nothing is parsed or allocated here
+    print_filter_tree(&test_generated_config_filter);
+
+    enxlog_init(
+        test_generated_config_default_loglevel,
+        test_generated_config_sinks,
+        NULL,
+        &test_generated_config_filter);
+
+    LOG_DEBUG(a, "This should not display");
+    LOG_DEBUG(b, "This should not display");
+    LOG_DEBUG(c, "This should display");
+
+    LOG_DEBUG(one, "This should not display");
+    LOG_DEBUG(two, "This should not display");
+    LOG_DEBUG(three, "This should display");
+
+    LOG_INFO(four, "This should not display");
+    LOG_WARN(four, "This should display\non one line");
+
+    enxlog_shutdown();
+
+    return 0;
+}
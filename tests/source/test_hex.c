@@ -0,0 +1,100 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_hex.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger, "net", "frames");
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+static bool encoding_matches(void)
+{
+    unsigned char input[300];
+    char output[600];
+    char expected[601];
+
+    for (size_t i = 0; i < sizeof(input); ++i) {
+        input[i] = rand();
+    }
+
+    // Every length exercises a different split between the vector and scalar paths
+    for (size_t length = 0; length <= sizeof(input); ++length) {
+        for (size_t i = 0; i < length; ++i) {
+            sprintf(&expected[2 * i], "%02x", input[i]);
+        }
+
+        enxlog_hex_encode(output, input, length);
+        if (memcmp(output, expected, 2 * length) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    static const char request[] = "GET /index.html HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    unsigned char frame[40];
+
+    for (size_t i = 0; i < sizeof(frame); ++i) {
+        frame[i] = i * 7;
+    }
+
+    printf("Encoding matches: %s\n", encoding_matches() ? "yes" : "no");
+
+    enxlog_init(LOGLEVEL_INFO, sink_list, NULL, filter_tree);
+
+    LOG_INFO(logger, "Frame {}", f_hex(frame, sizeof(frame)));
+    LOG_INFO(logger, "Request:\n{}", f_hexdump(request, sizeof(request) - 1));
+    LOG_INFO(logger, "Without columns:\n{}", f_hex_ex(frame, sizeof(frame), ENXLOG_HEX_DUMP, ENXLOG_HEX_LIMIT));
+    LOG_INFO(logger, "Truncated {}", f_hex_ex(frame, sizeof(frame), 0, 8));
+    LOG_INFO(logger, "Truncated:\n{}", f_hex_ex(frame, sizeof(frame), ENXLOG_HEX_DUMP | ENXLOG_HEX_ASCII, 20));
+
+    enxlog_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdio.h>
+
+#include "test_utils.h"
+
+
+static struct enxlog_instance audit_instance;
+
+LOGGER(app, "app");
+LOGGER_INSTANCE(audit, &audit_instance, "audit");
+
+
+// Each instance has its own lock, counted here to show which one is taken
+static void count_lock(void *context) { (*(int *)context)++; }
+static void count_unlock(void *context) { }
+
+static int app_locks = 0;
+static int audit_locks = 0;
+
+enxlog_lock(app_lock, &app_locks, count_lock, count_unlock);
+enxlog_lock(audit_lock, &audit_locks, count_lock, count_unlock);
+
+
+enxlog_filter(app_filter)
+    enxlog_filter_entry("app", LOGLEVEL_INFO)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+enxlog_filter(audit_filter)
+    enxlog_filter_entry("audit", LOGLEVEL_DEBUG)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context app_stdout_context;
+static struct enxlog_sink_stdout_context audit_stdout_context;
+static struct enxlog_pattern audit_pattern;
+
+enxlog_sink_list(app_sinks)
+    enxlog_sink(
+        &app_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+enxlog_sink_list(audit_sinks)
+    enxlog_sink(
+        &audit_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+int main(void)
+{
+    enxlog_pattern_compile(&audit_pattern, "AUDIT %L %N%F:%l: ");
+    audit_stdout_context.pattern = &audit_pattern;
+
+    enxlog_init(LOGLEVEL_NONE, app_sinks, app_lock, app_filter);
+
+    LOG_INFO(app, "Written to the default instance");
+    LOG_INFO(audit, "This should not display, the audit instance is not initialized");
+
+    enxlog_instance_init(&audit_instance, LOGLEVEL_NONE, audit_sinks, audit_lock, audit_filter);
+
+    LOG_DEBUG(app, "This should not display");
+    LOG_DEBUG(audit, "User {} logged in", f_str("alice"));
+    LOG_INFO(app, "Written to the default instance");
+
+    printf("Locks taken: app=%d audit=%d\n", app_locks, audit_locks);
+
+    enxlog_instance_shutdown(&audit_instance);
+    enxlog_shutdown();
+
+    return 0;
+}
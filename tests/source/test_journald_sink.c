@@ -0,0 +1,175 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_journald.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+
+LOGGER(logger, "service", "auth");
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+static struct enxlog_sink_journald_context sink_journald_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_structured_sink(
+        &sink_journald_context,
+        enxlog_sink_journald_init,
+        enxlog_sink_journald_shutdown,
+        enxlog_sink_journald_log_entry_open,
+        enxlog_sink_journald_log_entry_write,
+        enxlog_sink_journald_log_entry_field,
+        enxlog_sink_journald_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+// Prints the fields of a native protocol record, the way journald would
+// read them
+static void print_record(const char *ptr, size_t length, bool memfd)
+{
+    const char *end = ptr + length;
+
+    printf("--- record (%zu bytes%s)\n", length, memfd ? ", memfd" : "");
+
+    while (ptr < end) {
+        const char *newline = memchr(ptr, '\n', end - ptr);
+        const char *equals = memchr(ptr, '=', end - ptr);
+        if (newline == NULL) {
+            printf("    malformed record\n");
+            return;
+        }
+
+        if (equals && (equals < newline)) {
+            printf("    %.*s\n", (int)(newline - ptr), ptr);
+            ptr = newline + 1;
+
+        } else {
+            uint64_t value_length = 0;
+            for (int i = 0; i < 8; ++i) {
+                value_length |= (uint64_t)(unsigned char)newline[1 + i] << (i * 8);
+            }
+
+            const char *value = newline + 9;
+            if (value_length > 64) {
+                printf("    %.*s=(%llu bytes)\n", (int)(newline - ptr), ptr, (unsigned long long)value_length);
+            } else {
+                printf("    %.*s=%.*s\n", (int)(newline - ptr), ptr, (int)value_length, value);
+            }
+            ptr = value + value_length + 1;
+        }
+    }
+}
+
+// Reads the records waiting on the stand-in journal socket
+static void read_records(int fd)
+{
+    char buffer[ENXLOG_JOURNALD_RECORD_SIZE];
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    for (;;) {
+        struct iovec iov = { .iov_base = buffer, .iov_len = sizeof(buffer) };
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control.buffer;
+        message.msg_controllen = sizeof(control.buffer);
+
+        ssize_t length = recvmsg(fd, &message, MSG_DONTWAIT);
+        if (length < 0) {
+            break;
+        }
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+        if (cmsg && (cmsg->cmsg_type == SCM_RIGHTS)) {
+            int memfd;
+            struct stat st;
+            memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+            fstat(memfd, &st);
+
+            void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, memfd, 0);
+            print_record(mapping, st.st_size, true);
+            munmap(mapping, st.st_size);
+            close(memfd);
+
+        } else {
+            print_record(buffer, length, false);
+        }
+    }
+}
+
+
+int main(void)
+{
+    struct sockaddr_un address;
+    char large[4000];
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "/tmp/test_journald_sink.%d", (int)getpid());
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if ((fd < 0) || (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0)) {
+        printf("Could not create the stand-in journal socket\n");
+        return 1;
+    }
+
+    sink_journald_context.path = address.sun_path;
+    sink_journald_context.identifier = "test_journald_sink";
+    sink_journald_context.max_datagram = 1024;
+
+    enxlog_init(LOGLEVEL_INFO, sink_list, NULL, filter_tree);
+
+    LOG_INFO(logger, "User logged in",
+        f_kv("user_id", f_uint(1234)),
+        f_kv("remote.address", f_str("10.0.0.1")));
+
+    LOG_ERROR(logger, "Message with\nmultiple lines");
+
+    // Larger than max_datagram, so passed in a memfd
+    memset(large, 'x', sizeof(large) - 1);
+    large[sizeof(large) - 1] = '\0';
+    LOG_WARN(logger, "{}", f_str(large));
+
+    enxlog_shutdown();
+
+    read_records(fd);
+
+    close(fd);
+    unlink(address.sun_path);
+
+    return 0;
+}
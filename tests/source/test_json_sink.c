@@ -0,0 +1,80 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <enx/log/sinks/enxlog_sink_json.h>
+#include <stdlib.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger, "service", "auth");
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+static struct enxlog_sink_json_context sink_json_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+    enxlog_structured_sink(
+        &sink_json_context,
+        enxlog_sink_json_init,
+        enxlog_sink_json_shutdown,
+        enxlog_sink_json_log_entry_open,
+        enxlog_sink_json_log_entry_write,
+        enxlog_sink_json_log_entry_field,
+        enxlog_sink_json_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+
+int main(void)
+{
+    enxlog_init(LOGLEVEL_INFO, sink_list, NULL, filter_tree);
+
+    LOG_INFO(logger, "User logged in",
+        f_kv("user_id", f_uint(1234)),
+        f_kv("name", f_str("O'Brien \"Bob\"")),
+        f_kv("offset", f_int(-7)));
+
+    LOG_WARN(logger, "Login from {} failed",
+        f_str("10.0.0.1"),
+        f_kv("attempts", f_uint(3)));
+
+    LOG_ERROR(logger, "Message with\ttabs, \\backslashes\\ and\nmultiple lines");
+
+    enxlog_shutdown();
+
+    return 0;
+}
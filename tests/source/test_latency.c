@@ -0,0 +1,97 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_latency.h>
+#include <enx/log/sinks/enxlog_sink_file.h>
+#include <stdio.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger, "test");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("enxlog", LOGLEVEL_INFO)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+static struct enxlog_sink_file_context sink_file_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_file_context,
+        enxlog_sink_file_init,
+        enxlog_sink_file_shutdown,
+        enxlog_sink_file_log_entry_open,
+        enxlog_sink_file_log_entry_write,
+        enxlog_sink_file_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+static void print_histogram(const char *name, enum enxlog_latency_histogram_id id)
+{
+    struct enxlog_histogram histogram;
+    enxlog_latency_snapshot(id, &histogram);
+
+    printf(
+        "%s: count=%llu min=%llu p50=%llu p99=%llu p999=%llu max=%llu\n",
+        name,
+        (unsigned long long)histogram.count,
+        (unsigned long long)histogram.min,
+        (unsigned long long)enxlog_histogram_percentile(&histogram, 50.0),
+        (unsigned long long)enxlog_histogram_percentile(&histogram, 99.0),
+        (unsigned long long)enxlog_histogram_percentile(&histogram, 99.9),
+        (unsigned long long)histogram.max);
+}
+
+int main(int argc, char* argv[])
+{
+    int i;
+
+    if (argc < 2) {
+        printf("usage: test_latency <output_file>\n");
+        return 1;
+    }
+
+    sink_file_context.path = argv[1];
+
+    if (!enxlog_init(LOGLEVEL_DEBUG, sink_list, NULL, filter_tree)) {
+        printf("Could not open output file\n");
+        return 1;
+    }
+
+    enxlog_latency_log_interval(1);
+
+    for (i=0; i < 10000; ++i) {
+        LOG_DEBUG(logger, "Record {}", f_int(i));
+    }
+
+    print_histogram("producer", ENXLOG_LATENCY_PRODUCER);
+    print_histogram("end_to_end", ENXLOG_LATENCY_END_TO_END);
+
+    enxlog_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdio.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger_root, "sys");
+LOGGER(logger_uart, "sys", "drivers", "uart");
+LOGGER(logger_uart_again, "sys", "drivers", "uart");
+LOGGER(logger_spi, "sys", "drivers", "spi");
+
+// Built by hand without a path, in read only memory
+static const char *logger_manual_name[] = { "sys", "drivers", "uart", 0 };
+static const struct enxlog_logger logger_manual = { .name = logger_manual_name };
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+static void print_logger(const struct enxlog_logger *logger)
+{
+    printf("%-22s length %2zu id %08x\n",
+        logger->path,
+        logger->path_length,
+        (unsigned int)enxlog_logger_id(logger));
+}
+
+int main(int argc, char **argv)
+{
+    enxlog_init(LOGLEVEL_INFO, sink_list, NULL, filter_tree);
+
+    print_logger(logger_root);
+    print_logger(logger_uart);
+    print_logger(logger_uart_again);
+    print_logger(logger_spi);
+
+    printf("Same path, same id: %s\n",
+        enxlog_logger_id(logger_uart) == enxlog_logger_id(logger_uart_again) ? "yes" : "no");
+
+    printf("Without a path, same id: %s\n",
+        enxlog_logger_id(&logger_manual) == enxlog_logger_id(logger_uart) ? "yes" : "no");
+
+    LOG_INFO(logger_uart, "Logged through the precomputed path");
+    LOG_INFO(&logger_manual, "Logged through the name parts");
+
+    enxlog_shutdown();
+
+    return 0;
+}
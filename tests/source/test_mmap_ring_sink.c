@@ -0,0 +1,81 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_mmap_ring.h>
+
+#include <stdio.h>
+
+
+static struct enxlog_sink_mmap_ring_context sink_mmap_ring_context;
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_mmap_ring_context,
+        enxlog_sink_mmap_ring_init,
+        enxlog_sink_mmap_ring_shutdown,
+        enxlog_sink_mmap_ring_log_entry_open,
+        enxlog_sink_mmap_ring_log_entry_write,
+        enxlog_sink_mmap_ring_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+
+LOGGER(logger, "test");
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        printf("usage: test_mmap_ring_sink <ring_file>\n");
+        return 1;
+    }
+
+    // Small enough that the ring wraps several times
+    sink_mmap_ring_context.path = argv[1];
+    sink_mmap_ring_context.size = 4096;
+    sink_mmap_ring_context.fd = -1;
+
+    if (!enxlog_init(LOGLEVEL_DEBUG, sink_list, NULL, filter_tree)) {
+        printf("Could not map ring file\n");
+        return 1;
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        LOG_INFO(logger, "Record {}", f_int(i));
+    }
+
+    LOG_ERROR(logger, "This is an error");
+    LOG_WARN(logger, "This is a warning");
+    LOG_INFO(logger, "This is info");
+    LOG_DEBUG(logger, "This is debug data");
+
+    enxlog_shutdown();
+
+    return 0;
+}
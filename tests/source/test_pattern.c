@@ -0,0 +1,112 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger, "sys", "drivers", "uart");
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+static bool same_ops(const struct enxlog_pattern *a, const struct enxlog_pattern *b)
+{
+    if (a->count != b->count) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a->count; ++i) {
+        if ((a->ops[i].type != b->ops[i].type) ||
+            (a->ops[i].length != b->ops[i].length) ||
+            (memcmp(&a->literals[a->ops[i].offset], &b->literals[b->ops[i].offset], a->ops[i].length) != 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main(void)
+{
+    struct enxlog_pattern pattern;
+    struct enxlog_pattern compact;
+
+    enxlog_pattern_compile(&pattern, ENXLOG_PATTERN_DEFAULT);
+    printf("Default pattern matches: %s\n", same_ops(&pattern, &enxlog_pattern_default) ? "yes" : "no");
+
+    printf("Invalid pattern rejected: %s\n", enxlog_pattern_compile(&pattern, "%T %Q") ? "no" : "yes");
+
+    enxlog_init(LOGLEVEL_INFO, sink_list, NULL, filter_tree);
+
+    LOG_INFO(logger, "Default pattern");
+    LOG_ERROR(logger, "Multiple\nlines");
+
+    sink_stdout_context.pattern = &enxlog_pattern_default_color;
+
+    LOG_INFO(logger, "Default color pattern");
+    LOG_ERROR(logger, "Multiple\nlines");
+
+    // The time is never computed for this pattern
+    enxlog_pattern_compile(&compact, "[%t] %L %N%F:%l 100%% ");
+    sink_stdout_context.pattern = &compact;
+
+    LOG_WARN(logger, "Custom pattern");
+    LOG_ERROR(logger, "Multiple\nlines");
+
+    // Newlines inside arguments are found as well
+    const char *trace = "#0 uart_write\n#1 uart_flush\n#2 main";
+    sink_stdout_context.pattern = &enxlog_pattern_default;
+
+    LOG_ERROR(logger, "Indented trace:\n{}", f_str(trace));
+
+    compact = enxlog_pattern_default;
+    compact.newline = ENXLOG_PATTERN_NEWLINE_ESCAPE;
+    sink_stdout_context.pattern = &compact;
+
+    LOG_ERROR(logger, "Escaped trace:\n{}", f_str(trace));
+
+    enxlog_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pool.h>
+#include <enx/log/enxlog_tail_buffer.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#include "test_utils.h"
+
+
+#define THREAD_COUNT 16
+
+
+LOGGER(logger, "pool");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("pool", LOGLEVEL_INFO)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+// Room for four tail buffers of 16 KiB, plus the block table, as on a
+// target without mmap
+static _Alignas(64) char pool_storage[4 * 16 * 1024 + 64];
+
+static pthread_barrier_t barrier;
+static bool use_barrier = false;
+
+
+static void print_stats(const char *title)
+{
+    struct enxlog_pool_stats stats;
+
+    enxlog_pool_snapshot(&stats);
+
+    printf("%s: capacity=%zu used=%zu peak=%zu carved=%zu allocations=%llu failures=%llu hugepages=%s\n",
+        title,
+        stats.capacity,
+        stats.used,
+        stats.peak,
+        stats.carved,
+        (unsigned long long)stats.allocations,
+        (unsigned long long)stats.failures,
+        stats.hugepages ? "yes" : "no");
+}
+
+static void *worker(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+
+    LOG_DEBUG(logger, "Worker {} debug", f_int(id));
+
+    // Keep the buffer until every worker has one
+    if (use_barrier) {
+        pthread_barrier_wait(&barrier);
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t thread;
+
+    print_filter_tree(filter_tree);
+
+    enxlog_pool_init_static(pool_storage, sizeof(pool_storage));
+
+    enxlog_init(LOGLEVEL_NONE, sink_list, NULL, filter_tree);
+    enxlog_tail_buffer_enable(LOGLEVEL_DEBUG, LOGLEVEL_ERROR, 16 * 1024);
+
+    // Each thread gets a block when it first buffers an entry, and returns
+    // it when it exits
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        pthread_create(&thread, NULL, worker, (void *)(intptr_t)i);
+        pthread_join(thread, NULL);
+    }
+
+    print_stats("Threads one after the other, one block reused");
+
+    // The main thread keeps its block, so three workers fit at once
+    pthread_t threads[4];
+
+    LOG_DEBUG(logger, "Main thread debug");
+
+    pthread_barrier_init(&barrier, NULL, 4);
+    use_barrier = true;
+
+    for (int i = 0; i < 4; ++i) {
+        pthread_create(&threads[i], NULL, worker, (void *)(intptr_t)i);
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    print_stats("Four workers at once next to the main thread, one without a buffer");
+
+    pthread_barrier_destroy(&barrier);
+    enxlog_tail_buffer_disable();
+
+    return 0;
+}
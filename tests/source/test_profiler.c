@@ -0,0 +1,81 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_profiler.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdlib.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger_chatty, "chatty");
+LOGGER(logger_quiet, "quiet");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("chatty", LOGLEVEL_INFO)
+    enxlog_end_filter_entry()
+    enxlog_filter_entry("quiet", LOGLEVEL_ERROR)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+
+int main(void)
+{
+    int i;
+
+    print_filter_tree(filter_tree);
+
+    enxlog_init(LOGLEVEL_NONE, sink_list, NULL, filter_tree);
+    enxlog_profiler_report_on_shutdown(stdout, ENXLOG_PROFILER_SORT_BYTES);
+
+    for (i=0; i < 10; ++i) {
+        LOG_INFO(logger_chatty, "This is a fairly long message that should top the report, i={}", f_int(i));
+        LOG_INFO(logger_chatty, "Short, i={}", f_int(i));
+        LOG_DEBUG(logger_quiet, "This is filtered out, i={}", f_int(i));
+    }
+
+    LOG_ERROR(logger_quiet, "This should print");
+
+    printf("\nSorted by invocations:\n");
+    enxlog_profiler_report(stdout, ENXLOG_PROFILER_SORT_INVOCATIONS);
+
+    printf("\nSorted by bytes:\n");
+    enxlog_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_syslog.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+static struct enxlog_sink_syslog_context sink_syslog_context;
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_syslog_context,
+        enxlog_sink_syslog_init,
+        enxlog_sink_syslog_shutdown,
+        enxlog_sink_syslog_log_entry_open,
+        enxlog_sink_syslog_log_entry_write,
+        enxlog_sink_syslog_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+
+LOGGER(logger, "test");
+
+
+// Stands in for the syslog daemon, printing every datagram it receives
+static void *reader_thread(void *arg)
+{
+    int fd = *(int *)arg;
+    char buffer[ENXLOG_SYSLOG_MAX_RECORD + 1];
+    unsigned int count = 0;
+
+    for (;;) {
+        ssize_t length = recv(fd, buffer, ENXLOG_SYSLOG_MAX_RECORD, 0);
+        if (length <= 0) {
+            break;
+        }
+
+        // An empty datagram marks the end of the test
+        if (length == 1 && buffer[0] == '\0') {
+            break;
+        }
+
+        buffer[length] = '\0';
+        if ((count < 3) || (count >= 100)) {
+            printf("%s\n", buffer);
+        }
+        count++;
+    }
+
+    printf("Received: %u\n", count);
+
+    return NULL;
+}
+
+
+int main(int argc, char* argv[])
+{
+    struct sockaddr_un address;
+    pthread_t thread;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "/tmp/test_syslog_sink.%d", (int)getpid());
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if ((fd < 0) || (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0)) {
+        printf("Could not create the stand-in syslog socket\n");
+        return 1;
+    }
+
+    pthread_create(&thread, NULL, reader_thread, &fd);
+
+    sink_syslog_context.path = address.sun_path;
+    sink_syslog_context.app_name = "test_syslog_sink";
+    sink_syslog_context.facility = ENXLOG_SYSLOG_FACILITY_LOCAL0;
+
+    if (!enxlog_init(LOGLEVEL_DEBUG, sink_list, NULL, filter_tree)) {
+        printf("Could not create the syslog socket\n");
+        return 1;
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        LOG_INFO(logger, "Record {}", f_int(i));
+    }
+
+    LOG_ERROR(logger, "This is an error");
+    LOG_WARN(logger, "This is a warning");
+    LOG_INFO(logger, "This is info");
+    LOG_DEBUG(logger, "This is debug data\non two lines");
+
+    printf("Dropped: %llu\n", (unsigned long long)enxlog_sink_syslog_dropped(&sink_syslog_context));
+
+    enxlog_shutdown();
+
+    int sender = socket(AF_UNIX, SOCK_DGRAM, 0);
+    sendto(sender, "", 1, 0, (struct sockaddr *)&address, sizeof(address));
+    close(sender);
+
+    pthread_join(thread, NULL);
+    close(fd);
+    unlink(address.sun_path);
+
+    return 0;
+}
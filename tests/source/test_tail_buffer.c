@@ -0,0 +1,96 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_tail_buffer.h>
+#include <enx/log/sinks/enxlog_sink_stdout.h>
+#include <stdio.h>
+
+#include "test_utils.h"
+
+
+LOGGER(logger, "request");
+
+
+enxlog_filter(filter_tree)
+    enxlog_filter_entry("request", LOGLEVEL_INFO)
+    enxlog_end_filter_entry()
+enxlog_end_filter()
+
+static struct enxlog_sink_stdout_context sink_stdout_context;
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_stdout_context,
+        NULL,
+        NULL,
+        enxlog_sink_stdout_log_entry_open,
+        enxlog_sink_stdout_log_entry_write,
+        enxlog_sink_stdout_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+static void handle_request(int id, bool fail)
+{
+    int i;
+
+    LOG_INFO(logger, "Request {} started", f_int(id));
+
+    for (i=0; i < 20; ++i) {
+        LOG_DEBUG(logger, "Request {} step {}", f_int(id), f_int(i));
+        LOG_TRACE(logger, "Request {} step {}\ndetail", f_int(id), f_int(i));
+    }
+
+    if (fail) {
+        LOG_ERROR(logger, "Request {} failed", f_int(id));
+    } else {
+        LOG_INFO(logger, "Request {} succeeded", f_int(id));
+    }
+
+    enxlog_tail_buffer_discard();
+}
+
+int main(void)
+{
+    print_filter_tree(filter_tree);
+
+    enxlog_init(LOGLEVEL_NONE, sink_list, NULL, filter_tree);
+
+    // Room for the last few steps only
+    enxlog_tail_buffer_enable(LOGLEVEL_TRACE, LOGLEVEL_ERROR, 512);
+
+    printf("Request 1 succeeds, no debug output expected:\n");
+    handle_request(1, false);
+
+    printf("Request 2 fails, the last steps should be listed before the error:\n");
+    handle_request(2, true);
+
+    printf("Request 3 is flushed explicitly:\n");
+    LOG_DEBUG(logger, "Request 3 debug");
+    enxlog_tail_buffer_flush();
+    LOG_INFO(logger, "Request 3 done");
+
+    enxlog_tail_buffer_disable();
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+#include <enx/log/enxlog.h>
+#include <enx/log/sinks/enxlog_sink_tcp.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+
+static struct enxlog_sink_tcp_context sink_tcp_context;
+
+
+enxlog_filter(filter_tree)
+enxlog_end_filter()
+
+
+enxlog_sink_list(sink_list)
+    enxlog_sink(
+        &sink_tcp_context,
+        enxlog_sink_tcp_init,
+        enxlog_sink_tcp_shutdown,
+        enxlog_sink_tcp_log_entry_open,
+        enxlog_sink_tcp_log_entry_write,
+        enxlog_sink_tcp_log_entry_close
+    )
+enxlog_end_sink_list()
+
+
+
+LOGGER(logger, "test");
+
+static unsigned int received;
+
+
+// Stands in for the collector, printing the first and last records
+static void *collector_thread(void *arg)
+{
+    int listener = *(int *)arg;
+    char buffer[ENXLOG_TCP_MAX_RECORD + 8];
+    size_t length = 0;
+
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    for (;;) {
+        ssize_t result = recv(fd, &buffer[length], sizeof(buffer) - length, 0);
+        if (result <= 0) {
+            break;
+        }
+        length += result;
+
+        // Records are length prefixed, see main
+        while (length >= 4) {
+            const unsigned char *p = (const unsigned char *)buffer;
+            size_t record_length = ((size_t)p[0] << 24) | ((size_t)p[1] << 16) | ((size_t)p[2] << 8) | p[3];
+            if (length < 4 + record_length) {
+                break;
+            }
+
+            unsigned int count = __atomic_add_fetch(&received, 1, __ATOMIC_SEQ_CST);
+            if ((count <= 2) || (count > 200)) {
+                printf("%.*s\n", (int)record_length, &buffer[4]);
+            }
+
+            memmove(buffer, &buffer[4 + record_length], length - 4 - record_length);
+            length -= 4 + record_length;
+        }
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+
+int main(int argc, char* argv[])
+{
+    struct sockaddr_in address;
+    socklen_t address_length = sizeof(address);
+    char spill_path[64];
+    pthread_t thread;
+
+    // Find a free port, but do not listen yet, so that the sink starts out
+    // disconnected
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int enable = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        printf("Could not bind the collector socket\n");
+        return 1;
+    }
+    getsockname(listener, (struct sockaddr *)&address, &address_length);
+
+    snprintf(spill_path, sizeof(spill_path), "/tmp/test_tcp_sink.%d.spill", (int)getpid());
+
+    sink_tcp_context.host = "127.0.0.1";
+    sink_tcp_context.port = ntohs(address.sin_port);
+    sink_tcp_context.framing = ENXLOG_SINK_TCP_FRAMING_LENGTH;
+    sink_tcp_context.buffer_size = 4096;
+    sink_tcp_context.spill_path = spill_path;
+
+    if (!enxlog_init(LOGLEVEL_DEBUG, sink_list, NULL, filter_tree)) {
+        printf("Could not start the tcp sink\n");
+        return 1;
+    }
+
+    // The memory buffer only holds a few records, the rest are spilled
+    for (int i = 0; i < 200; ++i) {
+        LOG_INFO(logger, "Record {} while the collector is down", f_int(i));
+    }
+
+    // Let a few connection attempts fail
+    usleep(300000);
+    printf("Connected: %s\n", enxlog_sink_tcp_connected(&sink_tcp_context) ? "yes" : "no");
+
+    listen(listener, 1);
+    pthread_create(&thread, NULL, collector_thread, &listener);
+
+    for (int i = 0; (i < 100) && (__atomic_load_n(&received, __ATOMIC_SEQ_CST) < 200); ++i) {
+        usleep(50000);
+    }
+
+    printf("Connected: %s\n", enxlog_sink_tcp_connected(&sink_tcp_context) ? "yes" : "no");
+
+    LOG_ERROR(logger, "This is an error");
+    LOG_WARN(logger, "This is a warning");
+    LOG_INFO(logger, "This is info");
+    LOG_DEBUG(logger, "This is debug data\non two lines");
+
+    printf("Dropped: %llu\n", (unsigned long long)enxlog_sink_tcp_dropped(&sink_tcp_context));
+
+    enxlog_shutdown();
+
+    pthread_join(thread, NULL);
+    printf("Received: %u\n", received);
+
+    close(listener);
+    unlink(spill_path);
+
+    return 0;
+}
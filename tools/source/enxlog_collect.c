@@ -0,0 +1,364 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/sinks/enxlog_sink_shm.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+
+/**
+ * How long a collector thread sleeps on an empty ring before it checks
+ * whether the producer is still running
+ * @private
+ */
+#define ENXLOG_COLLECT_WAIT_MS 500
+
+/**
+ * A ring being drained
+ * @private
+ */
+struct enxlog_collect_ring
+{
+    char name[NAME_MAX + 2];
+    int fd;
+    size_t size;
+    struct enxlog_shm_ring_header *header;
+    const char *data;
+    FILE *file;
+    uint64_t dropped;
+    pthread_t thread;
+    bool finished;
+    struct enxlog_collect_ring *next;
+};
+
+/** @private */
+static void enxlog_collect_stop(int signal);
+
+/** @private */
+static struct enxlog_collect_ring *enxlog_collect_find(const char *name);
+
+/** @private */
+static void enxlog_collect_open(const char *directory, const char *name);
+
+/** @private */
+static void enxlog_collect_scan(const char *directory, const char *pattern);
+
+/** @private */
+static bool enxlog_collect_drain(struct enxlog_collect_ring *ring);
+
+/** @private */
+static bool enxlog_collect_producer_exited(const struct enxlog_collect_ring *ring);
+
+/** @private */
+static void *enxlog_collect_thread(void *context);
+
+/** @private */
+static void enxlog_collect_reap(bool all);
+
+
+static volatile sig_atomic_t enxlog_collect_running = 1;
+static struct enxlog_collect_ring *enxlog_collect_rings = NULL;
+
+
+int main(int argc, char* argv[])
+{
+    struct sigaction action;
+    int i;
+
+    if (argc < 3) {
+        printf("usage: enxlog_collect <output_directory> <shm_name>...\n");
+        printf("A name ending in * collects every matching ring, including rings created later.\n");
+        return 1;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = enxlog_collect_stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // Producers may start, exit and restart at any time, so the names are
+    // checked again every second
+    while (enxlog_collect_running) {
+        for (i=2; i < argc; ++i) {
+            size_t length = strlen(argv[i]);
+
+            if (length && (argv[i][length - 1] == '*')) {
+                enxlog_collect_scan(argv[1], argv[i]);
+            } else {
+                enxlog_collect_open(argv[1], argv[i]);
+            }
+        }
+
+        sleep(1);
+        enxlog_collect_reap(false);
+    }
+
+    enxlog_collect_reap(true);
+
+    return 0;
+}
+
+static void enxlog_collect_reap(bool all)
+{
+    struct enxlog_collect_ring **link = &enxlog_collect_rings;
+
+    while (*link) {
+        struct enxlog_collect_ring *ring = *link;
+
+        if (!all && !__atomic_load_n(&ring->finished, __ATOMIC_ACQUIRE)) {
+            link = &ring->next;
+            continue;
+        }
+
+        pthread_join(ring->thread, NULL);
+        *link = ring->next;
+
+        munmap(ring->header, ring->size);
+        close(ring->fd);
+        fclose(ring->file);
+        free(ring);
+    }
+}
+
+static void enxlog_collect_stop(int signal)
+{
+    enxlog_collect_running = 0;
+}
+
+static struct enxlog_collect_ring *enxlog_collect_find(const char *name)
+{
+    struct enxlog_collect_ring *ring;
+
+    for (ring = enxlog_collect_rings; ring; ring = ring->next) {
+        if (!__atomic_load_n(&ring->finished, __ATOMIC_ACQUIRE) && (strcmp(ring->name, name) == 0)) {
+            return ring;
+        }
+    }
+
+    return NULL;
+}
+
+static void enxlog_collect_open(const char *directory, const char *name)
+{
+    struct enxlog_collect_ring *ring;
+    struct stat st;
+    char path[PATH_MAX];
+
+    if ((strlen(name) > NAME_MAX) || enxlog_collect_find(name)) {
+        return;
+    }
+
+    int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return;
+    }
+
+    // Wait for the producer to size and initialize the ring
+    if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(struct enxlog_shm_ring_header))) {
+        close(fd);
+        return;
+    }
+
+    void *mapping = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        close(fd);
+        return;
+    }
+
+    struct enxlog_shm_ring_header *header = (struct enxlog_shm_ring_header *)mapping;
+    if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != ENXLOG_SHM_RING_MAGIC) ||
+        (header->version != ENXLOG_SHM_RING_VERSION) ||
+        (header->header_size + header->capacity != (uint64_t)st.st_size)) {
+        munmap(mapping, st.st_size);
+        close(fd);
+        return;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s.log", directory, (name[0] == '/') ? &name[1] : name);
+
+    ring = calloc(1, sizeof(struct enxlog_collect_ring));
+    ring->file = fopen(path, "a");
+    if (ring->file == NULL) {
+        perror(path);
+        munmap(mapping, st.st_size);
+        close(fd);
+        free(ring);
+        return;
+    }
+
+    strcpy(ring->name, name);
+    ring->fd = fd;
+    ring->size = st.st_size;
+    ring->header = header;
+    ring->data = (const char *)mapping + header->header_size;
+
+    if (pthread_create(&ring->thread, NULL, enxlog_collect_thread, ring) != 0) {
+        munmap(mapping, st.st_size);
+        close(fd);
+        fclose(ring->file);
+        free(ring);
+        return;
+    }
+
+    ring->next = enxlog_collect_rings;
+    enxlog_collect_rings = ring;
+
+    fprintf(stderr, "%s: collecting into %s\n", name, path);
+}
+
+static void enxlog_collect_scan(const char *directory, const char *pattern)
+{
+    // POSIX shared memory objects are files in /dev/shm on Linux
+    const char *prefix = (pattern[0] == '/') ? &pattern[1] : pattern;
+    size_t length = strlen(prefix) - 1;
+    char name[NAME_MAX + 2];
+    struct dirent *entry;
+
+    DIR *dir = opendir("/dev/shm");
+    if (dir == NULL) {
+        return;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if ((strncmp(entry->d_name, prefix, length) == 0) && (strlen(entry->d_name) <= NAME_MAX)) {
+            snprintf(name, sizeof(name), "/%s", entry->d_name);
+            enxlog_collect_open(directory, name);
+        }
+    }
+
+    closedir(dir);
+}
+
+static bool enxlog_collect_drain(struct enxlog_collect_ring *ring)
+{
+    struct enxlog_shm_ring_header *header = ring->header;
+    uint64_t capacity = header->capacity;
+    uint64_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+    uint64_t position = header->tail;
+    bool drained = false;
+
+    while (position != head) {
+        const struct enxlog_mmap_ring_record *record = (const struct enxlog_mmap_ring_record *)&ring->data[position];
+
+        if (record->length == ENXLOG_MMAP_RING_WRAP) {
+            position = 0;
+            continue;
+        }
+
+        uint64_t size = sizeof(struct enxlog_mmap_ring_record) + record->length;
+        if (position + size > capacity) {
+            fprintf(stderr, "%s: corrupt record at offset %llu\n", ring->name, (unsigned long long)position);
+            position = head;
+            break;
+        }
+
+        fwrite(record + 1, 1, record->length, ring->file);
+        putc('\n', ring->file);
+
+        position += (size + ENXLOG_MMAP_RING_ALIGNMENT - 1) & ~(uint64_t)(ENXLOG_MMAP_RING_ALIGNMENT - 1);
+        if (position >= capacity) {
+            position = 0;
+        }
+
+        drained = true;
+    }
+
+    // Hand the space back to the producer once the records are written
+    if (drained) {
+        fflush(ring->file);
+    }
+
+    __atomic_store_n(&header->tail, position, __ATOMIC_RELEASE);
+
+    uint64_t dropped = __atomic_load_n(&header->dropped, __ATOMIC_RELAXED);
+    if (dropped != ring->dropped) {
+        fprintf(stderr, "%s: %llu records dropped\n", ring->name, (unsigned long long)(dropped - ring->dropped));
+        ring->dropped = dropped;
+    }
+
+    return drained;
+}
+
+static bool enxlog_collect_producer_exited(const struct enxlog_collect_ring *ring)
+{
+    pid_t pid = (pid_t)__atomic_load_n(&ring->header->pid, __ATOMIC_ACQUIRE);
+
+    return (kill(pid, 0) < 0) && (errno == ESRCH);
+}
+
+static void *enxlog_collect_thread(void *context)
+{
+    struct enxlog_collect_ring *ring = (struct enxlog_collect_ring *)context;
+    struct enxlog_shm_ring_header *header = ring->header;
+    struct timespec timeout = {
+        .tv_sec = ENXLOG_COLLECT_WAIT_MS / 1000,
+        .tv_nsec = (ENXLOG_COLLECT_WAIT_MS % 1000) * 1000000L
+    };
+
+    while (enxlog_collect_running) {
+        if (enxlog_collect_drain(ring)) {
+            continue;
+        }
+
+        // The ring is empty. Announce the wait before checking again, so
+        // that a producer that commits in between wakes this thread.
+        __atomic_store_n(&header->waiters, 1, __ATOMIC_SEQ_CST);
+        uint32_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&header->head, __ATOMIC_ACQUIRE) == header->tail) {
+            int result = syscall(SYS_futex, &header->sequence, FUTEX_WAIT, sequence, &timeout, NULL, 0);
+
+            // Nothing was committed in time. A producer that has exited
+            // cannot add anything, so the ring is finished.
+            if ((result < 0) && (errno == ETIMEDOUT) && enxlog_collect_producer_exited(ring)) {
+                __atomic_store_n(&header->waiters, 0, __ATOMIC_SEQ_CST);
+                enxlog_collect_drain(ring);
+                shm_unlink(ring->name);
+                fprintf(stderr, "%s: producer exited\n", ring->name);
+                break;
+            }
+        }
+
+        __atomic_store_n(&header->waiters, 0, __ATOMIC_SEQ_CST);
+    }
+
+    // Records committed before a stop request are still written
+    enxlog_collect_drain(ring);
+    __atomic_store_n(&ring->finished, true, __ATOMIC_RELEASE);
+
+    return NULL;
+}
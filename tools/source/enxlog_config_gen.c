@@ -0,0 +1,748 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/enxlog.h>
+#include <enx/log/enxlog_pattern.h>
+#include <enx/log/config/enxlog_config_parser.h>
+#include <enx/log/config/enxlog_sink_parameters.h>
+#include <enx/log/sinks/enxlog_sink_syslog.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Generator state
+ * @private
+ */
+struct enxlog_config_gen
+{
+    FILE *file;
+    const char *name;
+    unsigned int filter_count;
+};
+
+/**
+ * The configuration being generated, for error messages
+ * @private
+ */
+static const char *enxlog_config_gen_path;
+
+static const char *enxlog_config_gen_loglevels[] = {
+    "LOGLEVEL_NONE",
+    "LOGLEVEL_ERROR",
+    "LOGLEVEL_WARN",
+    "LOGLEVEL_INFO",
+    "LOGLEVEL_DEBUG",
+    "LOGLEVEL_TRACE"
+};
+
+static const char *enxlog_config_gen_op_types[] = {
+    "ENXLOG_PATTERN_OP_LITERAL",
+    "ENXLOG_PATTERN_OP_COLOR",
+    "ENXLOG_PATTERN_OP_LEVEL_COLOR",
+    "ENXLOG_PATTERN_OP_TIMESTAMP",
+    "ENXLOG_PATTERN_OP_LEVEL",
+    "ENXLOG_PATTERN_OP_LOGGER",
+    "ENXLOG_PATTERN_OP_FUNC",
+    "ENXLOG_PATTERN_OP_LINE",
+    "ENXLOG_PATTERN_OP_THREAD"
+};
+
+static const char *enxlog_config_gen_newlines[] = {
+    "ENXLOG_PATTERN_NEWLINE_INDENT",
+    "ENXLOG_PATTERN_NEWLINE_ESCAPE",
+    "ENXLOG_PATTERN_NEWLINE_RAW"
+};
+
+
+/** @private */
+static void enxlog_config_gen_error(int line, int column, const char *message);
+
+/** @private */
+static bool enxlog_config_gen_sink_callback(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback);
+
+/** @private */
+static void enxlog_config_gen_string(FILE *file, const char *ptr, size_t length);
+
+/** @private */
+static bool enxlog_config_gen_count(
+    const struct enxlog_sink_parameters *parameters,
+    const char *key,
+    size_t *result);
+
+/** @private */
+static unsigned int enxlog_config_gen_filter_entries(
+    struct enxlog_config_gen *gen,
+    const struct enxlog_filter_entry *entries);
+
+/** @private */
+static bool enxlog_config_gen_pattern(
+    struct enxlog_config_gen *gen,
+    size_t index,
+    const struct enxlog_sink_parameters *parameters,
+    const char *default_pattern,
+    bool *has_pattern);
+
+/** @private */
+static bool enxlog_config_gen_sink(
+    struct enxlog_config_gen *gen,
+    size_t index,
+    const struct enxlog_sink_parameters *parameters);
+
+/** @private */
+static bool enxlog_config_gen_source(
+    struct enxlog_config_gen *gen,
+    struct enxlog_config *config,
+    const char *header);
+
+/** @private */
+static bool enxlog_config_gen_header(
+    struct enxlog_config_gen *gen,
+    const char *guard);
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        printf("usage: enxlog_config_gen <logger_config> <name> <output_directory>\n");
+        return 1;
+    }
+
+    enxlog_config_gen_path = argv[1];
+
+    const char *name = argv[2];
+    const char *ptr;
+    if (!isalpha((unsigned char)name[0]) && (name[0] != '_')) {
+        fprintf(stderr, "%s: not a valid C identifier\n", name);
+        return 1;
+    }
+
+    for (ptr = name; *ptr; ++ptr) {
+        if (!isalnum((unsigned char)*ptr) && (*ptr != '_')) {
+            fprintf(stderr, "%s: not a valid C identifier\n", name);
+            return 1;
+        }
+    }
+
+    // The sink callback keeps the parameters of each sink as its context
+    struct enxlog_config *config = enxlog_config_parse(argv[1], enxlog_config_gen_sink_callback, enxlog_config_gen_error);
+    if (config == NULL) {
+        return 1;
+    }
+
+    if (enxlog_config_get_sinks(config) == NULL) {
+        enxlog_config_destroy(config);
+        return 1;
+    }
+
+    size_t directory_length = strlen(argv[3]);
+    size_t name_length = strlen(name);
+    char *path = malloc(directory_length + name_length + 4);
+    char *guard = malloc(name_length + 3);
+    struct enxlog_config_gen gen = { .name = name, .filter_count = 0 };
+    bool result = false;
+    size_t i;
+
+    for (i=0; i < name_length; ++i) {
+        guard[i] = (char)toupper((unsigned char)name[i]);
+    }
+    memcpy(&guard[name_length], "_H", 3);
+
+    // Source
+    sprintf(path, "%s/%s.c", argv[3], name);
+    gen.file = fopen(path, "w");
+    if (gen.file == NULL) {
+        perror(path);
+        goto done;
+    }
+
+    sprintf(path, "%s.h", name);
+    result = enxlog_config_gen_source(&gen, config, path);
+    fclose(gen.file);
+    if (!result) {
+        sprintf(path, "%s/%s.c", argv[3], name);
+        remove(path);
+        goto done;
+    }
+
+    // Header
+    sprintf(path, "%s/%s.h", argv[3], name);
+    gen.file = fopen(path, "w");
+    if (gen.file == NULL) {
+        perror(path);
+        result = false;
+        goto done;
+    }
+
+    result = enxlog_config_gen_header(&gen, guard);
+    fclose(gen.file);
+
+done:
+    free(guard);
+    free(path);
+    enxlog_config_destroy(config);
+
+    return result ? 0 : 1;
+}
+
+static void enxlog_config_gen_error(int line, int column, const char *message)
+{
+    fprintf(stderr, "%s:%d:%d: %s\n", enxlog_config_gen_path, line, column, message);
+}
+
+static bool enxlog_config_gen_sink_callback(
+    struct enxlog_sink *sink,
+    const struct enxlog_sink_parameters *parameters,
+    enxlog_config_parser_error_callback_t error_callback)
+{
+    // Nothing is created here. The parameters live as long as the config,
+    // and are turned into code once the whole file has been parsed.
+    if (enxlog_sink_parameters_find(parameters, "type") == NULL) {
+        error_callback(0, 0, "Sink type not specified");
+        return false;
+    }
+
+    sink->context = (void *)parameters;
+    sink->valid = true;
+
+    return true;
+}
+
+static void enxlog_config_gen_string(FILE *file, const char *ptr, size_t length)
+{
+    size_t i;
+
+    fputc('"', file);
+    for (i=0; i < length; ++i) {
+        unsigned char c = (unsigned char)ptr[i];
+        if ((c == '"') || (c == '\\')) {
+            fprintf(file, "\\%c", c);
+        } else if (isprint(c)) {
+            fputc(c, file);
+        } else {
+            fprintf(file, "\\%03o", c);
+        }
+    }
+    fputc('"', file);
+}
+
+static bool enxlog_config_gen_count(
+    const struct enxlog_sink_parameters *parameters,
+    const char *key,
+    size_t *result)
+{
+    const char *value = enxlog_sink_parameters_find(parameters, key);
+    if (value) {
+        char *end;
+        *result = strtoul(value, &end, 10);
+        if ((*end != '\0') || (*result == 0)) {
+            fprintf(stderr, "%s: sink '%s' should be a positive number\n", enxlog_config_gen_path, key);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static unsigned int enxlog_config_gen_filter_entries(
+    struct enxlog_config_gen *gen,
+    const struct enxlog_filter_entry *entries)
+{
+    const struct enxlog_filter_entry *entry;
+    unsigned int count = 0;
+    unsigned int *children;
+    unsigned int i = 0;
+
+    for (entry = entries; entry->name_part; ++entry) {
+        count++;
+    }
+
+    // Children are written first, so that every array is defined before
+    // the entries that point to it
+    children = malloc((count + 1) * sizeof(unsigned int));
+    for (entry = entries; entry->name_part; ++entry) {
+        children[i++] = enxlog_config_gen_filter_entries(gen, entry->children);
+    }
+
+    unsigned int index = gen->filter_count++;
+
+    fprintf(gen->file, "static const struct enxlog_filter_entry %s_filter_%u[] = {\n", gen->name, index);
+    for (entry = entries, i = 0; entry->name_part; ++entry, ++i) {
+        fprintf(gen->file, "    { (char *)");
+        enxlog_config_gen_string(gen->file, entry->name_part, strlen(entry->name_part));
+        fprintf(gen->file, ", %s, (struct enxlog_filter_entry *)%s_filter_%u },\n",
+            enxlog_config_gen_loglevels[entry->loglevel], gen->name, children[i]);
+    }
+    fprintf(gen->file, "    { 0 }\n};\n\n");
+
+    free(children);
+
+    return index;
+}
+
+static bool enxlog_config_gen_pattern(
+    struct enxlog_config_gen *gen,
+    size_t index,
+    const struct enxlog_sink_parameters *parameters,
+    const char *default_pattern,
+    bool *has_pattern)
+{
+    const char *value = enxlog_sink_parameters_find(parameters, "pattern");
+    const char *newlines = enxlog_sink_parameters_find(parameters, "newlines");
+    struct enxlog_pattern pattern;
+    size_t i;
+
+    *has_pattern = false;
+
+    enum enxlog_pattern_newline newline = ENXLOG_PATTERN_NEWLINE_INDENT;
+    if (newlines) {
+        if (strcmp(newlines, "indent") == 0) {
+            newline = ENXLOG_PATTERN_NEWLINE_INDENT;
+        } else if (strcmp(newlines, "escape") == 0) {
+            newline = ENXLOG_PATTERN_NEWLINE_ESCAPE;
+        } else if (strcmp(newlines, "raw") == 0) {
+            newline = ENXLOG_PATTERN_NEWLINE_RAW;
+        } else {
+            fprintf(stderr, "%s: sink 'newlines' must be indent, escape or raw\n", enxlog_config_gen_path);
+            return false;
+        }
+    }
+
+    // Sinks without either key use their built-in default pattern
+    if ((value == NULL) && (newlines == NULL)) {
+        return true;
+    }
+
+    if (!enxlog_pattern_compile(&pattern, value ? value : default_pattern)) {
+        fprintf(stderr, "%s: sink 'pattern' is not valid\n", enxlog_config_gen_path);
+        return false;
+    }
+
+    fprintf(gen->file, "static const struct enxlog_pattern %s_pattern_%zu = {\n", gen->name, index);
+    fprintf(gen->file, "    .ops = {\n");
+    for (i=0; i < pattern.count; ++i) {
+        fprintf(gen->file, "        { .type = %s, .length = %u, .offset = %u }%s\n",
+            enxlog_config_gen_op_types[pattern.ops[i].type],
+            pattern.ops[i].length,
+            pattern.ops[i].offset,
+            (i + 1 < pattern.count) ? "," : "");
+    }
+    fprintf(gen->file, "    },\n");
+    fprintf(gen->file, "    .count = %zu,\n", pattern.count);
+    fprintf(gen->file, "    .literals = ");
+    enxlog_config_gen_string(gen->file, pattern.literals, pattern.literals_length);
+    fprintf(gen->file, ",\n");
+    fprintf(gen->file, "    .literals_length = %zu,\n", pattern.literals_length);
+    fprintf(gen->file, "    .newline = %s\n", enxlog_config_gen_newlines[newline]);
+    fprintf(gen->file, "};\n\n");
+
+    *has_pattern = true;
+
+    return true;
+}
+
+static bool enxlog_config_gen_sink(
+    struct enxlog_config_gen *gen,
+    size_t index,
+    const struct enxlog_sink_parameters *parameters)
+{
+    FILE *file = gen->file;
+    const char *type = enxlog_sink_parameters_find(parameters, "type");
+    const char *path = enxlog_sink_parameters_find(parameters, "path");
+    bool has_pattern = false;
+
+    // The contexts are the structures the sink factory fills in at runtime
+    if ((strcmp(type, "stdout") == 0) || (strcmp(type, "stdout_color") == 0)) {
+        const char *default_pattern = (strcmp(type, "stdout") == 0) ?
+            ENXLOG_PATTERN_DEFAULT : ENXLOG_PATTERN_DEFAULT_COLOR;
+
+        if (!enxlog_config_gen_pattern(gen, index, parameters, default_pattern, &has_pattern)) {
+            return false;
+        }
+
+        fprintf(file, "static struct enxlog_sink_%s_context %s_sink_%zu = {\n", type, gen->name, index);
+
+    } else if (strcmp(type, "file") == 0) {
+        const char *compression = "ENXLOG_SINK_FILE_COMPRESSION_NONE";
+        const char *value = enxlog_sink_parameters_find(parameters, "compress");
+
+        if (path == NULL) {
+            fprintf(stderr, "%s: file sink should specify 'path'\n", enxlog_config_gen_path);
+            return false;
+        }
+
+        if (value) {
+            if (strcmp(value, "lz4") == 0) {
+                compression = "ENXLOG_SINK_FILE_COMPRESSION_LZ4";
+            } else if (strcmp(value, "zstd") == 0) {
+                compression = "ENXLOG_SINK_FILE_COMPRESSION_ZSTD";
+            } else if (strcmp(value, "none") != 0) {
+                fprintf(stderr, "%s: file sink 'compress' should be one of none, lz4 or zstd\n", enxlog_config_gen_path);
+                return false;
+            }
+        }
+
+        if (!enxlog_config_gen_pattern(gen, index, parameters, ENXLOG_PATTERN_DEFAULT, &has_pattern)) {
+            return false;
+        }
+
+        if (strcmp(compression, "ENXLOG_SINK_FILE_COMPRESSION_NONE") != 0) {
+            fprintf(file, "#ifndef ENXLOG_COMPRESSION\n");
+            fprintf(file, "#error \"File sink compression requires LIBENXLOG_COMPRESSION\"\n");
+            fprintf(file, "#endif\n\n");
+        }
+
+        fprintf(file, "static struct enxlog_sink_file_context %s_sink_%zu = {\n", gen->name, index);
+        fprintf(file, "    .compression = %s,\n", compression);
+
+    } else if (strcmp(type, "json") == 0) {
+        fprintf(file, "static struct enxlog_sink_json_context %s_sink_%zu = {\n", gen->name, index);
+
+    } else if (strcmp(type, "flight_recorder") == 0) {
+        size_t size = 1024 * 1024;
+        const char *crash_dump = enxlog_sink_parameters_find(parameters, "crash_dump");
+
+        if (!enxlog_config_gen_count(parameters, "size", &size) ||
+            !enxlog_config_gen_pattern(gen, index, parameters, ENXLOG_PATTERN_DEFAULT, &has_pattern)) {
+            return false;
+        }
+
+        fprintf(file, "static char %s_sink_%zu_buffer[%zu];\n\n", gen->name, index, size);
+        fprintf(file, "static struct enxlog_sink_flight_recorder_context %s_sink_%zu = {\n", gen->name, index);
+        fprintf(file, "    .buffer = %s_sink_%zu_buffer,\n", gen->name, index);
+        fprintf(file, "    .size = %zu,\n", size);
+        if (crash_dump) {
+            fprintf(file, "    .crash_dump = ");
+            enxlog_config_gen_string(file, crash_dump, strlen(crash_dump));
+            fprintf(file, ",\n");
+        }
+        fprintf(file, "    .crash_fd = -1,\n");
+
+    } else if (strcmp(type, "mmap_ring") == 0) {
+        size_t size = 16 * 1024 * 1024;
+
+        if (path == NULL) {
+            fprintf(stderr, "%s: memory mapped ring sink should specify 'path'\n", enxlog_config_gen_path);
+            return false;
+        }
+
+        if (!enxlog_config_gen_count(parameters, "size", &size) ||
+            !enxlog_config_gen_pattern(gen, index, parameters, ENXLOG_PATTERN_DEFAULT, &has_pattern)) {
+            return false;
+        }
+
+        fprintf(file, "static struct enxlog_sink_mmap_ring_context %s_sink_%zu = {\n", gen->name, index);
+        fprintf(file, "    .size = %zu,\n", size);
+        fprintf(file, "    .fd = -1,\n");
+
+    } else if (strcmp(type, "shm") == 0) {
+        size_t size = 4 * 1024 * 1024;
+        const char *name = enxlog_sink_parameters_find(parameters, "name");
+
+        if (name == NULL) {
+            fprintf(stderr, "%s: shared memory sink should specify 'name'\n", enxlog_config_gen_path);
+            return false;
+        }
+
+        if (!enxlog_config_gen_count(parameters, "size", &size) ||
+            !enxlog_config_gen_pattern(gen, index, parameters, ENXLOG_PATTERN_DEFAULT, &has_pattern)) {
+            return false;
+        }
+
+        fprintf(file, "static struct enxlog_sink_shm_context %s_sink_%zu = {\n", gen->name, index);
+        fprintf(file, "    .name = ");
+        enxlog_config_gen_string(file, name, strlen(name));
+        fprintf(file, ",\n");
+        fprintf(file, "    .size = %zu,\n", size);
+        fprintf(file, "    .fd = -1,\n");
+
+    } else if (strcmp(type, "uring_file") == 0) {
+        size_t buffer_size = 0;
+        size_t buffer_count = 0;
+        size_t flush_interval_ms = 0;
+
+        if (path == NULL) {
+            fprintf(stderr, "%s: io_uring file sink should specify 'path'\n", enxlog_config_gen_path);
+            return false;
+        }
+
+        if (!enxlog_config_gen_count(parameters, "buffer_size", &buffer_size) ||
+            !enxlog_config_gen_count(parameters, "buffers", &buffer_count) ||
+            !enxlog_config_gen_count(parameters, "flush_interval_ms", &flush_interval_ms) ||
+            !enxlog_config_gen_pattern(gen, index, parameters, ENXLOG_PATTERN_DEFAULT, &has_pattern)) {
+            return false;
+        }
+
+        fprintf(file, "static struct enxlog_sink_uring_file_context %s_sink_%zu = {\n", gen->name, index);
+        fprintf(file, "    .buffer_size = %zu,\n", buffer_size);
+        fprintf(file, "    .buffer_count = %zu,\n", buffer_count);
+        fprintf(file, "    .flush_interval_ms = %zu,\n", flush_interval_ms);
+
+    } else if (strcmp(type, "tcp") == 0) {
+        size_t port = 0;
+        size_t buffer_size = 0;
+        size_t spill_size = 0;
+        size_t flush_interval_ms = 0;
+        const char *framing = "ENXLOG_SINK_TCP_FRAMING_NEWLINE";
+        const char *host = enxlog_sink_parameters_find(parameters, "host");
+        const char *spill_path = enxlog_sink_parameters_find(parameters, "spill_path");
+        const char *value = enxlog_sink_parameters_find(parameters, "framing");
+
+        if (host == NULL) {
+            fprintf(stderr, "%s: TCP sink should specify 'host'\n", enxlog_config_gen_path);
+            return false;
+        }
+
+        if (value) {
+            if (strcmp(value, "length") == 0) {
+                framing = "ENXLOG_SINK_TCP_FRAMING_LENGTH";
+            } else if (strcmp(value, "newline") != 0) {
+                fprintf(stderr, "%s: TCP sink 'framing' should be newline or length\n", enxlog_config_gen_path);
+                return false;
+            }
+        }
+
+        if (!enxlog_config_gen_count(parameters, "port", &port) ||
+            !enxlog_config_gen_count(parameters, "buffer_size", &buffer_size) ||
+            !enxlog_config_gen_count(parameters, "spill_size", &spill_size) ||
+            !enxlog_config_gen_count(parameters, "flush_interval_ms", &flush_interval_ms) ||
+            !enxlog_config_gen_pattern(gen, index, parameters, ENXLOG_PATTERN_DEFAULT, &has_pattern)) {
+            return false;
+        }
+
+        if ((port == 0) || (port > 65535)) {
+            fprintf(stderr, "%s: TCP sink should specify a 'port' between 1 and 65535\n", enxlog_config_gen_path);
+            return false;
+        }
+
+        fprintf(file, "static struct enxlog_sink_tcp_context %s_sink_%zu = {\n", gen->name, index);
+        fprintf(file, "    .host = ");
+        enxlog_config_gen_string(file, host, strlen(host));
+        fprintf(file, ",\n");
+        fprintf(file, "    .port = %zu,\n", port);
+        fprintf(file, "    .framing = %s,\n", framing);
+        fprintf(file, "    .buffer_size = %zu,\n", buffer_size);
+        if (spill_path) {
+            fprintf(file, "    .spill_path = ");
+            enxlog_config_gen_string(file, spill_path, strlen(spill_path));
+            fprintf(file, ",\n");
+        }
+        fprintf(file, "    .spill_size = %zu,\n", spill_size);
+        fprintf(file, "    .flush_interval_ms = %zu,\n", flush_interval_ms);
+
+    } else if (strcmp(type, "journald") == 0) {
+        size_t max_datagram = 0;
+        const char *identifier = enxlog_sink_parameters_find(parameters, "identifier");
+
+        if (!enxlog_config_gen_count(parameters, "max_datagram", &max_datagram)) {
+            return false;
+        }
+
+        fprintf(file, "static struct enxlog_sink_journald_context %s_sink_%zu = {\n", gen->name, index);
+        if (identifier) {
+            fprintf(file, "    .identifier = ");
+            enxlog_config_gen_string(file, identifier, strlen(identifier));
+            fprintf(file, ",\n");
+        }
+        fprintf(file, "    .max_datagram = %zu,\n", max_datagram);
+        fprintf(file, "    .fd = -1,\n");
+
+    } else if (strcmp(type, "syslog") == 0) {
+        static const char *facilities[] = {
+            "user", "daemon", "auth", "local0", "local1", "local2", "local3",
+            "local4", "local5", "local6", "local7", NULL
+        };
+
+        size_t port = 0;
+        size_t batch_size = 0;
+        size_t queue_length = 0;
+        size_t flush_interval_ms = 0;
+        const char *app_name = enxlog_sink_parameters_find(parameters, "app_name");
+        const char *facility = enxlog_sink_parameters_find(parameters, "facility");
+        const char **name = facilities;
+
+        if (facility) {
+            while (*name && (strcmp(*name, facility) != 0)) {
+                ++name;
+            }
+
+            if (*name == NULL) {
+                fprintf(stderr, "%s: syslog sink 'facility' should be one of user, daemon, auth or local0 to local7\n", enxlog_config_gen_path);
+                return false;
+            }
+        }
+
+        if (!enxlog_config_gen_count(parameters, "port", &port) ||
+            !enxlog_config_gen_count(parameters, "batch_size", &batch_size) ||
+            !enxlog_config_gen_count(parameters, "queue_length", &queue_length) ||
+            !enxlog_config_gen_count(parameters, "flush_interval_ms", &flush_interval_ms) ||
+            !enxlog_config_gen_pattern(gen, index, parameters, ENXLOG_PATTERN_DEFAULT_SYSLOG, &has_pattern)) {
+            return false;
+        }
+
+        fprintf(file, "static struct enxlog_sink_syslog_context %s_sink_%zu = {\n", gen->name, index);
+        fprintf(file, "    .port = %zu,\n", port);
+        if (app_name) {
+            fprintf(file, "    .app_name = ");
+            enxlog_config_gen_string(file, app_name, strlen(app_name));
+            fprintf(file, ",\n");
+        }
+        if (facility) {
+            fprintf(file, "    .facility = ENXLOG_SYSLOG_FACILITY_");
+            for (; *facility; ++facility) {
+                fputc(toupper((unsigned char)*facility), file);
+            }
+            fprintf(file, ",\n");
+        }
+        fprintf(file, "    .batch_size = %zu,\n", batch_size);
+        fprintf(file, "    .queue_length = %zu,\n", queue_length);
+        fprintf(file, "    .flush_interval_ms = %zu,\n", flush_interval_ms);
+
+    } else {
+        fprintf(stderr, "%s: unknown sink type '%s'\n", enxlog_config_gen_path, type);
+        return false;
+    }
+
+    if (path && (strcmp(type, "stdout") != 0) && (strcmp(type, "stdout_color") != 0)) {
+        fprintf(file, "    .path = ");
+        enxlog_config_gen_string(file, path, strlen(path));
+        fprintf(file, ",\n");
+    }
+
+    // The structured sinks have no pattern
+    if (has_pattern) {
+        fprintf(file, "    .pattern = &%s_pattern_%zu\n", gen->name, index);
+    } else if ((strcmp(type, "json") != 0) && (strcmp(type, "journald") != 0)) {
+        fprintf(file, "    .pattern = NULL\n");
+    }
+
+    fprintf(file, "};\n\n");
+
+    return true;
+}
+
+static bool enxlog_config_gen_source(
+    struct enxlog_config_gen *gen,
+    struct enxlog_config *config,
+    const char *header)
+{
+    FILE *file = gen->file;
+    const struct enxlog_sink *sinks = enxlog_config_get_sinks(config);
+    const struct enxlog_sink *sink;
+    const char *type;
+    size_t i;
+
+    fprintf(file, "/* Generated by enxlog_config_gen from %s. Do not edit. */\n\n", enxlog_config_gen_path);
+    fprintf(file, "#include \"%s\"\n\n", header);
+    fprintf(file, "#include <enx/log/enxlog_pattern.h>\n");
+
+    // One include per sink type in use
+    static const char *types[] = {
+        "stdout", "stdout_color", "file", "json", "flight_recorder", "mmap_ring", "uring_file", "shm", "syslog", "journald", "tcp", NULL
+    };
+
+    const char **ptr;
+    for (ptr = types; *ptr; ++ptr) {
+        for (sink = sinks; sink->valid; ++sink) {
+            type = enxlog_sink_parameters_find((const struct enxlog_sink_parameters *)sink->context, "type");
+            if (strcmp(type, *ptr) == 0) {
+                fprintf(file, "#include <enx/log/sinks/enxlog_sink_%s.h>\n", *ptr);
+                break;
+            }
+        }
+    }
+
+    fprintf(file, "\n#include <stddef.h>\n\n\n");
+
+    // Filter
+    const struct enxlog_filter *filter = enxlog_config_get_filter(config);
+    unsigned int root = enxlog_config_gen_filter_entries(gen, filter->entries);
+
+    fprintf(file, "const struct enxlog_filter %s_filter = {\n", gen->name);
+    fprintf(file, "    .entries = (struct enxlog_filter_entry *)%s_filter_%u\n", gen->name, root);
+    fprintf(file, "};\n\n");
+
+    fprintf(file, "const enum enxlog_loglevel %s_default_loglevel = %s;\n\n\n",
+        gen->name, enxlog_config_gen_loglevels[enxlog_config_get_default_loglevel(config)]);
+
+    // Sink contexts
+    for (sink = sinks, i = 0; sink->valid; ++sink, ++i) {
+        if (!enxlog_config_gen_sink(gen, i, (const struct enxlog_sink_parameters *)sink->context)) {
+            return false;
+        }
+    }
+
+    // Sink list, with the callbacks the sink factory sets
+    fprintf(file, "\nconst struct enxlog_sink %s_sinks[] = {\n", gen->name);
+    for (sink = sinks, i = 0; sink->valid; ++sink, ++i) {
+        type = enxlog_sink_parameters_find((const struct enxlog_sink_parameters *)sink->context, "type");
+
+        fprintf(file, "    {\n");
+        fprintf(file, "        .valid = true,\n");
+        fprintf(file, "        .context = &%s_sink_%zu,\n", gen->name, i);
+        fprintf(file, "        .fn_init = enxlog_sink_%s_init,\n", type);
+        fprintf(file, "        .fn_shutdown = enxlog_sink_%s_shutdown,\n", type);
+        fprintf(file, "        .fn_log_entry_open = enxlog_sink_%s_log_entry_open,\n", type);
+        fprintf(file, "        .fn_log_entry_write = enxlog_sink_%s_log_entry_write,\n", type);
+        if ((strcmp(type, "json") == 0) || (strcmp(type, "journald") == 0)) {
+            fprintf(file, "        .fn_log_entry_close = enxlog_sink_%s_log_entry_close,\n", type);
+            fprintf(file, "        .fn_log_entry_field = enxlog_sink_%s_log_entry_field\n", type);
+        } else if ((strcmp(type, "file") == 0) || (strcmp(type, "syslog") == 0)) {
+            fprintf(file, "        .fn_log_entry_close = enxlog_sink_%s_log_entry_close,\n", type);
+            fprintf(file, "        .fn_log_batch = enxlog_sink_%s_log_batch\n", type);
+        } else {
+            fprintf(file, "        .fn_log_entry_close = enxlog_sink_%s_log_entry_close\n", type);
+        }
+        fprintf(file, "    },\n");
+    }
+    fprintf(file, "    { .valid = false }\n");
+    fprintf(file, "};\n");
+
+    return true;
+}
+
+static bool enxlog_config_gen_header(
+    struct enxlog_config_gen *gen,
+    const char *guard)
+{
+    FILE *file = gen->file;
+
+    fprintf(file, "/* Generated by enxlog_config_gen from %s. Do not edit. */\n\n", enxlog_config_gen_path);
+    fprintf(file, "#ifndef %s\n", guard);
+    fprintf(file, "#define %s\n\n", guard);
+    fprintf(file, "#include <enx/log/enxlog.h>\n\n");
+    fprintf(file, "#include <sys/cdefs.h>\n\n");
+    fprintf(file, "__BEGIN_DECLS\n\n");
+    fprintf(file, "extern const struct enxlog_filter %s_filter;\n", gen->name);
+    fprintf(file, "extern const struct enxlog_sink %s_sinks[];\n", gen->name);
+    fprintf(file, "extern const enum enxlog_loglevel %s_default_loglevel;\n\n", gen->name);
+    fprintf(file, "__END_DECLS\n\n");
+    fprintf(file, "#endif\n");
+
+    return true;
+}
@@ -0,0 +1,133 @@
+/*
+    Copyright (c) 2022 Eneritix (Pty) Ltd
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+ */
+
+#include <enx/log/sinks/enxlog_sink_mmap_ring.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+int main(int argc, char* argv[])
+{
+    struct stat st;
+
+    if (argc < 2) {
+        printf("usage: enxlog_mmap_ring_reader <ring_file>\n");
+        return 1;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(struct enxlog_mmap_ring_header))) {
+        fprintf(stderr, "%s: not a ring file\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return 1;
+    }
+
+    const struct enxlog_mmap_ring_header *header = (const struct enxlog_mmap_ring_header *)mapping;
+    const char *data = (const char *)mapping + header->header_size;
+
+    if ((header->magic != ENXLOG_MMAP_RING_MAGIC) ||
+        (header->version != ENXLOG_MMAP_RING_VERSION) ||
+        (header->header_size != sizeof(struct enxlog_mmap_ring_header)) ||
+        (header->capacity > (uint64_t)st.st_size - header->header_size)) {
+
+        fprintf(stderr, "%s: not a ring file\n", argv[1]);
+        munmap(mapping, st.st_size);
+        close(fd);
+        return 1;
+    }
+
+    uint64_t capacity = header->capacity;
+    uint64_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+    uint64_t position = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+    uint64_t consumed = 0;
+    int result = 0;
+
+    if ((head >= capacity) || (head % ENXLOG_MMAP_RING_ALIGNMENT != 0) ||
+        (position >= capacity) || (position % ENXLOG_MMAP_RING_ALIGNMENT != 0)) {
+
+        fprintf(stderr, "%s: corrupt head or tail\n", argv[1]);
+        munmap(mapping, st.st_size);
+        close(fd);
+        return 1;
+    }
+
+    while (position != head) {
+        // The used space is smaller than the data area, so a corrupt ring
+        // is never read more than once around
+        if ((consumed >= capacity) || (capacity - position < sizeof(struct enxlog_mmap_ring_record))) {
+            fprintf(stderr, "%s: corrupt record at offset %llu\n", argv[1], (unsigned long long)position);
+            result = 1;
+            break;
+        }
+
+        const struct enxlog_mmap_ring_record *record = (const struct enxlog_mmap_ring_record *)&data[position];
+
+        if (record->length == ENXLOG_MMAP_RING_WRAP) {
+            consumed += capacity - position;
+            position = 0;
+            continue;
+        }
+
+        uint64_t size = sizeof(struct enxlog_mmap_ring_record) + record->length;
+        if (position + size > capacity) {
+            fprintf(stderr, "%s: corrupt record at offset %llu\n", argv[1], (unsigned long long)position);
+            result = 1;
+            break;
+        }
+
+        fwrite(record + 1, 1, record->length, stdout);
+        putc('\n', stdout);
+
+        size = (size + ENXLOG_MMAP_RING_ALIGNMENT - 1) & ~(uint64_t)(ENXLOG_MMAP_RING_ALIGNMENT - 1);
+        consumed += size;
+        position += size;
+        if (position >= capacity) {
+            position = 0;
+        }
+    }
+
+    if (header->dropped) {
+        fprintf(stderr, "%llu oversized records were dropped\n", (unsigned long long)header->dropped);
+    }
+
+    munmap(mapping, st.st_size);
+    close(fd);
+
+    return result;
+}